@@ -1,5 +1,8 @@
 const express = require("express");
-const { exec } = require("child_process");
+const { spawn } = require("child_process");
+const crypto = require("crypto");
+const fs = require("fs");
+const os = require("os");
 const path = require("path");
 
 const app = express();
@@ -7,22 +10,282 @@ const app = express();
 app.use(express.json());
 app.use(express.static(".")); // Serve form.html + frontend files
 
-app.post("/run", (req, res) => {
-    const userInput = req.body.data;
+// FULL path to your C program (Windows needs this)
+const programPath = process.env.COMPILER_PATH || path.join(__dirname, "compiler.exe");
+const WORKER_COUNT = Number(process.env.COMPILER_WORKERS) || os.cpus().length;
+// COMPILER_STATS=1 logs one JSON line of compile statistics per request
+const COLLECT_STATS = Boolean(process.env.COMPILER_STATS);
+// COMPILER_INCREMENTAL=1 has each worker compile a request as an edit of the
+// last one it compiled, which pays off for repeated edits of the same file
+const INCREMENTAL = Boolean(process.env.COMPILER_INCREMENTAL);
+// Compile results are cached by source hash: COMPILER_CACHE_ENTRIES bounds
+// the in-memory LRU (0 disables it), COMPILER_CACHE_DIR adds a disk tier
+const CACHE_ENTRIES = Number(process.env.COMPILER_CACHE_ENTRIES ?? 1000);
+const CACHE_DIR = process.env.COMPILER_CACHE_DIR || "";
 
-    // FULL path to your C program (Windows needs this)
-    const programPath = path.join(__dirname, "compiler.exe");
+// One long-lived "compiler.exe --worker" process. Requests are written as
+// "<length>\n<source>" and answered with "asm", "err", optionally "stats",
+// and "end" frames (see run_compile_worker in compiler.c). Only one request
+// is in flight per worker, so responses always belong to the oldest pending job.
+class CompilerWorker {
+    constructor(onIdle) {
+        this.onIdle = onIdle;
+        this.job = null;
+        this.buffer = Buffer.alloc(0);
+        this.frames = {};
+        this.start();
+    }
 
-    // Command to run C program with input
-    const command = `"${programPath}" "${userInput}"`;
+    start() {
+        const args = ["--worker"];
+        if (COLLECT_STATS) args.push("--stats", "json");
+        if (INCREMENTAL) args.push("--incremental", "on");
+        this.process = spawn(programPath, args, { stdio: ["pipe", "pipe", "pipe"] });
+        this.process.stdin.on("error", (err) => this.fail(err));
+        this.process.stdout.on("data", (chunk) => this.receive(chunk));
+        this.process.stderr.on("data", () => {}); // warnings are not part of the response
+        this.process.on("error", (err) => this.fail(err));
+        this.process.on("exit", (code) => this.fail(new Error(`compiler worker exited with code ${code}`)));
+    }
 
-    exec(command, (err, stdout, stderr) => {
-        if (err) {
-            res.send("Error running C program: " + err.message);
-            return;
+    fail(err) {
+        if (this.dead) return;
+        this.dead = true;
+        const job = this.job;
+        this.job = null;
+        if (job) job.reject(err);
+        // Replace the crashed process so the pool keeps its size
+        setTimeout(() => {
+            this.dead = false;
+            this.buffer = Buffer.alloc(0);
+            this.frames = {};
+            this.start();
+            this.onIdle(this);
+        }, 100);
+    }
+
+    send(job) {
+        this.job = job;
+        const source = Buffer.from(job.source, "utf8");
+        this.process.stdin.write(`${source.length}\n`);
+        this.process.stdin.write(source);
+    }
+
+    receive(chunk) {
+        this.buffer = Buffer.concat([this.buffer, chunk]);
+        for (;;) {
+            const newline = this.buffer.indexOf(10);
+            if (newline < 0) return;
+
+            const [tag, value] = this.buffer.toString("utf8", 0, newline).split(" ");
+            const size = Number(value);
+
+            if (tag === "end") {
+                this.buffer = this.buffer.subarray(newline + 1);
+                const job = this.job;
+                const result = {
+                    status: size,
+                    assembly: this.frames.asm || "",
+                    errors: this.frames.err || "",
+                    stats: this.frames.stats ? JSON.parse(this.frames.stats) : null,
+                };
+                this.job = null;
+                this.frames = {};
+                if (job) job.resolve(result);
+                this.onIdle(this);
+                continue;
+            }
+
+            if (this.buffer.length < newline + 1 + size) return;
+            this.frames[tag] = this.buffer.toString("utf8", newline + 1, newline + 1 + size);
+            this.buffer = this.buffer.subarray(newline + 1 + size);
         }
-        res.send(stdout);
-    });
+    }
+}
+
+class CompilerPool {
+    constructor(size) {
+        this.queue = [];
+        this.idle = [];
+        for (let i = 0; i < size; i++) {
+            this.idle.push(new CompilerWorker((worker) => this.release(worker)));
+        }
+    }
+
+    compile(source) {
+        return new Promise((resolve, reject) => {
+            this.queue.push({ source, resolve, reject });
+            this.dispatch();
+        });
+    }
+
+    release(worker) {
+        if (!this.idle.includes(worker)) this.idle.push(worker);
+        this.dispatch();
+    }
+
+    dispatch() {
+        while (this.queue.length && this.idle.length) {
+            const worker = this.idle.pop();
+            if (worker.dead) continue;
+            worker.send(this.queue.shift());
+        }
+    }
+}
+
+// Content-addressed compile results. Keys hash the compiler binary's size
+// and mtime along with the source, so a rebuilt compiler never serves stale
+// disk entries. Only the status, assembly and diagnostics are kept; stats
+// describe one particular compile and are not cached.
+class CompileCache {
+    constructor(maxEntries, directory) {
+        this.maxEntries = maxEntries;
+        this.directory = directory;
+        this.entries = new Map(); // insertion order doubles as LRU order
+        this.pending = new Map(); // identical requests share one compile
+        this.hits = 0;
+        this.diskHits = 0;
+        this.sharedHits = 0;
+        this.misses = 0;
+        this.compiler = CompileCache.compilerVersion();
+        if (directory) fs.mkdirSync(directory, { recursive: true });
+    }
+
+    static compilerVersion() {
+        try {
+            const { size, mtimeMs } = fs.statSync(programPath);
+            return `${size}:${mtimeMs}`;
+        } catch {
+            return "unknown";
+        }
+    }
+
+    // The exact source: even trailing newlines change the line numbers in
+    // diagnostics at the end of the file
+    key(source) {
+        return crypto.createHash("sha256").update(this.compiler).update("\0").update(source).digest("hex");
+    }
+
+    // Resolves to the cached entry and the tier it came from, or null
+    async lookup(key) {
+        const entry = this.entries.get(key);
+        if (entry) {
+            this.entries.delete(key);
+            this.entries.set(key, entry);
+            return { entry, tier: "memory" };
+        }
+        if (!this.directory) return null;
+        try {
+            const stored = JSON.parse(await fs.promises.readFile(this.file(key), "utf8"));
+            this.remember(key, stored);
+            return { entry: stored, tier: "disk" };
+        } catch {
+            return null; // not on disk (or unreadable): compile it
+        }
+    }
+
+    store(key, result) {
+        const entry = { status: result.status, assembly: result.assembly, errors: result.errors };
+        this.remember(key, entry);
+        if (this.directory) {
+            // write then rename, so a concurrent reader never sees half a file
+            const file = this.file(key);
+            const temp = `${file}.${process.pid}.tmp`;
+            fs.promises.writeFile(temp, JSON.stringify(entry))
+                .then(() => fs.promises.rename(temp, file))
+                .catch(() => fs.promises.unlink(temp).catch(() => {}));
+        }
+    }
+
+    remember(key, entry) {
+        if (this.maxEntries <= 0) return;
+        this.entries.set(key, entry);
+        while (this.entries.size > this.maxEntries) {
+            this.entries.delete(this.entries.keys().next().value);
+        }
+    }
+
+    file(key) {
+        return path.join(this.directory, `${key}.json`);
+    }
+
+    // Resolves to { result, cached } where cached is "memory", "disk",
+    // "shared" (joined an identical compile already in flight) or false
+    async compile(source, compileFn) {
+        const key = this.key(source);
+        const found = await this.lookup(key);
+        if (found) {
+            if (found.tier === "memory") this.hits++;
+            else this.diskHits++;
+            return { result: found.entry, cached: found.tier };
+        }
+
+        let job = this.pending.get(key);
+        if (job) {
+            this.sharedHits++;
+            return { result: await job, cached: "shared" };
+        }
+
+        this.misses++;
+        job = compileFn(source).then((result) => {
+            this.store(key, result);
+            return result;
+        });
+        this.pending.set(key, job);
+        try {
+            return { result: await job, cached: false };
+        } finally {
+            this.pending.delete(key);
+        }
+    }
+
+    counters() {
+        const answered = this.hits + this.diskHits + this.sharedHits;
+        const lookups = answered + this.misses;
+        return {
+            entries: this.entries.size,
+            max_entries: this.maxEntries,
+            disk: Boolean(this.directory),
+            hits: this.hits,
+            disk_hits: this.diskHits,
+            shared_hits: this.sharedHits,
+            misses: this.misses,
+            hit_rate: lookups ? Number((answered / lookups).toFixed(4)) : 0,
+        };
+    }
+}
+
+const pool = new CompilerPool(WORKER_COUNT);
+const cache = new CompileCache(CACHE_ENTRIES, CACHE_DIR);
+
+app.post("/run", async (req, res) => {
+    const userInput = String(req.body.data ?? "");
+    const received = process.hrtime.bigint();
+
+    try {
+        const { result, cached } = await cache.compile(userInput, (source) => pool.compile(source));
+        if (COLLECT_STATS) {
+            // request_ms includes the time spent waiting for an idle worker
+            const request_ms = Number(process.hrtime.bigint() - received) / 1e6;
+            const stats = cached ? {} : result.stats;
+            console.log(JSON.stringify({ ...stats, cache: cached || "miss", request_ms: Number(request_ms.toFixed(3)) }));
+        }
+        let output = `source code:\n${userInput}\n\n`;
+        if (result.status === 0) {
+            output += "compilation successful!\n";
+            output += "\ngenerated assembly and machine code:\n" + result.assembly;
+        } else {
+            output += result.errors;
+        }
+        res.send(output);
+    } catch (err) {
+        res.send("Error running C program: " + err.message);
+    }
+});
+
+// Cache hit/miss counters
+app.get("/cache", (req, res) => {
+    res.json(cache.counters());
 });
 
 app.listen(3000, () =>
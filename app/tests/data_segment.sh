@@ -0,0 +1,51 @@
+#!/bin/sh
+# Variables are addressed as offset(r0), so their 8-byte slots have to end
+# within the 32 KB a signed 16-bit offset reaches. Compiles the largest
+# program that fits, 4096 variables, and checks its last slot is at 32760;
+# then checks that one more is reported instead of getting an offset that
+# wraps around.
+#   sh tests/data_segment.sh   (from app/)
+set -e
+here=$(cd "$(dirname "$0")/.." && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+${CC:-gcc} -O2 -o "$work/compiler" "$here/compiler.c"
+
+# count ints, each assigned and read, as one --worker request
+request() {
+    i=1
+    while [ "$i" -le "$1" ]; do
+        echo "int v$i;"
+        i=$((i + 1))
+    done
+    i=1
+    while [ "$i" -le "$1" ]; do
+        echo "v$i = $i;"
+        echo "v1 = v1 + v$i;"
+        i=$((i + 1))
+    done
+}
+for count in 4096 4097; do
+    request $count > "$work/source"
+    { wc -c < "$work/source" | tr -d ' '; cat "$work/source"; } > "$work/request$count"
+done
+
+(cd "$work" && ./compiler --worker --emit stdout < request4096 > fits 2>&1)
+if grep -a -q "Error" "$work/fits"; then
+    grep -a "Error" "$work/fits" | head -5
+    echo "FAIL: 4096 variables did not compile"
+    exit 1
+fi
+last=$(grep -a -o "[0-9]*(r0)" "$work/fits" | sort -n -u | tail -1)
+if [ "$last" != "32760(r0)" ]; then
+    echo "FAIL: last slot is $last, expected 32760(r0)"
+    exit 1
+fi
+
+(cd "$work" && ./compiler --worker --emit stdout < request4097 > too_many 2>&1)
+if ! grep -a -q "Too many variables for r0-relative addressing at line 4097" "$work/too_many"; then
+    echo "FAIL: the 4097th variable was not reported"
+    exit 1
+fi
+echo "ok: 4096 variables fit, the 4097th is reported"
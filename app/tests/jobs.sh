@@ -0,0 +1,86 @@
+#!/bin/sh
+# --jobs splits large programs into chunks that are generated and rendered
+# on separate threads, and has to give exactly what one thread gives.
+# Compiles a 12000-statement program, enough for four chunks of at least
+# MIN_CHUNK_STATEMENTS, with --jobs 1 and --jobs 4 in several formats and
+# checks the worker output is the same.
+#   sh tests/jobs.sh   (from app/)
+set -e
+here=$(cd "$(dirname "$0")/.." && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+${CC:-gcc} -O2 -o "$work/compiler" "$here/compiler.c"
+
+# Each window of 1000 statements has its own ints and chars, written in its
+# first half and only read in the second. They hold registers for less time
+# than the program-wide variables, so the allocator gives the registers to
+# them, and the windows straddle the chunk boundaries at 3000, 6000 and 9000:
+# a chunk starts with registers that are taken, dirty or have been through
+# divisions and shifts, and are not written again before they are stored.
+# A fixed LCG keeps the program the same with every awk.
+awk 'BEGIN {
+    seed = 12345
+    for (i = 0; i < 8; i++) printf "int i%d = %d;\n", i, i * 7 - 40
+    for (i = 0; i < 4; i++) printf "char c%d = %d;\n", i, i * 9 - 60
+    for (w = 0; w <= 12; w++) printf "int g%d_0, g%d_1, g%d_2;\nchar h%d_0, h%d_1, h%d_2;\n", w, w, w, w, w, w
+    for (n = 0; n < 12000; n++) {
+        w = int((n + 500) / 1000)
+        step = (n + 500) % 1000
+        if (step == 0) {
+            printf "g%d_0 = %d; g%d_1 = %d; g%d_2 = %d;\n", w, n % 97, w, -(n % 89), w, n % 1000
+            printf "h%d_0 = %d; h%d_1 = %d; h%d_2 = %d;\n", w, n % 127, w, -(n % 120), w, n % 60
+            continue
+        }
+        a = step < 500 ? pick(w, 1) : pick(w, 0); b = pick(w, 1); c = pick(w, 1)
+        kind = next_random() % 12
+        if (kind == 0) printf "%s = %s / %d;\n", a, b, next_random() % 9 + 1
+        else if (kind == 1) printf "%s = (%s + %s) * 4;\n", a, b, c
+        else if (kind == 2) printf "%s = %s / 8 - %s;\n", a, b, c
+        else if (kind == 3) printf "%s += %s - %d;\n", a, b, next_random() % 300
+        else if (kind == 4) printf "%s /= %s * %s + 1;\n", a, b, c
+        else if (kind == 5) printf "%s++;\n", a
+        else if (kind == 6) printf "--%s;\n", a
+        else if (kind == 7) printf "%s = -%s;\n", a, b
+        else if (kind == 8) printf "%s = %s;\n", a, b
+        else if (kind == 9) printf "%s = %s + %s / 2;\n", a, b, c
+        else if (kind == 10) printf "%s = %s;\n", a, nested(w, 10)
+        else printf "%s = %d;\n", a, next_random() % 400 - 200
+    }
+}
+function next_random() {
+    seed = (seed * 1103515245 + 12345) % 2147483648
+    return int(seed / 65536)
+}
+# Needs a scratch register per level, more than r1-r7, so it runs into the
+# registers that live variables hold
+function nested(w, depth) {
+    if (depth == 0) return pick(w, 1)
+    return "((" pick(w, 1) " + 1) - " nested(w, depth - 1) ")"
+}
+# a program-wide variable, or one of window w when it may be
+function pick(w, in_window) {
+    v = next_random() % 18
+    if (in_window && v < 3) return "g" w "_" v
+    if (in_window && v < 6) return "h" w "_" (v - 3)
+    v = v % 12
+    return v < 8 ? "i" v : "c" (v - 8)
+}' > "$work/source"
+{ wc -c < "$work/source" | tr -d ' '; cat "$work/source"; } > "$work/request"
+
+for options in "--format binary" "--format hex" "--format raw-le" "--format binary --unused drop"; do
+    # shellcheck disable=SC2086
+    (cd "$work" && ./compiler --worker --emit stdout $options --jobs 1 < request > one 2>&1)
+    # shellcheck disable=SC2086
+    (cd "$work" && ./compiler --worker --emit stdout $options --jobs 4 < request > four 2>&1)
+    if grep -a -q "Error" "$work/one"; then
+        grep -a "Error" "$work/one" | head -5
+        echo "FAIL: $options: the test program did not compile"
+        exit 1
+    fi
+    if ! cmp -s "$work/one" "$work/four"; then
+        echo "FAIL: $options: --jobs 4 output differs from --jobs 1"
+        exit 1
+    fi
+    echo "ok: $options: --jobs 4 matches --jobs 1"
+done
@@ -0,0 +1,715 @@
+// Benchmark driver for csc112.c, transformer.c, app/compiler.c and the
+// flex/y.y interpreter. Build it like the compilers:
+//     gcc -O2 bench/bench.c -o bench/bench
+//
+//   bench gen csc|transformer|flex <statements> [seed]
+//       writes a synthetic program in that dialect to stdout
+//   bench run [--statements N] [--repeat R] [--seed S] [--dir D]
+//             [--csc exe] [--transformer exe] [--app exe] [--flex exe]
+//             [--baseline results.jsonl] [--tolerance percent]
+//       times every front end that was given, end to end and (through
+//       --stats json) per phase, and writes one JSON line per front end.
+//       With --baseline, exits with 1 when statements/sec dropped by more
+//       than --tolerance percent (default 10) against the matching line.
+//
+// Every front end gets the same statement mix: declarations, arithmetic
+// chains, compound assignments, ++/-- and float/char mixes where the
+// dialect has them. The runs happen inside D (default bench_work), so the
+// compilers leave their output.s there.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+
+#define MAX_PATH_LENGTH 4096
+
+// --- Program Generator ---
+
+typedef enum {
+    DIALECT_CSC,          // csc112.c and app/compiler.c: int and char
+    DIALECT_TRANSFORMER,  // adds float
+    DIALECT_FLEX          // numero/letra/desimal/sulat, one statement per line
+} Dialect;
+
+typedef enum {
+    KIND_INT,
+    KIND_CHAR,
+    KIND_FLOAT,
+    KIND_STRING
+} VariableKind;
+
+typedef struct {
+    FILE* output;
+    Dialect dialect;
+    unsigned long long random_state;
+    VariableKind* kinds;  // by variable number, only while generate_program runs
+    int variable_count;
+    int variable_capacity;
+    int tokens;       // what the front end's lexer will see, NEWLINE included
+    int statements;
+} Generator;
+
+// xorshift64*, so a seed gives the same program with every C library
+unsigned next_random(Generator* generator) {
+    unsigned long long x = generator->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    generator->random_state = x;
+    return (unsigned)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+int random_below(Generator* generator, int limit) {
+    return (int)(next_random(generator) % (unsigned)limit);
+}
+
+void emit_token(Generator* generator, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vfprintf(generator->output, format, args);
+    va_end(args);
+    fputc(' ', generator->output);
+    generator->tokens++;
+}
+
+void end_statement(Generator* generator) {
+    if (generator->dialect == DIALECT_FLEX) fputc('\n', generator->output);
+    else fputs(";\n", generator->output);
+    generator->tokens++;
+    generator->statements++;
+}
+
+// A random variable of kind, or -1 when there is none
+int pick_variable(Generator* generator, VariableKind kind) {
+    int matching = 0;
+    for (int i = 0; i < generator->variable_count; i++) {
+        if (generator->kinds[i] == kind) matching++;
+    }
+    if (!matching) return -1;
+    int choice = random_below(generator, matching);
+    for (int i = 0; i < generator->variable_count; i++) {
+        if (generator->kinds[i] == kind && choice-- == 0) return i;
+    }
+    return -1;
+}
+
+void emit_float_literal(Generator* generator) {
+    static const char* literals[] = {"0.5", "1.25", "2.0", "3.75", "0.125"};
+    emit_token(generator, "%s", literals[random_below(generator, 5)]);
+}
+
+// An int variable, or now and then a literal
+void emit_int_operand(Generator* generator) {
+    int variable = pick_variable(generator, KIND_INT);
+    if (variable < 0 || random_below(generator, 4) == 0) {
+        emit_token(generator, "%d", 1 + random_below(generator, 99));
+    } else {
+        emit_token(generator, "v%d", variable);
+    }
+}
+
+void emit_float_operand(Generator* generator) {
+    int variable = pick_variable(generator, KIND_FLOAT);
+    if (variable < 0 || random_below(generator, 3) == 0) emit_float_literal(generator);
+    else emit_token(generator, "v%d", variable);
+}
+
+// term (op term)*, with the occasional parenthesised pair. Divisors are
+// always nonzero literals: a division by zero stops the flex interpreter.
+void emit_chain(Generator* generator, VariableKind kind, int terms) {
+    static const char operators[] = "+-*/";
+    for (int i = 0; i < terms; i++) {
+        char op = operators[random_below(generator, 4)];
+        if (i > 0) emit_token(generator, "%c", op);
+        if (i > 0 && op == '/') {
+            if (kind == KIND_FLOAT) emit_token(generator, "2.0");
+            else emit_token(generator, "%d", 2 + random_below(generator, 8));
+            continue;
+        }
+        bool grouped = terms > 2 && random_below(generator, 5) == 0;
+        if (grouped) emit_token(generator, "(");
+        if (kind == KIND_FLOAT) emit_float_operand(generator);
+        else emit_int_operand(generator);
+        if (grouped) {
+            emit_token(generator, "%c", operators[random_below(generator, 2)]);
+            if (kind == KIND_FLOAT) emit_float_operand(generator);
+            else emit_int_operand(generator);
+            emit_token(generator, ")");
+        }
+    }
+}
+
+void emit_char_literal(Generator* generator) {
+    emit_token(generator, "'%c'", 'a' + random_below(generator, 26));
+}
+
+void generate_declaration(Generator* generator) {
+    static const char* keywords[][4] = {
+        [DIALECT_CSC] = {"int", "char", NULL, NULL},
+        [DIALECT_TRANSFORMER] = {"int", "char", "float", NULL},
+        [DIALECT_FLEX] = {"numero", "letra", "desimal", "sulat"},
+    };
+    int roll = random_below(generator, 100);
+    VariableKind kind = roll < 60 ? KIND_INT : roll < 75 ? KIND_CHAR : roll < 95 ? KIND_FLOAT : KIND_STRING;
+    if (!keywords[generator->dialect][kind]) kind = KIND_INT;
+
+    int variable = generator->variable_count;
+    emit_token(generator, "%s", keywords[generator->dialect][kind]);
+    emit_token(generator, "v%d", variable);
+    emit_token(generator, "=");
+    if (kind == KIND_CHAR) emit_char_literal(generator);
+    else if (kind == KIND_STRING) emit_token(generator, "\"s%d\"", variable);
+    else emit_chain(generator, kind, 1 + random_below(generator, 4));
+    end_statement(generator);
+    // Registered after its initialiser, which must not read it
+    generator->kinds[generator->variable_count++] = kind;
+}
+
+void generate_assignment(Generator* generator) {
+    bool use_float = generator->dialect != DIALECT_CSC && random_below(generator, 4) == 0;
+    int target = pick_variable(generator, use_float ? KIND_FLOAT : KIND_INT);
+    if (target < 0) target = pick_variable(generator, KIND_INT);
+    VariableKind kind = generator->kinds[target];
+    emit_token(generator, "v%d", target);
+    emit_token(generator, "=");
+    emit_chain(generator, kind, 2 + random_below(generator, 6));
+    end_statement(generator);
+}
+
+void generate_compound_assignment(Generator* generator) {
+    static const char* operators[] = {"+=", "-=", "*=", "/="};
+    bool use_float = generator->dialect != DIALECT_CSC && random_below(generator, 4) == 0;
+    int target = pick_variable(generator, use_float ? KIND_FLOAT : KIND_INT);
+    if (target < 0) target = pick_variable(generator, KIND_INT);
+    VariableKind kind = generator->kinds[target];
+    int op = random_below(generator, 4);
+    emit_token(generator, "v%d", target);
+    emit_token(generator, "%s", operators[op]);
+    if (op == 3) emit_token(generator, kind == KIND_FLOAT ? "2.0" : "%d", 2 + random_below(generator, 8));
+    else emit_chain(generator, kind, 1 + random_below(generator, 3));
+    end_statement(generator);
+}
+
+void generate_step(Generator* generator) {
+    int target = pick_variable(generator, KIND_INT);
+    const char* op = random_below(generator, 2) ? "++" : "--";
+    if (random_below(generator, 2)) {
+        emit_token(generator, "%s", op);
+        emit_token(generator, "v%d", target);
+    } else {
+        emit_token(generator, "v%d", target);
+        emit_token(generator, "%s", op);
+    }
+    end_statement(generator);
+}
+
+// char arithmetic for the compilers, a print for the interpreter
+void generate_mix(Generator* generator) {
+    if (generator->dialect == DIALECT_FLEX) {
+        int variable = random_below(generator, generator->variable_count);
+        emit_token(generator, "ilimbag");
+        emit_token(generator, "\"v%d: \"", variable);
+        emit_token(generator, ",");
+        emit_token(generator, "v%d", variable);
+        end_statement(generator);
+        return;
+    }
+    int target = pick_variable(generator, KIND_CHAR);
+    if (target < 0) {
+        generate_compound_assignment(generator);
+        return;
+    }
+    emit_token(generator, "v%d", target);
+    if (random_below(generator, 2)) {
+        emit_token(generator, "=");
+        emit_char_literal(generator);
+    } else {
+        emit_token(generator, "+=");
+        emit_token(generator, "1");
+    }
+    end_statement(generator);
+}
+
+// Makes room in kinds for one more variable
+bool reserve_variable(Generator* generator) {
+    if (generator->variable_count < generator->variable_capacity) return true;
+    int capacity = generator->variable_capacity ? generator->variable_capacity * 2 : 64;
+    VariableKind* kinds = realloc(generator->kinds, capacity * sizeof(VariableKind));
+    if (!kinds) return false;
+    generator->kinds = kinds;
+    generator->variable_capacity = capacity;
+    return true;
+}
+
+// Returns false when the variable list could not grow; the program written
+// so far is then incomplete
+bool generate_program(Generator* generator, int statement_count) {
+    bool complete = true;
+    while (generator->statements < statement_count) {
+        int roll = random_below(generator, 100);
+        bool has_int = pick_variable(generator, KIND_INT) >= 0;
+        if (!has_int || roll < 15) {
+            if (!reserve_variable(generator)) {
+                complete = false;
+                break;
+            }
+            generate_declaration(generator);
+        } else if (roll < 50) {
+            generate_assignment(generator);
+        } else if (roll < 80) {
+            generate_compound_assignment(generator);
+        } else if (roll < 90) {
+            generate_step(generator);
+        } else {
+            generate_mix(generator);
+        }
+    }
+    free(generator->kinds);
+    generator->kinds = NULL;
+    generator->variable_capacity = 0;
+    return complete;
+}
+
+bool parse_dialect(const char* name, Dialect* dialect) {
+    if (strcmp(name, "csc") == 0) *dialect = DIALECT_CSC;
+    else if (strcmp(name, "transformer") == 0) *dialect = DIALECT_TRANSFORMER;
+    else if (strcmp(name, "flex") == 0) *dialect = DIALECT_FLEX;
+    else return false;
+    return true;
+}
+
+// Writes the program to path and returns its token and statement counts
+bool write_program(const char* path, Dialect dialect, int statement_count, unsigned long long seed,
+                   Generator* result) {
+    FILE* output = fopen(path, "w");
+    if (!output) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return false;
+    }
+    *result = (Generator){.output = output, .dialect = dialect, .random_state = seed | 1};
+    bool written = generate_program(result, statement_count);
+    written = !ferror(output) && written;
+    fclose(output);
+    return written;
+}
+
+// --- Process Runner ---
+
+typedef struct {
+    double wall_milliseconds;
+    long peak_rss_kilobytes;
+    int exit_code;
+} RunResult;
+
+double elapsed_seconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+bool absolute_path(const char* path, char* buffer) {
+#ifdef _WIN32
+    return _fullpath(buffer, path, MAX_PATH_LENGTH) != NULL;
+#else
+    return realpath(path, buffer) != NULL;
+#endif
+}
+
+bool make_directory(const char* path) {
+#ifdef _WIN32
+    return _mkdir(path) == 0 || GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat info;
+    return mkdir(path, 0777) == 0 || (stat(path, &info) == 0 && S_ISDIR(info.st_mode));
+#endif
+}
+
+// Runs argv[0] inside directory with the three standard streams redirected
+// to the given files (paths relative to our own working directory).
+bool run_process(char* const argv[], const char* directory, const char* stdin_path,
+                 const char* stdout_path, const char* stderr_path, RunResult* result) {
+    struct timespec start, end;
+#ifdef _WIN32
+    char command_line[32768];
+    size_t length = 0;
+    for (int i = 0; argv[i]; i++) {
+        int written = snprintf(command_line + length, sizeof(command_line) - length, "%s\"%s\"",
+                               i ? " " : "", argv[i]);
+        if (written < 0 || (size_t)written >= sizeof(command_line) - length) return false;
+        length += written;
+    }
+    SECURITY_ATTRIBUTES inherit = {sizeof(inherit), NULL, TRUE};
+    HANDLE input = CreateFileA(stdin_path, GENERIC_READ, FILE_SHARE_READ, &inherit, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL, NULL);
+    HANDLE output = CreateFileA(stdout_path, GENERIC_WRITE, 0, &inherit, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    HANDLE errors = CreateFileA(stderr_path, GENERIC_WRITE, 0, &inherit, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    STARTUPINFOA startup = {sizeof(startup)};
+    startup.dwFlags = STARTF_USESTDHANDLES;
+    startup.hStdInput = input;
+    startup.hStdOutput = output;
+    startup.hStdError = errors;
+    PROCESS_INFORMATION process;
+    timespec_get(&start, TIME_UTC);
+    bool started = input != INVALID_HANDLE_VALUE && output != INVALID_HANDLE_VALUE &&
+                   errors != INVALID_HANDLE_VALUE &&
+                   CreateProcessA(NULL, command_line, NULL, NULL, TRUE, 0, NULL, directory, &startup, &process);
+    if (input != INVALID_HANDLE_VALUE) CloseHandle(input);
+    if (output != INVALID_HANDLE_VALUE) CloseHandle(output);
+    if (errors != INVALID_HANDLE_VALUE) CloseHandle(errors);
+    if (!started) return false;
+    WaitForSingleObject(process.hProcess, INFINITE);
+    timespec_get(&end, TIME_UTC);
+    DWORD exit_code = 1;
+    GetExitCodeProcess(process.hProcess, &exit_code);
+    PROCESS_MEMORY_COUNTERS memory = {sizeof(memory)};
+    GetProcessMemoryInfo(process.hProcess, &memory, sizeof(memory));
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+    result->exit_code = (int)exit_code;
+    result->peak_rss_kilobytes = (long)(memory.PeakWorkingSetSize / 1024);
+#else
+    timespec_get(&start, TIME_UTC);
+    pid_t child = fork();
+    if (child < 0) return false;
+    if (child == 0) {
+        int input = open(stdin_path, O_RDONLY);
+        int output = open(stdout_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        int errors = open(stderr_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (input < 0 || output < 0 || errors < 0 || dup2(input, 0) < 0 || dup2(output, 1) < 0 ||
+            dup2(errors, 2) < 0 || chdir(directory) != 0) _exit(127);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) != child) return false;
+    timespec_get(&end, TIME_UTC);
+    result->exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128;
+#ifdef __APPLE__
+    result->peak_rss_kilobytes = usage.ru_maxrss / 1024;
+#else
+    result->peak_rss_kilobytes = usage.ru_maxrss;
+#endif
+#endif
+    result->wall_milliseconds = 1000 * elapsed_seconds(start, end);
+    return true;
+}
+
+// --- Benchmark ---
+
+typedef struct {
+    const char* name;
+    Dialect dialect;
+    char program[MAX_PATH_LENGTH];  // absolute, since it runs inside the work directory
+    bool worker;                    // app/compiler.c, fed one --worker request
+    bool has_stats;                 // understands --stats json
+} FrontEnd;
+
+// Phase names of the --stats json line, copied into our result line
+static const char* phase_keys[] = {
+    "lex_ms", "parse_ms", "semantic_ms", "optimize_ms", "codegen_ms", "output_ms"
+};
+#define PHASE_KEY_COUNT (int)(sizeof(phase_keys) / sizeof(phase_keys[0]))
+
+char* read_whole_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    rewind(file);
+    char* text = length >= 0 ? malloc(length + 1) : NULL;
+    if (text) text[fread(text, 1, length, file)] = '\0';
+    fclose(file);
+    return text;
+}
+
+// The value of "key": in a flat JSON line, or -1 when it is missing
+double json_number(const char* line, const char* key) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char* found = strstr(line, pattern);
+    return found ? strtod(found + strlen(pattern), NULL) : -1;
+}
+
+// Copies the last --stats json line of the file into line. The file is
+// streamed rather than loaded: a child's peak RSS starts from ours, which
+// it inherits when it forks.
+bool find_stats_line(const char* path, char* line, size_t size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    char chunk[1024];
+    bool found = false;
+    bool at_line_start = true;
+    while (fgets(chunk, sizeof(chunk), file)) {
+        if (at_line_start && strncmp(chunk, "{\"compiled\":", 12) == 0) {
+            snprintf(line, size, "%s", chunk);
+            found = true;
+        }
+        at_line_start = strchr(chunk, '\n') != NULL;
+    }
+    fclose(file);
+    return found;
+}
+
+// The worker reads "<length>\n<source>" requests from stdin
+bool write_worker_request(const char* source_path, const char* request_path) {
+    FILE* source = fopen(source_path, "rb");
+    if (!source) return false;
+    FILE* request = fopen(request_path, "wb");
+    if (!request) {
+        fclose(source);
+        return false;
+    }
+    fseek(source, 0, SEEK_END);
+    fprintf(request, "%ld\n", ftell(source));
+    rewind(source);
+    char chunk[65536];
+    size_t length;
+    while ((length = fread(chunk, 1, sizeof(chunk), source)) > 0) fwrite(chunk, 1, length, request);
+    fclose(source);
+    bool written = !ferror(request);
+    fclose(request);
+    return written;
+}
+
+typedef struct {
+    double wall_milliseconds;       // best of the runs
+    long peak_rss_kilobytes;        // worst of the runs
+    double phase_milliseconds[PHASE_KEY_COUNT];
+    bool has_phases;
+} Measurement;
+
+bool measure_front_end(const FrontEnd* front_end, const char* directory, int statement_count,
+                       unsigned long long seed, int repeat, Generator* program, Measurement* measurement) {
+    char source_path[MAX_PATH_LENGTH], input_path[MAX_PATH_LENGTH];
+    char stdout_path[MAX_PATH_LENGTH], stderr_path[MAX_PATH_LENGTH];
+    snprintf(source_path, sizeof(source_path), "%s/%s.b", directory, front_end->name);
+    snprintf(input_path, sizeof(input_path), "%s/%s.in", directory, front_end->name);
+    snprintf(stdout_path, sizeof(stdout_path), "%s/%s.out", directory, front_end->name);
+    snprintf(stderr_path, sizeof(stderr_path), "%s/%s.err", directory, front_end->name);
+    if (!write_program(source_path, front_end->dialect, statement_count, seed, program)) return false;
+
+    char absolute_source[MAX_PATH_LENGTH];
+    if (!absolute_path(source_path, absolute_source)) return false;
+    char* argv[8];
+    int argc = 0;
+    argv[argc++] = (char*)front_end->program;
+    if (front_end->worker) argv[argc++] = "--worker";
+    else if (front_end->has_stats) {
+        argv[argc++] = "--emit";
+        argv[argc++] = "file";
+    }
+    if (front_end->has_stats) {
+        argv[argc++] = "--stats";
+        argv[argc++] = "json";
+    }
+    // transformer.c takes the path; the others read stdin
+    if (front_end->dialect == DIALECT_TRANSFORMER) argv[argc++] = absolute_source;
+    argv[argc] = NULL;
+    if (front_end->worker) {
+        if (!write_worker_request(source_path, input_path)) return false;
+    } else {
+        snprintf(input_path, sizeof(input_path), "%s", source_path);
+    }
+
+    *measurement = (Measurement){0};
+    for (int run = 0; run < repeat; run++) {
+        RunResult result;
+        if (!run_process(argv, directory, input_path, stdout_path, stderr_path, &result)) {
+            fprintf(stderr, "%s: cannot run %s\n", front_end->name, front_end->program);
+            return false;
+        }
+        // The worker sends its line as a frame on stdout, the others use stderr
+        char stats[1024];
+        bool has_stats = front_end->has_stats &&
+                         find_stats_line(front_end->worker ? stdout_path : stderr_path, stats, sizeof(stats));
+        bool compiled = result.exit_code == 0 &&
+                        (!front_end->has_stats || (has_stats && strncmp(stats, "{\"compiled\":true", 16) == 0));
+        if (!compiled) {
+            fprintf(stderr, "%s: the generated program did not compile (exit code %d), see %s and %s\n",
+                    front_end->name, result.exit_code, stdout_path, stderr_path);
+            return false;
+        }
+        if (run == 0 || result.wall_milliseconds < measurement->wall_milliseconds) {
+            measurement->wall_milliseconds = result.wall_milliseconds;
+            measurement->has_phases = has_stats;
+            for (int i = 0; has_stats && i < PHASE_KEY_COUNT; i++) {
+                measurement->phase_milliseconds[i] = json_number(stats, phase_keys[i]);
+            }
+        }
+        if (result.peak_rss_kilobytes > measurement->peak_rss_kilobytes) {
+            measurement->peak_rss_kilobytes = result.peak_rss_kilobytes;
+        }
+    }
+    return true;
+}
+
+void format_result_line(const FrontEnd* front_end, const Generator* program, int repeat,
+                        const Measurement* measurement, char* line, size_t size) {
+    double seconds = measurement->wall_milliseconds / 1000;
+    int length = snprintf(line, size,
+                          "{\"front_end\":\"%s\",\"statements\":%d,\"tokens\":%d,\"runs\":%d,\"wall_ms\":%.3f,"
+                          "\"tokens_per_sec\":%.0f,\"statements_per_sec\":%.0f,\"peak_rss_kb\":%ld",
+                          front_end->name, program->statements, program->tokens, repeat,
+                          measurement->wall_milliseconds, program->tokens / seconds,
+                          program->statements / seconds, measurement->peak_rss_kilobytes);
+    for (int i = 0; measurement->has_phases && i < PHASE_KEY_COUNT; i++) {
+        length += snprintf(line + length, size - length, ",\"%s\":%.3f", phase_keys[i],
+                           measurement->phase_milliseconds[i]);
+    }
+    snprintf(line + length, size - length, "}");
+}
+
+// Compares line against the baseline line of the same front end and size.
+// Returns false on a regression beyond tolerance percent.
+bool check_baseline(const char* baseline, const FrontEnd* front_end, const char* line, double tolerance) {
+    char key[64];
+    snprintf(key, sizeof(key), "{\"front_end\":\"%s\",", front_end->name);
+    const char* previous = NULL;
+    for (const char* candidate = baseline; (candidate = strstr(candidate, key)); candidate++) {
+        if (json_number(candidate, "statements") == json_number(line, "statements")) previous = candidate;
+    }
+    if (!previous) {
+        fprintf(stderr, "%s: no baseline for this size\n", front_end->name);
+        return true;
+    }
+    double before = json_number(previous, "statements_per_sec");
+    double now = json_number(line, "statements_per_sec");
+    double change = before > 0 ? 100 * (now - before) / before : 0;
+    fprintf(stderr, "%s: %.0f -> %.0f statements/sec (%+.1f%%)\n", front_end->name, before, now, change);
+    if (change < -tolerance) {
+        fprintf(stderr, "%s: regression beyond %.1f%%\n", front_end->name, tolerance);
+        return false;
+    }
+    return true;
+}
+
+void print_usage(const char* program) {
+    printf("Usage: %s gen csc|transformer|flex <statements> [seed]\n", program);
+    printf("       %s run [--statements N] [--repeat R] [--seed S] [--dir D]\n", program);
+    printf("              [--csc exe] [--transformer exe] [--app exe] [--flex exe]\n");
+    printf("              [--baseline results.jsonl] [--tolerance percent]\n");
+}
+
+int run_benchmark(int argc, char* argv[]) {
+    int statement_count = 20000;
+    int repeat = 5;
+    unsigned long long seed = 1;
+    const char* directory = "bench_work";
+    const char* baseline_path = NULL;
+    double tolerance = 10;
+    FrontEnd front_ends[4];
+    int front_end_count = 0;
+
+    for (int i = 2; i < argc; i += 2) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        FrontEnd front_end = {0};
+        bool valid = true;
+        if (!value) {
+            valid = false;
+        } else if (strcmp(option, "--statements") == 0) {
+            statement_count = atoi(value);
+            valid = statement_count > 0;
+        } else if (strcmp(option, "--repeat") == 0) {
+            repeat = atoi(value);
+            valid = repeat > 0;
+        } else if (strcmp(option, "--seed") == 0) {
+            seed = strtoull(value, NULL, 10);
+        } else if (strcmp(option, "--dir") == 0) {
+            directory = value;
+        } else if (strcmp(option, "--baseline") == 0) {
+            baseline_path = value;
+        } else if (strcmp(option, "--tolerance") == 0) {
+            tolerance = atof(value);
+        } else if (strcmp(option, "--csc") == 0) {
+            front_end = (FrontEnd){"csc112", DIALECT_CSC, "", false, true};
+        } else if (strcmp(option, "--transformer") == 0) {
+            front_end = (FrontEnd){"transformer", DIALECT_TRANSFORMER, "", false, true};
+        } else if (strcmp(option, "--app") == 0) {
+            front_end = (FrontEnd){"app", DIALECT_CSC, "", true, true};
+        } else if (strcmp(option, "--flex") == 0) {
+            front_end = (FrontEnd){"flex", DIALECT_FLEX, "", false, false};
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (front_end.name) {
+            if (!absolute_path(value, front_end.program)) {
+                fprintf(stderr, "cannot find %s\n", value);
+                return 1;
+            }
+            front_ends[front_end_count++] = front_end;
+        }
+    }
+    if (!front_end_count) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (!make_directory(directory)) {
+        fprintf(stderr, "cannot create %s\n", directory);
+        return 1;
+    }
+    char* baseline = NULL;
+    if (baseline_path && !(baseline = read_whole_file(baseline_path))) {
+        fprintf(stderr, "cannot read %s\n", baseline_path);
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = 0; i < front_end_count; i++) {
+        Generator program;
+        Measurement measurement;
+        if (!measure_front_end(&front_ends[i], directory, statement_count, seed, repeat, &program, &measurement)) {
+            status = 1;
+            continue;
+        }
+        char line[1024];
+        format_result_line(&front_ends[i], &program, repeat, &measurement, line, sizeof(line));
+        printf("%s\n", line);
+        fflush(stdout);
+        if (baseline && !check_baseline(baseline, &front_ends[i], line, tolerance)) status = 1;
+    }
+    free(baseline);
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 4 && strcmp(argv[1], "gen") == 0) {
+        Dialect dialect;
+        int statement_count = atoi(argv[3]);
+        if (!parse_dialect(argv[2], &dialect) || statement_count <= 0) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        Generator generator = {
+            .output = stdout,
+            .dialect = dialect,
+            .random_state = (argc > 4 ? strtoull(argv[4], NULL, 10) : 1) | 1,
+        };
+        if (!generate_program(&generator, statement_count)) {
+            fprintf(stderr, "out of memory generating the program\n");
+            return 1;
+        }
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) return run_benchmark(argc, argv);
+    print_usage(argv[0]);
+    return 1;
+}
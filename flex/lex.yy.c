@@ -441,7 +441,12 @@ char *yytext;
 #include <stdlib.h>
 #include "types.h"
 #include "y.tab.h"
-#line 445 "lex.yy.c"
+
+/* defined in y.y */
+void lexer_error(char c);
+int intern_symbol(const char *name);
+int intern_literal(const char *raw_str);
+#line 450 "lex.yy.c"
 
 /* Macros after this point can all be overridden by user definitions in
  * section 1.
@@ -592,10 +597,10 @@ YY_DECL
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
 
-#line 12 "l.l"
+#line 17 "l.l"
 
 
-#line 599 "lex.yy.c"
+#line 604 "lex.yy.c"
 
 	if ( yy_init )
 		{
@@ -688,138 +693,138 @@ do_action:	/* This label is used only to access EOF actions. */
 	{ /* beginning of action switch */
 case 1:
 YY_RULE_SETUP
-#line 14 "l.l"
+#line 19 "l.l"
 ; 
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 15 "l.l"
+#line 20 "l.l"
 ;  
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 16 "l.l"
+#line 21 "l.l"
 { return NEWLINE; }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 18 "l.l"
+#line 23 "l.l"
 { return COMMA; }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 19 "l.l"
+#line 24 "l.l"
 { return SEMICOLON; }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 20 "l.l"
+#line 25 "l.l"
 { return ASSIGN; }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 22 "l.l"
+#line 27 "l.l"
 { return INCREMENT; }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 23 "l.l"
+#line 28 "l.l"
 { return DECREMENT; }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 25 "l.l"
+#line 30 "l.l"
 { return PLUS_ASSIGN; }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 26 "l.l"
+#line 31 "l.l"
 { return MINUS_ASSIGN; }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 27 "l.l"
+#line 32 "l.l"
 { return MULTIPLY_ASSIGN; }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 28 "l.l"
+#line 33 "l.l"
 { return DIVIDE_ASSIGN; }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 30 "l.l"
+#line 35 "l.l"
 { return PLUS; }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 31 "l.l"
+#line 36 "l.l"
 { return MINUS; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 32 "l.l"
+#line 37 "l.l"
 { return MULTIPLY; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 33 "l.l"
+#line 38 "l.l"
 { return DIVIDE; }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 35 "l.l"
+#line 40 "l.l"
 { return LPAREN; }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 36 "l.l"
+#line 41 "l.l"
 { return RPAREN; }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 38 "l.l"
+#line 43 "l.l"
 { return ilimbag; }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 39 "l.l"
+#line 44 "l.l"
 { return numero; }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 40 "l.l"
+#line 45 "l.l"
 { return sulat; }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 41 "l.l"
+#line 46 "l.l"
 { return letra; }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 42 "l.l"
+#line 47 "l.l"
 { return desimal; }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 44 "l.l"
+#line 49 "l.l"
 { 
-    yylval.str = strdup(yytext); 
+    yylval.lit = intern_literal(yytext); 
     return STRING_LITERAL; 
 }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 49 "l.l"
+#line 54 "l.l"
 { 
-    yylval.str = strdup(yytext); 
+    yylval.lit = intern_literal(yytext); 
     return CHARACTER; 
 } 
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 54 "l.l"
+#line 59 "l.l"
 { 
     yylval.num = atoi(yytext); 
     return INTEGER; 
@@ -827,7 +832,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 59 "l.l"
+#line 64 "l.l"
 { 
     yylval.float_num = atof(yytext); 
     return FLOAT; 
@@ -835,7 +840,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 64 "l.l"
+#line 69 "l.l"
 { 
     yylval.float_num = atof(yytext); 
     return FLOAT; 
@@ -843,26 +848,26 @@ YY_RULE_SETUP
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 69 "l.l"
+#line 74 "l.l"
 {  
-    yylval.str = strdup(yytext);
+    yylval.sym = intern_symbol(yytext);
     return IDENTIFIER;
 }
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 74 "l.l"
+#line 79 "l.l"
 {  
-    fprintf(stderr, "LEXER ERROR: Invalid character '%c' at line %d\n", *yytext, yylineno);
-    exit(1);
+    /* reported by y.y, which stops compiling at this point */
+    lexer_error(*yytext);
 }
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 79 "l.l"
+#line 84 "l.l"
 ECHO;
 	YY_BREAK
-#line 866 "lex.yy.c"
+#line 871 "lex.yy.c"
 			case YY_STATE_EOF(INITIAL):
 				yyterminate();
 
@@ -1746,4 +1751,4 @@ int main()
 	return 0;
 	}
 #endif
-#line 79 "l.l"
+#line 84 "l.l"
@@ -3,28 +3,22 @@
 
 #include <stdlib.h> 
 
-/* Definition for Math Expressions */
-typedef struct {
-    int type;      // 0 = int, 1 = float, 2 = string, 3 = char
-    int i_val;     // used for int and char (ASCII)
-    float f_val;
-    char *s_val;   
-} ExprVal;
+/* Static type of a variable or an expression */
+typedef enum {
+    TYPE_INT,
+    TYPE_FLOAT,
+    TYPE_STRING,
+    TYPE_CHAR
+} ValueType;
 
-/* Definition for Print Items */
+/* Definition for Print Items. Expression items are compiled as they are
+   parsed, so their values are already on the VM stack in list order. */
 typedef struct print_item {
     enum { PRINT_STRING, PRINT_CHAR, PRINT_EXPR } type; 
     union {
         char *str;
         char char_val;
-        struct {
-            int type; // 0=int, 1=float, 2=string, 3=char
-            union {
-                int i_val;
-                float f_val;
-                char *s_val;
-            } value;
-        } expr_val;
+        ValueType expr_type;
     } value;
     struct print_item *next;
 } print_item;
@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vm.h"
+
+/* Declare the function from tools.c */
+extern int checkError(int a, int b);
+
+/* Dispatch through a label table where the compiler supports it (GCC and
+   Clang), otherwise through a switch in a loop. */
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO 1
+#endif
+
+void program_init(Program *program) {
+    memset(program, 0, sizeof(*program));
+}
+
+void program_free(Program *program) {
+    for (int i = 0; i < program->string_count; i++) free(program->strings[i]);
+    free(program->strings);
+    free(program->string_lengths);
+    free(program->string_hashes);
+    free(program->string_index);
+    free(program->code);
+    free(program->lines);
+    memset(program, 0, sizeof(*program));
+}
+
+/* How many entries an instruction adds to (or removes from) the stack */
+static int stack_effect(Opcode opcode, int operand) {
+    switch (opcode) {
+        case OP_PUSH_INT: case OP_PUSH_FLOAT: case OP_PUSH_STRING: case OP_LOAD:
+            return 1;
+        case OP_POP:
+            return -operand;
+        case OP_STORE:
+        case OP_ADD_INT: case OP_SUB_INT: case OP_MUL_INT: case OP_DIV_INT:
+        case OP_ADD_FLOAT: case OP_SUB_FLOAT: case OP_MUL_FLOAT: case OP_DIV_FLOAT:
+        case OP_ADD_TO_INT: case OP_SUB_TO_INT: case OP_MUL_TO_INT: case OP_DIV_TO_INT:
+        case OP_ADD_TO_FLOAT: case OP_SUB_TO_FLOAT: case OP_MUL_TO_FLOAT: case OP_DIV_TO_FLOAT:
+            return -1;
+        default:
+            return 0;
+    }
+}
+
+static Instruction* append_instruction(Program *program, Opcode opcode, int line) {
+    if (program->count == program->capacity) {
+        program->capacity = program->capacity ? program->capacity * 2 : 256;
+        program->code = realloc(program->code, program->capacity * sizeof(Instruction));
+        program->lines = realloc(program->lines, program->capacity * sizeof(int));
+        if (!program->code || !program->lines) {
+            fprintf(stderr, "Out of memory while compiling\n");
+            exit(1);
+        }
+    }
+    program->lines[program->count] = line;
+    Instruction *instruction = &program->code[program->count++];
+    instruction->opcode = opcode;
+    return instruction;
+}
+
+void emit(Program *program, Opcode opcode, int operand, int line) {
+    append_instruction(program, opcode, line)->operand.i = operand;
+    program->depth += stack_effect(opcode, operand);
+    if (program->depth > program->max_depth) program->max_depth = program->depth;
+}
+
+void emit_float(Program *program, float operand, int line) {
+    append_instruction(program, OP_PUSH_FLOAT, line)->operand.f = operand;
+    program->depth++;
+    if (program->depth > program->max_depth) program->max_depth = program->depth;
+}
+
+/* FNV-1a */
+unsigned hash_bytes(const char *text, size_t length) {
+    unsigned hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    return hash;
+}
+
+static void grow_string_index(Program *program) {
+    free(program->string_index);
+    program->string_index_size = program->string_index_size ? program->string_index_size * 2 : 256;
+    program->string_index = malloc(program->string_index_size * sizeof(int));
+    if (!program->string_index) {
+        fprintf(stderr, "Out of memory while compiling\n");
+        exit(1);
+    }
+    memset(program->string_index, -1, program->string_index_size * sizeof(int));
+    unsigned mask = program->string_index_size - 1;
+    for (int id = 0; id < program->string_count; id++) {
+        unsigned i = program->string_hashes[id] & mask;
+        while (program->string_index[i] != -1) i = (i + 1) & mask;
+        program->string_index[i] = id;
+    }
+}
+
+int intern_string(Program *program, const char *text, size_t length) {
+    if (2 * (program->string_count + 1) > program->string_index_size) grow_string_index(program);
+
+    unsigned hash = hash_bytes(text, length);
+    unsigned mask = program->string_index_size - 1;
+    unsigned i = hash & mask;
+    for (int id; (id = program->string_index[i]) != -1; i = (i + 1) & mask) {
+        if (program->string_hashes[id] == hash && (size_t)program->string_lengths[id] == length
+                && memcmp(program->strings[id], text, length) == 0) {
+            return id;
+        }
+    }
+
+    if (program->string_count == program->string_capacity) {
+        program->string_capacity = program->string_capacity ? program->string_capacity * 2 : 64;
+        program->strings = realloc(program->strings, program->string_capacity * sizeof(char*));
+        program->string_lengths = realloc(program->string_lengths, program->string_capacity * sizeof(int));
+        program->string_hashes = realloc(program->string_hashes, program->string_capacity * sizeof(unsigned));
+        if (!program->strings || !program->string_lengths || !program->string_hashes) {
+            fprintf(stderr, "Out of memory while compiling\n");
+            exit(1);
+        }
+    }
+    char *copy = malloc(length + 1);
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    int id = program->string_count++;
+    program->strings[id] = copy;
+    program->string_lengths[id] = (int)length;
+    program->string_hashes[id] = hash;
+    program->string_index[i] = id;
+    return id;
+}
+
+/* --- Output Buffer --- */
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+#define MAX_NUMBER_LENGTH 64  /* "%.2f" of FLT_MAX is 43 characters */
+
+static char output[OUTPUT_BUFFER_SIZE];
+static size_t output_length = 0;
+
+static void flush_output(void) {
+    fwrite(output, 1, output_length, stdout);
+    output_length = 0;
+    fflush(stdout);
+}
+
+static void write_text(const char *text, size_t length) {
+    if (output_length + length > OUTPUT_BUFFER_SIZE) {
+        flush_output();
+        if (length > OUTPUT_BUFFER_SIZE) {
+            fwrite(text, 1, length, stdout);
+            return;
+        }
+    }
+    memcpy(output + output_length, text, length);
+    output_length += length;
+}
+
+static void write_int(int value) {
+    if (output_length + MAX_NUMBER_LENGTH > OUTPUT_BUFFER_SIZE) flush_output();
+    char digits[12];
+    int count = 0;
+    unsigned magnitude = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) output[output_length++] = '-';
+    while (count) output[output_length++] = digits[--count];
+}
+
+static void write_float(float value) {
+    if (output_length + MAX_NUMBER_LENGTH > OUTPUT_BUFFER_SIZE) flush_output();
+    output_length += snprintf(output + output_length, MAX_NUMBER_LENGTH, "%.2f", value);
+}
+
+static void write_char(char c) {
+    if (output_length == OUTPUT_BUFFER_SIZE) flush_output();
+    output[output_length++] = c;
+}
+
+int run_program(const Program *program) {
+    Value *slots = calloc(program->slot_count + 1, sizeof(Value));
+    Value *stack = malloc((program->max_depth + 1) * sizeof(Value));
+    if (!slots || !stack) {
+        fprintf(stderr, "Out of memory while running\n");
+        exit(1);
+    }
+
+    char *const *strings = program->strings;
+    const int *string_lengths = program->string_lengths;
+    const Instruction *ip = program->code;
+    const Instruction *in;
+    Value *sp = stack;  /* next free entry */
+    int status = 0;
+
+#ifdef VM_COMPUTED_GOTO
+#define LABEL(op) [op] = &&label_##op
+    static void *const dispatch[OP_COUNT] = {
+        LABEL(OP_PUSH_INT), LABEL(OP_PUSH_FLOAT), LABEL(OP_PUSH_STRING),
+        LABEL(OP_LOAD), LABEL(OP_STORE), LABEL(OP_POP),
+        LABEL(OP_INT_TO_FLOAT), LABEL(OP_INT_TO_FLOAT_2), LABEL(OP_FLOAT_TO_INT),
+        LABEL(OP_ADD_INT), LABEL(OP_SUB_INT), LABEL(OP_MUL_INT), LABEL(OP_DIV_INT),
+        LABEL(OP_ADD_FLOAT), LABEL(OP_SUB_FLOAT), LABEL(OP_MUL_FLOAT), LABEL(OP_DIV_FLOAT),
+        LABEL(OP_NEG_INT), LABEL(OP_NEG_FLOAT),
+        LABEL(OP_ADD_TO_INT), LABEL(OP_SUB_TO_INT), LABEL(OP_MUL_TO_INT), LABEL(OP_DIV_TO_INT),
+        LABEL(OP_ADD_TO_FLOAT), LABEL(OP_SUB_TO_FLOAT), LABEL(OP_MUL_TO_FLOAT), LABEL(OP_DIV_TO_FLOAT),
+        LABEL(OP_INC_INT), LABEL(OP_DEC_INT), LABEL(OP_INC_FLOAT), LABEL(OP_DEC_FLOAT),
+        LABEL(OP_PRINT_TEXT),
+        LABEL(OP_PRINT_INT), LABEL(OP_PRINT_FLOAT), LABEL(OP_PRINT_STRING), LABEL(OP_PRINT_CHAR),
+        LABEL(OP_RAISE), LABEL(OP_HALT),
+    };
+#undef LABEL
+#define CASE(op) label_##op:
+#define NEXT() goto *dispatch[(in = ip++)->opcode]
+    NEXT();
+#else
+#define CASE(op) case op:
+#define NEXT() break
+    for (;;) {
+        in = ip++;
+        switch (in->opcode) {
+#endif
+
+    CASE(OP_PUSH_INT)     (sp++)->i = in->operand.i; NEXT();
+    CASE(OP_PUSH_FLOAT)   (sp++)->f = in->operand.f; NEXT();
+    CASE(OP_PUSH_STRING)  (sp++)->s = strings[in->operand.i]; NEXT();
+    CASE(OP_LOAD)         *sp++ = slots[in->operand.i]; NEXT();
+    CASE(OP_STORE)        slots[in->operand.i] = *--sp; NEXT();
+    CASE(OP_POP)          sp -= in->operand.i; NEXT();
+
+    CASE(OP_INT_TO_FLOAT)   sp[-1].f = (float)sp[-1].i; NEXT();
+    CASE(OP_INT_TO_FLOAT_2) sp[-2].f = (float)sp[-2].i; NEXT();
+    CASE(OP_FLOAT_TO_INT)   sp[-1].i = (int)sp[-1].f; NEXT();
+
+    CASE(OP_ADD_INT)  sp--; sp[-1].i += sp->i; NEXT();
+    CASE(OP_SUB_INT)  sp--; sp[-1].i -= sp->i; NEXT();
+    CASE(OP_MUL_INT)  sp--; sp[-1].i *= sp->i; NEXT();
+    CASE(OP_DIV_INT)
+        sp--;
+        if (checkError(sp[-1].i, sp->i) == -1) goto division_by_zero;
+        sp[-1].i /= sp->i;
+        NEXT();
+    CASE(OP_ADD_FLOAT)  sp--; sp[-1].f += sp->f; NEXT();
+    CASE(OP_SUB_FLOAT)  sp--; sp[-1].f -= sp->f; NEXT();
+    CASE(OP_MUL_FLOAT)  sp--; sp[-1].f *= sp->f; NEXT();
+    CASE(OP_DIV_FLOAT)
+        sp--;
+        if (sp->f == 0.0) goto division_by_zero;
+        sp[-1].f /= sp->f;
+        NEXT();
+    CASE(OP_NEG_INT)    sp[-1].i = -sp[-1].i; NEXT();
+    CASE(OP_NEG_FLOAT)  sp[-1].f = -sp[-1].f; NEXT();
+
+    CASE(OP_ADD_TO_INT)  slots[in->operand.i].i += (--sp)->i; NEXT();
+    CASE(OP_SUB_TO_INT)  slots[in->operand.i].i -= (--sp)->i; NEXT();
+    CASE(OP_MUL_TO_INT)  slots[in->operand.i].i *= (--sp)->i; NEXT();
+    CASE(OP_DIV_TO_INT)
+        sp--;
+        if (checkError(slots[in->operand.i].i, sp->i) == -1) goto division_by_zero;
+        slots[in->operand.i].i /= sp->i;
+        NEXT();
+    CASE(OP_ADD_TO_FLOAT)  slots[in->operand.i].f += (--sp)->f; NEXT();
+    CASE(OP_SUB_TO_FLOAT)  slots[in->operand.i].f -= (--sp)->f; NEXT();
+    CASE(OP_MUL_TO_FLOAT)  slots[in->operand.i].f *= (--sp)->f; NEXT();
+    CASE(OP_DIV_TO_FLOAT)
+        sp--;
+        if (sp->f == 0.0) goto division_by_zero;
+        slots[in->operand.i].f /= sp->f;
+        NEXT();
+    CASE(OP_INC_INT)    slots[in->operand.i].i++; NEXT();
+    CASE(OP_DEC_INT)    slots[in->operand.i].i--; NEXT();
+    CASE(OP_INC_FLOAT)  slots[in->operand.i].f += 1.0; NEXT();
+    CASE(OP_DEC_FLOAT)  slots[in->operand.i].f -= 1.0; NEXT();
+
+    CASE(OP_PRINT_TEXT)   write_text(strings[in->operand.i], string_lengths[in->operand.i]); NEXT();
+    CASE(OP_PRINT_INT)    write_int(sp[-in->operand.i].i); NEXT();
+    CASE(OP_PRINT_FLOAT)  write_float(sp[-in->operand.i].f); NEXT();
+    CASE(OP_PRINT_STRING) {
+        const char *s = sp[-in->operand.i].s;
+        if (!s) s = "(null)";
+        write_text(s, strlen(s));
+        NEXT();
+    }
+    CASE(OP_PRINT_CHAR)   write_char((char)sp[-in->operand.i].i); NEXT();
+
+    CASE(OP_RAISE)
+        flush_output();
+        fprintf(stderr, "%s\n", strings[in->operand.i]);
+        status = 1;
+        goto done;
+    CASE(OP_HALT)
+        goto done;
+
+#ifndef VM_COMPUTED_GOTO
+        }
+    }
+#endif
+#undef CASE
+#undef NEXT
+
+division_by_zero:
+    flush_output();
+    fprintf(stderr, "LINE %d ERROR: %s\n", program->lines[in - program->code], "Division by zero");
+    status = 1;
+done:
+    flush_output();
+    free(stack);
+    free(slots);
+    return status;
+}
@@ -0,0 +1,95 @@
+#ifndef VM_H
+#define VM_H
+
+#include "types.h"
+
+/*
+ * Bytecode for the ilimbag interpreter. y.y lowers a whole script into a
+ * Program while parsing; run_program then executes it as many times as
+ * needed. Variables are resolved to slot indices and every value's type is
+ * known at compile time, so the VM never looks at names or type tags.
+ */
+
+/* One stack entry or variable slot */
+typedef union {
+    int i;          // int and char (ASCII)
+    float f;
+    const char *s;  // points into Program.strings, never freed by the VM
+} Value;
+
+typedef enum {
+    OP_PUSH_INT,        // push operand.i
+    OP_PUSH_FLOAT,      // push operand.f
+    OP_PUSH_STRING,     // push strings[operand.i]
+    OP_LOAD,            // push slots[operand.i]
+    OP_STORE,           // pop into slots[operand.i]
+    OP_POP,             // drop operand.i values
+
+    OP_INT_TO_FLOAT,    // convert the top value
+    OP_INT_TO_FLOAT_2,  // convert the value under the top
+    OP_FLOAT_TO_INT,    // convert the top value
+
+    OP_ADD_INT, OP_SUB_INT, OP_MUL_INT, OP_DIV_INT,
+    OP_ADD_FLOAT, OP_SUB_FLOAT, OP_MUL_FLOAT, OP_DIV_FLOAT,
+    OP_NEG_INT, OP_NEG_FLOAT,
+
+    /* slots[operand.i] op= pop, for = += -= *= /= on a variable */
+    OP_ADD_TO_INT, OP_SUB_TO_INT, OP_MUL_TO_INT, OP_DIV_TO_INT,
+    OP_ADD_TO_FLOAT, OP_SUB_TO_FLOAT, OP_MUL_TO_FLOAT, OP_DIV_TO_FLOAT,
+    OP_INC_INT, OP_DEC_INT, OP_INC_FLOAT, OP_DEC_FLOAT,
+
+    OP_PRINT_TEXT,      // write strings[operand.i]
+    /* write the value operand.i entries below the stack top */
+    OP_PRINT_INT, OP_PRINT_FLOAT, OP_PRINT_STRING, OP_PRINT_CHAR,
+
+    OP_RAISE,           // report strings[operand.i] and stop with an error
+    OP_HALT
+} Opcode;
+
+#define OP_COUNT (OP_HALT + 1)
+
+typedef struct {
+    Opcode opcode;
+    union {
+        int i;
+        float f;
+    } operand;
+} Instruction;
+
+typedef struct {
+    Instruction *code;
+    int *lines;             // source line of each instruction, for runtime errors
+    int count;
+    int capacity;
+
+    char **strings;         // literals, print text and error messages, interned
+    int *string_lengths;
+    unsigned *string_hashes;
+    int string_count;
+    int string_capacity;
+    int *string_index;      // open addressing over string ids, -1 when empty
+    int string_index_size;
+
+    int slot_count;         // one slot per declared variable
+    int depth;              // stack depth at the end of the code so far
+    int max_depth;
+} Program;
+
+void program_init(Program *program);
+void program_free(Program *program);
+
+void emit(Program *program, Opcode opcode, int operand, int line);
+void emit_float(Program *program, float operand, int line);
+/* Returns the id of the string with these bytes, copying them the first
+   time they are seen. Interned strings never change, so every use of a
+   literal, and every variable assigned it, shares the one copy. */
+int intern_string(Program *program, const char *text, size_t length);
+unsigned hash_bytes(const char *text, size_t length);
+
+/* Executes program once from fresh (zeroed) slots. Print output is
+   buffered and flushed when the buffer fills, when the run ends and before
+   an error goes to stderr. Returns 0, or 1 after a runtime error or
+   OP_RAISE, which have already been reported on stderr. */
+int run_program(const Program *program);
+
+#endif
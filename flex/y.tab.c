@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2012 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.7"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,81 +66,99 @@
 
 
 
-/* Copy the first part of user declarations.  */
-/* Line 371 of yacc.c  */
+/* First part of user prologue.  */
 #line 1 "y.y"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <setjmp.h>
 #include "types.h" 
+#include "vm.h"
 
 extern int yylex();
 extern void yyerror(const char *s);
 extern int yylineno;
 
-/* Declare the function from tools.c */
-extern int checkError(int a, int b);
-
-/* Symbol Table Definition */
+/* Symbol Table Definition. The lexer interns every identifier it sees
+   and hands the parser its index, so grammar actions never compare names.
+   Values live in VM slots; the table only exists while compiling. */
 typedef struct {
-    char name[50];
-    union {
-        int int_val;
-        float float_val;
-        char char_val;
-        char *str_val;
-    } value;
-    char type[10];  // "int", "float", "char", "string"
+    char *name;
+    unsigned hash;
+    ValueType type;
+    int declared;
+    int slot;
     int is_initialized;
     int is_used;
 } symbol;
 
-symbol table[100];
+symbol *table = NULL;           /* indexed by symbol id */
 int symCount = 0;
+static int symCapacity = 0;
+static int *symbolIndex = NULL; /* open addressing over ids, -1 when empty */
+static int symbolIndexSize = 0;
+
+static const char *type_names[] = { "int", "float", "string", "char" };
+
+/* The script being compiled. Grammar actions append to it as they reduce. */
+Program program;
+#define EMIT(opcode, operand) emit(&program, (opcode), (operand), yylineno)
+
+/* yyerror and lexer_error jump back to main, which runs what was compiled
+   up to the error so output stays in the same order as the error */
+static jmp_buf compile_abort;
 
 /* Function Prototypes */
-symbol* getSymbol(const char *name);
-int varExists(const char *name);
-void declareVar(const char *name, const char *type);
-char* processString(const char *raw_str); /* UPDATED NAME */
-ExprVal do_math(ExprVal v1, ExprVal v2, char op);
-void update_variable(char *name, ExprVal val, char op);
+int intern_symbol(const char *name);
+symbol* getSymbol(int id);
+void declareVar(int id, ValueType type);
+size_t processString(const char *raw_str, char *processed);
+int intern_literal(const char *raw_str);
+ValueType do_math(ValueType v1, ValueType v2, char op);
+void update_variable(int id, ValueType val, char op);
+void step_variable(int id, int delta);
+void lexer_error(char c);
 
 /* Print list functions */
 print_item* create_print_item();
+print_item* reverse_print_list(print_item *list);
 void free_print_list(print_item *list);
-void execute_print(print_item *list);
+void compile_print(print_item *list);
 
 int yyparse(void);
 void check_unused_variables();
 
 
-/* Line 371 of yacc.c  */
-#line 117 "y.tab.c"
+#line 135 "y.tab.c"
 
-# ifndef YY_NULL
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULL nullptr
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
 #  else
-#   define YY_NULL 0
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "y.tab.h".  */
+/* Use api.header.include to #include this header
+   instead of duplicating it here.  */
 #ifndef YY_YY_Y_TAB_H_INCLUDED
 # define YY_YY_Y_TAB_H_INCLUDED
-/* Enabling traces.  */
+/* Debug traces.  */
 #ifndef YYDEBUG
 # define YYDEBUG 0
 #endif
@@ -143,118 +166,253 @@ void check_unused_variables();
 extern int yydebug;
 #endif
 
-/* Tokens.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     NEWLINE = 258,
-     ilimbag = 259,
-     numero = 260,
-     sulat = 261,
-     letra = 262,
-     desimal = 263,
-     ASSIGN = 264,
-     COMMA = 265,
-     SEMICOLON = 266,
-     LPAREN = 267,
-     RPAREN = 268,
-     PLUS = 269,
-     MINUS = 270,
-     MULTIPLY = 271,
-     DIVIDE = 272,
-     INCREMENT = 273,
-     DECREMENT = 274,
-     PLUS_ASSIGN = 275,
-     MINUS_ASSIGN = 276,
-     MULTIPLY_ASSIGN = 277,
-     DIVIDE_ASSIGN = 278,
-     STRING_LITERAL = 279,
-     INTEGER = 280,
-     FLOAT = 281,
-     CHARACTER = 282,
-     IDENTIFIER = 283,
-     ERROR_CHAR = 284,
-     UPLUS = 285,
-     UMINUS = 286
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    NEWLINE = 258,                 /* NEWLINE  */
+    ilimbag = 259,                 /* ilimbag  */
+    numero = 260,                  /* numero  */
+    sulat = 261,                   /* sulat  */
+    letra = 262,                   /* letra  */
+    desimal = 263,                 /* desimal  */
+    ASSIGN = 264,                  /* ASSIGN  */
+    COMMA = 265,                   /* COMMA  */
+    SEMICOLON = 266,               /* SEMICOLON  */
+    LPAREN = 267,                  /* LPAREN  */
+    RPAREN = 268,                  /* RPAREN  */
+    PLUS = 269,                    /* PLUS  */
+    MINUS = 270,                   /* MINUS  */
+    MULTIPLY = 271,                /* MULTIPLY  */
+    DIVIDE = 272,                  /* DIVIDE  */
+    INCREMENT = 273,               /* INCREMENT  */
+    DECREMENT = 274,               /* DECREMENT  */
+    PLUS_ASSIGN = 275,             /* PLUS_ASSIGN  */
+    MINUS_ASSIGN = 276,            /* MINUS_ASSIGN  */
+    MULTIPLY_ASSIGN = 277,         /* MULTIPLY_ASSIGN  */
+    DIVIDE_ASSIGN = 278,           /* DIVIDE_ASSIGN  */
+    STRING_LITERAL = 279,          /* STRING_LITERAL  */
+    INTEGER = 280,                 /* INTEGER  */
+    FLOAT = 281,                   /* FLOAT  */
+    CHARACTER = 282,               /* CHARACTER  */
+    IDENTIFIER = 283,              /* IDENTIFIER  */
+    ERROR_CHAR = 284,              /* ERROR_CHAR  */
+    UMINUS = 285,                  /* UMINUS  */
+    UPLUS = 286                    /* UPLUS  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-
-
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define NEWLINE 258
+#define ilimbag 259
+#define numero 260
+#define sulat 261
+#define letra 262
+#define desimal 263
+#define ASSIGN 264
+#define COMMA 265
+#define SEMICOLON 266
+#define LPAREN 267
+#define RPAREN 268
+#define PLUS 269
+#define MINUS 270
+#define MULTIPLY 271
+#define DIVIDE 272
+#define INCREMENT 273
+#define DECREMENT 274
+#define PLUS_ASSIGN 275
+#define MINUS_ASSIGN 276
+#define MULTIPLY_ASSIGN 277
+#define DIVIDE_ASSIGN 278
+#define STRING_LITERAL 279
+#define INTEGER 280
+#define FLOAT 281
+#define CHARACTER 282
+#define IDENTIFIER 283
+#define ERROR_CHAR 284
+#define UMINUS 285
+#define UPLUS 286
+
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+union YYSTYPE
 {
-/* Line 387 of yacc.c  */
-#line 50 "y.y"
+#line 65 "y.y"
 
     int num;
     float float_num;
     char *str;
-    ExprVal val;
+    int sym;         /* symbol id from intern_symbol */
+    int lit;         /* string id from intern_literal */
+    ValueType val;   /* static type; the value itself is on the VM stack */
     print_item *print_list;
 
+#line 260 "y.tab.c"
 
-/* Line 387 of yacc.c  */
-#line 200 "y.tab.c"
-} YYSTYPE;
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
 
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
+
 int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
+
 
 #endif /* !YY_YY_Y_TAB_H_INCLUDED  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_NEWLINE = 3,                    /* NEWLINE  */
+  YYSYMBOL_ilimbag = 4,                    /* ilimbag  */
+  YYSYMBOL_numero = 5,                     /* numero  */
+  YYSYMBOL_sulat = 6,                      /* sulat  */
+  YYSYMBOL_letra = 7,                      /* letra  */
+  YYSYMBOL_desimal = 8,                    /* desimal  */
+  YYSYMBOL_ASSIGN = 9,                     /* ASSIGN  */
+  YYSYMBOL_COMMA = 10,                     /* COMMA  */
+  YYSYMBOL_SEMICOLON = 11,                 /* SEMICOLON  */
+  YYSYMBOL_LPAREN = 12,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 13,                    /* RPAREN  */
+  YYSYMBOL_PLUS = 14,                      /* PLUS  */
+  YYSYMBOL_MINUS = 15,                     /* MINUS  */
+  YYSYMBOL_MULTIPLY = 16,                  /* MULTIPLY  */
+  YYSYMBOL_DIVIDE = 17,                    /* DIVIDE  */
+  YYSYMBOL_INCREMENT = 18,                 /* INCREMENT  */
+  YYSYMBOL_DECREMENT = 19,                 /* DECREMENT  */
+  YYSYMBOL_PLUS_ASSIGN = 20,               /* PLUS_ASSIGN  */
+  YYSYMBOL_MINUS_ASSIGN = 21,              /* MINUS_ASSIGN  */
+  YYSYMBOL_MULTIPLY_ASSIGN = 22,           /* MULTIPLY_ASSIGN  */
+  YYSYMBOL_DIVIDE_ASSIGN = 23,             /* DIVIDE_ASSIGN  */
+  YYSYMBOL_STRING_LITERAL = 24,            /* STRING_LITERAL  */
+  YYSYMBOL_INTEGER = 25,                   /* INTEGER  */
+  YYSYMBOL_FLOAT = 26,                     /* FLOAT  */
+  YYSYMBOL_CHARACTER = 27,                 /* CHARACTER  */
+  YYSYMBOL_IDENTIFIER = 28,                /* IDENTIFIER  */
+  YYSYMBOL_ERROR_CHAR = 29,                /* ERROR_CHAR  */
+  YYSYMBOL_UMINUS = 30,                    /* UMINUS  */
+  YYSYMBOL_UPLUS = 31,                     /* UPLUS  */
+  YYSYMBOL_YYACCEPT = 32,                  /* $accept  */
+  YYSYMBOL_program = 33,                   /* program  */
+  YYSYMBOL_line = 34,                      /* line  */
+  YYSYMBOL_statement = 35,                 /* statement  */
+  YYSYMBOL_declaration = 36,               /* declaration  */
+  YYSYMBOL_assignment = 37,                /* assignment  */
+  YYSYMBOL_print_stmt = 38,                /* print_stmt  */
+  YYSYMBOL_print_items = 39,               /* print_items  */
+  YYSYMBOL_print_item = 40,                /* print_item  */
+  YYSYMBOL_expr = 41,                      /* expr  */
+  YYSYMBOL_term = 42,                      /* term  */
+  YYSYMBOL_factor = 43,                    /* factor  */
+  YYSYMBOL_string_val = 44,                /* string_val  */
+  YYSYMBOL_char_val = 45                   /* char_val  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
 
-/* Copy the second part of user declarations.  */
 
-/* Line 390 of yacc.c  */
-#line 228 "y.tab.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
 typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef short int yytype_int8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -262,16 +420,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -285,32 +455,71 @@ typedef short int yytype_int16;
 # endif
 #endif
 
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(N) (N)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int yyi)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (yyi)
-    int yyi;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return yyi;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -327,8 +536,7 @@ YYID (yyi)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
       /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
 #     ifndef EXIT_SUCCESS
@@ -340,8 +548,8 @@ YYID (yyi)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -357,7 +565,7 @@ YYID (yyi)
 #  endif
 #  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
 #   ifndef EXIT_SUCCESS
 #    define EXIT_SUCCESS 0
@@ -365,40 +573,37 @@ YYID (yyi)
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -408,16 +613,16 @@ union yyalloc
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack_alloc, Stack)				\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack_alloc, Stack, yysize);			\
-	Stack = &yyptr->Stack_alloc;					\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
@@ -427,16 +632,16 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
-      while (YYID (0))
+      while (0)
 #  endif
 # endif
 #endif /* !YYCOPY_NEEDED */
@@ -452,18 +657,23 @@ union yyalloc
 #define YYNNTS  14
 /* YYNRULES -- Number of rules.  */
 #define YYNRULES  50
-/* YYNRULES -- Number of states.  */
+/* YYNSTATES -- Number of states.  */
 #define YYNSTATES  76
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   286
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -497,126 +707,60 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     4,     7,    10,    12,    14,    16,    18,
-      20,    22,    25,    30,    33,    38,    41,    46,    49,    54,
-      58,    62,    66,    70,    74,    78,    82,    85,    88,    91,
-      94,    97,    99,   101,   105,   107,   109,   111,   113,   117,
-     121,   123,   127,   131,   133,   135,   137,   140,   143,   147,
-     149
+       0,   101,   101,   102,   105,   106,   107,   110,   111,   112,
+     113,   116,   119,   127,   130,   138,   141,   151,   154,   163,
+     166,   169,   172,   175,   178,   193,   200,   203,   206,   209,
+     214,   219,   225,   226,   232,   237,   242,   249,   250,   251,
+     254,   255,   256,   259,   263,   267,   273,   279,   283,   286,
+     289
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      33,     0,    -1,    -1,    33,    34,    -1,    35,     3,    -1,
-      35,    -1,     3,    -1,    36,    -1,    37,    -1,    38,    -1,
-      41,    -1,     5,    28,    -1,     5,    28,     9,    41,    -1,
-       8,    28,    -1,     8,    28,     9,    41,    -1,     7,    28,
-      -1,     7,    28,     9,    45,    -1,     6,    28,    -1,     6,
-      28,     9,    44,    -1,    28,     9,    41,    -1,    28,    20,
-      41,    -1,    28,    21,    41,    -1,    28,    22,    41,    -1,
-      28,    23,    41,    -1,    28,     9,    45,    -1,    28,     9,
-      44,    -1,    28,    18,    -1,    28,    19,    -1,    18,    28,
-      -1,    19,    28,    -1,     4,    39,    -1,     4,    -1,    40,
-      -1,    39,    10,    40,    -1,    24,    -1,    27,    -1,    41,
-      -1,    42,    -1,    41,    14,    42,    -1,    41,    15,    42,
-      -1,    43,    -1,    42,    16,    43,    -1,    42,    17,    43,
-      -1,    25,    -1,    26,    -1,    28,    -1,    15,    43,    -1,
-      14,    43,    -1,    12,    41,    13,    -1,    24,    -1,    27,
-      -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
-{
-       0,    84,    84,    85,    88,    89,    90,    93,    94,    95,
-      96,    99,   103,   112,   116,   125,   129,   137,   141,   150,
-     154,   158,   162,   166,   170,   186,   195,   203,   211,   219,
-     229,   233,   238,   239,   247,   253,   261,   279,   280,   281,
-     284,   285,   286,   289,   294,   299,   317,   323,   327,   330,
-     336
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "NEWLINE", "ilimbag", "numero", "sulat",
-  "letra", "desimal", "ASSIGN", "COMMA", "SEMICOLON", "LPAREN", "RPAREN",
-  "PLUS", "MINUS", "MULTIPLY", "DIVIDE", "INCREMENT", "DECREMENT",
-  "PLUS_ASSIGN", "MINUS_ASSIGN", "MULTIPLY_ASSIGN", "DIVIDE_ASSIGN",
-  "STRING_LITERAL", "INTEGER", "FLOAT", "CHARACTER", "IDENTIFIER",
-  "ERROR_CHAR", "UPLUS", "UMINUS", "$accept", "program", "line",
-  "statement", "declaration", "assignment", "print_stmt", "print_items",
-  "print_item", "expr", "term", "factor", "string_val", "char_val", YY_NULL
+  "\"end of file\"", "error", "\"invalid token\"", "NEWLINE", "ilimbag",
+  "numero", "sulat", "letra", "desimal", "ASSIGN", "COMMA", "SEMICOLON",
+  "LPAREN", "RPAREN", "PLUS", "MINUS", "MULTIPLY", "DIVIDE", "INCREMENT",
+  "DECREMENT", "PLUS_ASSIGN", "MINUS_ASSIGN", "MULTIPLY_ASSIGN",
+  "DIVIDE_ASSIGN", "STRING_LITERAL", "INTEGER", "FLOAT", "CHARACTER",
+  "IDENTIFIER", "ERROR_CHAR", "UMINUS", "UPLUS", "$accept", "program",
+  "line", "statement", "declaration", "assignment", "print_stmt",
+  "print_items", "print_item", "expr", "term", "factor", "string_val",
+  "char_val", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
-{
-       0,    32,    33,    33,    34,    34,    34,    35,    35,    35,
-      35,    36,    36,    36,    36,    36,    36,    36,    36,    37,
-      37,    37,    37,    37,    37,    37,    37,    37,    37,    37,
-      38,    38,    39,    39,    40,    40,    40,    41,    41,    41,
-      42,    42,    42,    43,    43,    43,    43,    43,    43,    44,
-      45
-};
+#define YYPACT_NINF (-31)
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
-{
-       0,     2,     0,     2,     2,     1,     1,     1,     1,     1,
-       1,     2,     4,     2,     4,     2,     4,     2,     4,     3,
-       3,     3,     3,     3,     3,     3,     2,     2,     2,     2,
-       2,     1,     1,     3,     1,     1,     1,     1,     3,     3,
-       1,     3,     3,     1,     1,     1,     2,     2,     3,     1,
-       1
-};
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-/* YYDEFACT[STATE-NAME] -- Default reduction number in state STATE-NUM.
-   Performed when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
-{
-       2,     0,     1,     6,    31,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,    43,    44,    45,     3,     5,     7,
-       8,     9,    10,    37,    40,    34,    35,    45,    30,    32,
-      36,    11,    17,    15,    13,     0,    47,    46,    28,    29,
-       0,    26,    27,     0,     0,     0,     0,     4,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,    48,    49,    50,
-      19,    25,    24,    20,    21,    22,    23,    38,    39,    41,
-      42,    33,    12,    18,    16,    14
-};
+#define YYTABLE_NINF (-1)
 
-/* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] =
-{
-      -1,     1,    17,    18,    19,    20,    21,    28,    29,    30,
-      23,    24,    61,    62
-};
+#define yytable_value_is_error(Yyn) \
+  0
 
 /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
    STATE-NUM.  */
-#define YYPACT_NINF -31
 static const yytype_int8 yypact[] =
 {
      -31,     9,   -31,   -31,    36,    -8,    -3,    -2,     1,    59,
@@ -629,6 +773,21 @@ static const yytype_int8 yypact[] =
      -31,   -31,   -10,   -31,   -31,   -10
 };
 
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       2,     0,     1,     6,    31,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    43,    44,    45,     3,     5,     7,
+       8,     9,    10,    37,    40,    34,    35,    45,    30,    32,
+      36,    11,    17,    15,    13,     0,    47,    46,    28,    29,
+       0,    26,    27,     0,     0,     0,     0,     4,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    48,    49,    50,
+      19,    25,    24,    20,    21,    22,    23,    38,    39,    41,
+      42,    33,    12,    18,    16,    14
+};
+
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
@@ -636,11 +795,17 @@ static const yytype_int8 yypgoto[] =
      -30,    -4,    -5,     4
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     1,    17,    18,    19,    20,    21,    28,    29,    30,
+      23,    24,    61,    62
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
-static const yytype_uint8 yytable[] =
+static const yytype_int8 yytable[] =
 {
       22,    57,    48,    49,    48,    49,    36,    37,    35,     2,
       50,    51,     3,     4,     5,     6,     7,     8,    67,    68,
@@ -654,12 +819,6 @@ static const yytype_uint8 yytable[] =
       43,    44,    45,    46
 };
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-31)))
-
-#define yytable_value_is_error(Yytable_value) \
-  YYID (0)
-
 static const yytype_int8 yycheck[] =
 {
        1,    13,    14,    15,    14,    15,    10,    11,     9,     0,
@@ -674,9 +833,9 @@ static const yytype_int8 yycheck[] =
       20,    21,    22,    23
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,    33,     0,     3,     4,     5,     6,     7,     8,    12,
       14,    15,    18,    19,    25,    26,    28,    34,    35,    36,
@@ -688,67 +847,63 @@ static const yytype_uint8 yystos[] =
       43,    40,    41,    44,    45,    41
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
-
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
-
-
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  However,
-   YYFAIL appears to be in use.  Nevertheless, it is formally deprecated
-   in Bison 2.4.2's NEWS entry, where a plan to phase it out is
-   discussed.  */
-
-#define YYFAIL		goto yyerrlab
-#if defined YYFAIL
-  /* This is here to suppress warnings from the GCC cpp's
-     -Wunused-macros.  Normally we don't worry about that warning, but
-     some users do, and we want to make it easy for users to remove
-     YYFAIL uses, which will produce warnings from Bison 2.5.  */
-#endif
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    32,    33,    33,    34,    34,    34,    35,    35,    35,
+      35,    36,    36,    36,    36,    36,    36,    36,    36,    37,
+      37,    37,    37,    37,    37,    37,    37,    37,    37,    37,
+      38,    38,    39,    39,    40,    40,    40,    41,    41,    41,
+      42,    42,    42,    43,    43,    43,    43,    43,    43,    44,
+      45
+};
 
-#define YYRECOVERING()  (!!yyerrstatus)
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     0,     2,     2,     1,     1,     1,     1,     1,
+       1,     2,     4,     2,     4,     2,     4,     2,     4,     3,
+       3,     3,     3,     3,     3,     3,     2,     2,     2,     2,
+       2,     1,     1,     3,     1,     1,     1,     1,     3,     3,
+       1,     3,     3,     1,     1,     1,     2,     2,     3,     1,
+       1
+};
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-/* Error token number */
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -758,82 +913,58 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-        break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
 static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -841,16 +972,8 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
-#else
 static void
-yy_stack_print (yybottom, yytop)
-    yytype_int16 *yybottom;
-    yytype_int16 *yytop;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -861,63 +984,56 @@ yy_stack_print (yybottom, yytop)
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
       YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -933,363 +1049,77 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULL, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULL;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - Assume YYFAIL is not used.  It's too flawed to consider.  See
-       <http://lists.gnu.org/archive/html/bison-patches/2009-12/msg00024.html>
-       for details.  YYERROR is fine as it does not invoke this
-       function.
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULL, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
 
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
-  }
 
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
 
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
 static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
 {
-  YYUSE (yyvaluep);
-
+  YY_USE (yyvaluep);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
-
-  switch (yytype)
-    {
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-      default:
-        break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
-
-#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END
-#endif
-#ifndef YY_INITIAL_VALUE
-# define YY_INITIAL_VALUE(Value) /* Nothing. */
-#endif
-
 /* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval YY_INITIAL_VALUE(yyval_default);
-
+YYSTYPE yylval;
 /* Number of syntax errors so far.  */
 int yynerrs;
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 int
 yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       `yyss': related to states.
-       `yyvs': related to semantic values.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1297,102 +1127,107 @@ yyparse ()
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss_alloc, yyss);
-	YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1403,18 +1238,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1442,15 +1288,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1465,14 +1309,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1485,439 +1329,370 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 10:
-/* Line 1792 of yacc.c  */
-#line 96 "y.y"
-    { /* Silent execution */ }
+  case 10: /* statement: expr  */
+#line 113 "y.y"
+           { EMIT(OP_POP, 1); /* Silent execution */ }
+#line 1336 "y.tab.c"
     break;
 
-  case 11:
-/* Line 1792 of yacc.c  */
-#line 99 "y.y"
-    {
-        declareVar((yyvsp[(2) - (2)].str), "int");
-        free((yyvsp[(2) - (2)].str));
+  case 11: /* declaration: numero IDENTIFIER  */
+#line 116 "y.y"
+                               {
+        declareVar((yyvsp[0].sym), TYPE_INT);
     }
+#line 1344 "y.tab.c"
     break;
 
-  case 12:
-/* Line 1792 of yacc.c  */
-#line 103 "y.y"
-    {
-        declareVar((yyvsp[(2) - (4)].str), "int");
-        symbol *var = getSymbol((yyvsp[(2) - (4)].str));
-        if ((yyvsp[(4) - (4)].val).type == 0 || (yyvsp[(4) - (4)].val).type == 3) var->value.int_val = (yyvsp[(4) - (4)].val).i_val;
-        else if ((yyvsp[(4) - (4)].val).type == 1) var->value.int_val = (int)(yyvsp[(4) - (4)].val).f_val;
-        else yyerror("Cannot assign string to int");
+  case 12: /* declaration: numero IDENTIFIER ASSIGN expr  */
+#line 119 "y.y"
+                                    {
+        declareVar((yyvsp[-2].sym), TYPE_INT);
+        symbol *var = &table[(yyvsp[-2].sym)];
+        if ((yyvsp[0].val) == TYPE_FLOAT) EMIT(OP_FLOAT_TO_INT, 0);
+        else if ((yyvsp[0].val) == TYPE_STRING) yyerror("Cannot assign string to int");
+        EMIT(OP_STORE, var->slot);
         var->is_initialized = 1;
-        free((yyvsp[(2) - (4)].str));
     }
+#line 1357 "y.tab.c"
     break;
 
-  case 13:
-/* Line 1792 of yacc.c  */
-#line 112 "y.y"
-    {
-        declareVar((yyvsp[(2) - (2)].str), "float");
-        free((yyvsp[(2) - (2)].str));
+  case 13: /* declaration: desimal IDENTIFIER  */
+#line 127 "y.y"
+                         {
+        declareVar((yyvsp[0].sym), TYPE_FLOAT);
     }
+#line 1365 "y.tab.c"
     break;
 
-  case 14:
-/* Line 1792 of yacc.c  */
-#line 116 "y.y"
-    {
-        declareVar((yyvsp[(2) - (4)].str), "float");
-        symbol *var = getSymbol((yyvsp[(2) - (4)].str));
-        if ((yyvsp[(4) - (4)].val).type == 1) var->value.float_val = (yyvsp[(4) - (4)].val).f_val;
-        else if ((yyvsp[(4) - (4)].val).type == 0 || (yyvsp[(4) - (4)].val).type == 3) var->value.float_val = (float)(yyvsp[(4) - (4)].val).i_val;
-        else yyerror("Cannot assign string to float");
+  case 14: /* declaration: desimal IDENTIFIER ASSIGN expr  */
+#line 130 "y.y"
+                                     {
+        declareVar((yyvsp[-2].sym), TYPE_FLOAT);
+        symbol *var = &table[(yyvsp[-2].sym)];
+        if ((yyvsp[0].val) == TYPE_INT || (yyvsp[0].val) == TYPE_CHAR) EMIT(OP_INT_TO_FLOAT, 0);
+        else if ((yyvsp[0].val) == TYPE_STRING) yyerror("Cannot assign string to float");
+        EMIT(OP_STORE, var->slot);
         var->is_initialized = 1;
-        free((yyvsp[(2) - (4)].str));
     }
+#line 1378 "y.tab.c"
     break;
 
-  case 15:
-/* Line 1792 of yacc.c  */
-#line 125 "y.y"
-    {
-        declareVar((yyvsp[(2) - (2)].str), "char");
-        free((yyvsp[(2) - (2)].str));
+  case 15: /* declaration: letra IDENTIFIER  */
+#line 138 "y.y"
+                       {
+        declareVar((yyvsp[0].sym), TYPE_CHAR);
     }
+#line 1386 "y.tab.c"
     break;
 
-  case 16:
-/* Line 1792 of yacc.c  */
-#line 129 "y.y"
-    {
-        declareVar((yyvsp[(2) - (4)].str), "char");
-        symbol *var = getSymbol((yyvsp[(2) - (4)].str));
-        if ((yyvsp[(4) - (4)].str) && (yyvsp[(4) - (4)].str)[0]) var->value.char_val = (yyvsp[(4) - (4)].str)[0];
+  case 16: /* declaration: letra IDENTIFIER ASSIGN char_val  */
+#line 141 "y.y"
+                                       {
+        declareVar((yyvsp[-2].sym), TYPE_CHAR);
+        symbol *var = &table[(yyvsp[-2].sym)];
+        char c = program.strings[(yyvsp[0].lit)][0];
+        if (c) {
+            EMIT(OP_PUSH_INT, c);
+            EMIT(OP_STORE, var->slot);
+        }
         var->is_initialized = 1;
-        free((yyvsp[(2) - (4)].str));
-        free((yyvsp[(4) - (4)].str));
     }
+#line 1401 "y.tab.c"
     break;
 
-  case 17:
-/* Line 1792 of yacc.c  */
-#line 137 "y.y"
-    {
-        declareVar((yyvsp[(2) - (2)].str), "string");
-        free((yyvsp[(2) - (2)].str));
+  case 17: /* declaration: sulat IDENTIFIER  */
+#line 151 "y.y"
+                       {
+        declareVar((yyvsp[0].sym), TYPE_STRING);
     }
+#line 1409 "y.tab.c"
     break;
 
-  case 18:
-/* Line 1792 of yacc.c  */
-#line 141 "y.y"
-    {
-        declareVar((yyvsp[(2) - (4)].str), "string");
-        symbol *var = getSymbol((yyvsp[(2) - (4)].str));
-        var->value.str_val = (yyvsp[(4) - (4)].str); 
+  case 18: /* declaration: sulat IDENTIFIER ASSIGN string_val  */
+#line 154 "y.y"
+                                         {
+        declareVar((yyvsp[-2].sym), TYPE_STRING);
+        symbol *var = &table[(yyvsp[-2].sym)];
+        EMIT(OP_PUSH_STRING, (yyvsp[0].lit));
+        EMIT(OP_STORE, var->slot);
         var->is_initialized = 1;
-        free((yyvsp[(2) - (4)].str));
     }
+#line 1421 "y.tab.c"
     break;
 
-  case 19:
-/* Line 1792 of yacc.c  */
-#line 150 "y.y"
-    {
-        update_variable((yyvsp[(1) - (3)].str), (yyvsp[(3) - (3)].val), '=');
-        free((yyvsp[(1) - (3)].str));
+  case 19: /* assignment: IDENTIFIER ASSIGN expr  */
+#line 163 "y.y"
+                                   {
+        update_variable((yyvsp[-2].sym), (yyvsp[0].val), '=');
     }
+#line 1429 "y.tab.c"
     break;
 
-  case 20:
-/* Line 1792 of yacc.c  */
-#line 154 "y.y"
-    {
-        update_variable((yyvsp[(1) - (3)].str), (yyvsp[(3) - (3)].val), '+');
-        free((yyvsp[(1) - (3)].str));
+  case 20: /* assignment: IDENTIFIER PLUS_ASSIGN expr  */
+#line 166 "y.y"
+                                  {
+        update_variable((yyvsp[-2].sym), (yyvsp[0].val), '+');
     }
+#line 1437 "y.tab.c"
     break;
 
-  case 21:
-/* Line 1792 of yacc.c  */
-#line 158 "y.y"
-    {
-        update_variable((yyvsp[(1) - (3)].str), (yyvsp[(3) - (3)].val), '-');
-        free((yyvsp[(1) - (3)].str));
+  case 21: /* assignment: IDENTIFIER MINUS_ASSIGN expr  */
+#line 169 "y.y"
+                                   {
+        update_variable((yyvsp[-2].sym), (yyvsp[0].val), '-');
     }
+#line 1445 "y.tab.c"
     break;
 
-  case 22:
-/* Line 1792 of yacc.c  */
-#line 162 "y.y"
-    {
-        update_variable((yyvsp[(1) - (3)].str), (yyvsp[(3) - (3)].val), '*');
-        free((yyvsp[(1) - (3)].str));
+  case 22: /* assignment: IDENTIFIER MULTIPLY_ASSIGN expr  */
+#line 172 "y.y"
+                                      {
+        update_variable((yyvsp[-2].sym), (yyvsp[0].val), '*');
     }
+#line 1453 "y.tab.c"
     break;
 
-  case 23:
-/* Line 1792 of yacc.c  */
-#line 166 "y.y"
-    {
-        update_variable((yyvsp[(1) - (3)].str), (yyvsp[(3) - (3)].val), '/');
-        free((yyvsp[(1) - (3)].str));
+  case 23: /* assignment: IDENTIFIER DIVIDE_ASSIGN expr  */
+#line 175 "y.y"
+                                    {
+        update_variable((yyvsp[-2].sym), (yyvsp[0].val), '/');
     }
+#line 1461 "y.tab.c"
     break;
 
-  case 24:
-/* Line 1792 of yacc.c  */
-#line 170 "y.y"
-    {
-        if (!varExists((yyvsp[(1) - (3)].str))) yyerror("Undeclared variable");
-        symbol *var = getSymbol((yyvsp[(1) - (3)].str));
-        if (strcmp(var->type, "char") == 0) {
-            var->value.char_val = (yyvsp[(3) - (3)].str)[0];
+  case 24: /* assignment: IDENTIFIER ASSIGN char_val  */
+#line 178 "y.y"
+                                 {
+        symbol *var = getSymbol((yyvsp[-2].sym));
+        char c = program.strings[(yyvsp[0].lit)][0];
+        if (var->type == TYPE_CHAR) {
+            EMIT(OP_PUSH_INT, c);
+            EMIT(OP_STORE, var->slot);
             var->is_initialized = 1;
-        } else if (strcmp(var->type, "string") == 0) {
-             if (var->value.str_val) free(var->value.str_val);
-             char *s = malloc(2); s[0]=(yyvsp[(3) - (3)].str)[0]; s[1]='\0';
-             var->value.str_val = s;
+        } else if (var->type == TYPE_STRING) {
+             EMIT(OP_PUSH_STRING, intern_string(&program, &c, c ? 1 : 0));
+             EMIT(OP_STORE, var->slot);
              var->is_initialized = 1;
         } else {
              yyerror("Type mismatch in assignment");
         }
-        free((yyvsp[(1) - (3)].str)); free((yyvsp[(3) - (3)].str));
     }
+#line 1481 "y.tab.c"
     break;
 
-  case 25:
-/* Line 1792 of yacc.c  */
-#line 186 "y.y"
-    {
-        if (!varExists((yyvsp[(1) - (3)].str))) yyerror("Undeclared variable");
-        symbol *var = getSymbol((yyvsp[(1) - (3)].str));
-        if (strcmp(var->type, "string") != 0) yyerror("Cannot assign string to non-string variable");
-        if (var->value.str_val) free(var->value.str_val);
-        var->value.str_val = (yyvsp[(3) - (3)].str);
+  case 25: /* assignment: IDENTIFIER ASSIGN string_val  */
+#line 193 "y.y"
+                                   {
+        symbol *var = getSymbol((yyvsp[-2].sym));
+        if (var->type != TYPE_STRING) yyerror("Cannot assign string to non-string variable");
+        EMIT(OP_PUSH_STRING, (yyvsp[0].lit));
+        EMIT(OP_STORE, var->slot);
         var->is_initialized = 1;
-        free((yyvsp[(1) - (3)].str));
     }
+#line 1493 "y.tab.c"
     break;
 
-  case 26:
-/* Line 1792 of yacc.c  */
-#line 195 "y.y"
-    {
-        if (!varExists((yyvsp[(1) - (2)].str))) yyerror("Undeclared variable");
-        symbol *var = getSymbol((yyvsp[(1) - (2)].str));
-        if (strcmp(var->type, "int") == 0) var->value.int_val++;
-        else if (strcmp(var->type, "float") == 0) var->value.float_val += 1.0;
-        else yyerror("++ only for numeric types");
-        free((yyvsp[(1) - (2)].str));
+  case 26: /* assignment: IDENTIFIER INCREMENT  */
+#line 200 "y.y"
+                           {
+        step_variable((yyvsp[-1].sym), 1);
     }
+#line 1501 "y.tab.c"
     break;
 
-  case 27:
-/* Line 1792 of yacc.c  */
+  case 27: /* assignment: IDENTIFIER DECREMENT  */
 #line 203 "y.y"
-    {
-        if (!varExists((yyvsp[(1) - (2)].str))) yyerror("Undeclared variable");
-        symbol *var = getSymbol((yyvsp[(1) - (2)].str));
-        if (strcmp(var->type, "int") == 0) var->value.int_val--;
-        else if (strcmp(var->type, "float") == 0) var->value.float_val -= 1.0;
-        else yyerror("-- only for numeric types");
-        free((yyvsp[(1) - (2)].str));
+                           {
+        step_variable((yyvsp[-1].sym), -1);
     }
+#line 1509 "y.tab.c"
     break;
 
-  case 28:
-/* Line 1792 of yacc.c  */
-#line 211 "y.y"
-    {
-        if (!varExists((yyvsp[(2) - (2)].str))) yyerror("Undeclared variable");
-        symbol *var = getSymbol((yyvsp[(2) - (2)].str));
-        if (strcmp(var->type, "int") == 0) var->value.int_val++;
-        else if (strcmp(var->type, "float") == 0) var->value.float_val += 1.0;
-        else yyerror("++ only for numeric types");
-        free((yyvsp[(2) - (2)].str));
+  case 28: /* assignment: INCREMENT IDENTIFIER  */
+#line 206 "y.y"
+                           {
+        step_variable((yyvsp[0].sym), 1);
     }
+#line 1517 "y.tab.c"
     break;
 
-  case 29:
-/* Line 1792 of yacc.c  */
-#line 219 "y.y"
-    {
-        if (!varExists((yyvsp[(2) - (2)].str))) yyerror("Undeclared variable");
-        symbol *var = getSymbol((yyvsp[(2) - (2)].str));
-        if (strcmp(var->type, "int") == 0) var->value.int_val--;
-        else if (strcmp(var->type, "float") == 0) var->value.float_val -= 1.0;
-        else yyerror("-- only for numeric types");
-        free((yyvsp[(2) - (2)].str));
+  case 29: /* assignment: DECREMENT IDENTIFIER  */
+#line 209 "y.y"
+                           {
+        step_variable((yyvsp[0].sym), -1);
     }
+#line 1525 "y.tab.c"
     break;
 
-  case 30:
-/* Line 1792 of yacc.c  */
-#line 229 "y.y"
-    {
-        execute_print((yyvsp[(2) - (2)].print_list));
-        free_print_list((yyvsp[(2) - (2)].print_list));
+  case 30: /* print_stmt: ilimbag print_items  */
+#line 214 "y.y"
+                                {
+        print_item *list = reverse_print_list((yyvsp[0].print_list));
+        compile_print(list);
+        free_print_list(list);
     }
+#line 1535 "y.tab.c"
     break;
 
-  case 31:
-/* Line 1792 of yacc.c  */
-#line 233 "y.y"
-    {
-        printf("\n");
+  case 31: /* print_stmt: ilimbag  */
+#line 219 "y.y"
+              {
+        compile_print(NULL);
     }
+#line 1543 "y.tab.c"
     break;
 
-  case 32:
-/* Line 1792 of yacc.c  */
-#line 238 "y.y"
-    { (yyval.print_list) = (yyvsp[(1) - (1)].print_list); }
+  case 32: /* print_items: print_item  */
+#line 225 "y.y"
+                        { (yyval.print_list) = (yyvsp[0].print_list); }
+#line 1549 "y.tab.c"
     break;
 
-  case 33:
-/* Line 1792 of yacc.c  */
-#line 239 "y.y"
-    {
-        print_item *current = (yyvsp[(1) - (3)].print_list);
-        while (current->next) current = current->next;
-        current->next = (yyvsp[(3) - (3)].print_list);
-        (yyval.print_list) = (yyvsp[(1) - (3)].print_list);
+  case 33: /* print_items: print_items COMMA print_item  */
+#line 226 "y.y"
+                                   {
+        (yyvsp[0].print_list)->next = (yyvsp[-2].print_list);
+        (yyval.print_list) = (yyvsp[0].print_list);
     }
+#line 1558 "y.tab.c"
     break;
 
-  case 34:
-/* Line 1792 of yacc.c  */
-#line 247 "y.y"
-    {
+  case 34: /* print_item: STRING_LITERAL  */
+#line 232 "y.y"
+                           {
         (yyval.print_list) = create_print_item();
         (yyval.print_list)->type = PRINT_STRING;
-        (yyval.print_list)->value.str = processString((yyvsp[(1) - (1)].str)); /* UPDATED */
-        free((yyvsp[(1) - (1)].str));
+        (yyval.print_list)->value.str = program.strings[(yyvsp[0].lit)];
     }
+#line 1568 "y.tab.c"
     break;
 
-  case 35:
-/* Line 1792 of yacc.c  */
-#line 253 "y.y"
-    {
+  case 35: /* print_item: CHARACTER  */
+#line 237 "y.y"
+                {
         (yyval.print_list) = create_print_item();
         (yyval.print_list)->type = PRINT_CHAR;
-        char *temp = processString((yyvsp[(1) - (1)].str)); /* UPDATED */
-        (yyval.print_list)->value.char_val = temp[0];
-        free(temp);
-        free((yyvsp[(1) - (1)].str));
+        (yyval.print_list)->value.char_val = program.strings[(yyvsp[0].lit)][0];
     }
+#line 1578 "y.tab.c"
     break;
 
-  case 36:
-/* Line 1792 of yacc.c  */
-#line 261 "y.y"
-    {
+  case 36: /* print_item: expr  */
+#line 242 "y.y"
+           {
         (yyval.print_list) = create_print_item();
         (yyval.print_list)->type = PRINT_EXPR;
-        
-        (yyval.print_list)->value.expr_val.type = (yyvsp[(1) - (1)].val).type;
-        
-        if ((yyvsp[(1) - (1)].val).type == 0) { // int
-            (yyval.print_list)->value.expr_val.value.i_val = (yyvsp[(1) - (1)].val).i_val;
-        } else if ((yyvsp[(1) - (1)].val).type == 1) { // float
-            (yyval.print_list)->value.expr_val.value.f_val = (yyvsp[(1) - (1)].val).f_val;
-        } else if ((yyvsp[(1) - (1)].val).type == 2) { // string
-            (yyval.print_list)->value.expr_val.value.s_val = (yyvsp[(1) - (1)].val).s_val ? strdup((yyvsp[(1) - (1)].val).s_val) : NULL;
-        } else if ((yyvsp[(1) - (1)].val).type == 3) { // char
-            (yyval.print_list)->value.expr_val.value.i_val = (yyvsp[(1) - (1)].val).i_val;
-        }
+        (yyval.print_list)->value.expr_type = (yyvsp[0].val);
     }
+#line 1588 "y.tab.c"
     break;
 
-  case 37:
-/* Line 1792 of yacc.c  */
-#line 279 "y.y"
-    { (yyval.val) = (yyvsp[(1) - (1)].val); }
+  case 37: /* expr: term  */
+#line 249 "y.y"
+           { (yyval.val) = (yyvsp[0].val); }
+#line 1594 "y.tab.c"
     break;
 
-  case 38:
-/* Line 1792 of yacc.c  */
-#line 280 "y.y"
-    { (yyval.val) = do_math((yyvsp[(1) - (3)].val), (yyvsp[(3) - (3)].val), '+'); }
+  case 38: /* expr: expr PLUS term  */
+#line 250 "y.y"
+                     { (yyval.val) = do_math((yyvsp[-2].val), (yyvsp[0].val), '+'); }
+#line 1600 "y.tab.c"
     break;
 
-  case 39:
-/* Line 1792 of yacc.c  */
-#line 281 "y.y"
-    { (yyval.val) = do_math((yyvsp[(1) - (3)].val), (yyvsp[(3) - (3)].val), '-'); }
+  case 39: /* expr: expr MINUS term  */
+#line 251 "y.y"
+                      { (yyval.val) = do_math((yyvsp[-2].val), (yyvsp[0].val), '-'); }
+#line 1606 "y.tab.c"
     break;
 
-  case 40:
-/* Line 1792 of yacc.c  */
-#line 284 "y.y"
-    { (yyval.val) = (yyvsp[(1) - (1)].val); }
+  case 40: /* term: factor  */
+#line 254 "y.y"
+             { (yyval.val) = (yyvsp[0].val); }
+#line 1612 "y.tab.c"
     break;
 
-  case 41:
-/* Line 1792 of yacc.c  */
-#line 285 "y.y"
-    { (yyval.val) = do_math((yyvsp[(1) - (3)].val), (yyvsp[(3) - (3)].val), '*'); }
+  case 41: /* term: term MULTIPLY factor  */
+#line 255 "y.y"
+                           { (yyval.val) = do_math((yyvsp[-2].val), (yyvsp[0].val), '*'); }
+#line 1618 "y.tab.c"
     break;
 
-  case 42:
-/* Line 1792 of yacc.c  */
-#line 286 "y.y"
-    { (yyval.val) = do_math((yyvsp[(1) - (3)].val), (yyvsp[(3) - (3)].val), '/'); }
+  case 42: /* term: term DIVIDE factor  */
+#line 256 "y.y"
+                         { (yyval.val) = do_math((yyvsp[-2].val), (yyvsp[0].val), '/'); }
+#line 1624 "y.tab.c"
     break;
 
-  case 43:
-/* Line 1792 of yacc.c  */
-#line 289 "y.y"
-    { 
-        (yyval.val).type = 0; 
-        (yyval.val).i_val = (yyvsp[(1) - (1)].num); 
-        (yyval.val).f_val = 0.0; 
+  case 43: /* factor: INTEGER  */
+#line 259 "y.y"
+                { 
+        EMIT(OP_PUSH_INT, (yyvsp[0].num));
+        (yyval.val) = TYPE_INT; 
     }
+#line 1633 "y.tab.c"
     break;
 
-  case 44:
-/* Line 1792 of yacc.c  */
-#line 294 "y.y"
-    { 
-        (yyval.val).type = 1; 
-        (yyval.val).i_val = 0; 
-        (yyval.val).f_val = (yyvsp[(1) - (1)].float_num); 
+  case 44: /* factor: FLOAT  */
+#line 263 "y.y"
+            { 
+        emit_float(&program, (yyvsp[0].float_num), yylineno);
+        (yyval.val) = TYPE_FLOAT; 
     }
+#line 1642 "y.tab.c"
     break;
 
-  case 45:
-/* Line 1792 of yacc.c  */
-#line 299 "y.y"
-    {
-        if (!varExists((yyvsp[(1) - (1)].str))) yyerror("Undeclared variable");
-        symbol *var = getSymbol((yyvsp[(1) - (1)].str));
-        if (strcmp(var->type, "int") == 0) {
-            (yyval.val).type = 0; (yyval.val).i_val = var->value.int_val;
-        } else if (strcmp(var->type, "float") == 0) {
-            (yyval.val).type = 1; (yyval.val).f_val = var->value.float_val;
-        } else if (strcmp(var->type, "char") == 0) {
-            (yyval.val).type = 3; /* Type 3 for Char */
-            (yyval.val).i_val = (int)var->value.char_val; 
-        } else if (strcmp(var->type, "string") == 0) {
-            (yyval.val).type = 2; (yyval.val).s_val = var->value.str_val;
-        } else {
-             (yyval.val).type=0; 
-        }
+  case 45: /* factor: IDENTIFIER  */
+#line 267 "y.y"
+                 {
+        symbol *var = getSymbol((yyvsp[0].sym));
+        EMIT(OP_LOAD, var->slot);
+        (yyval.val) = var->type; /* a char stays a char until arithmetic widens it */
         var->is_used = 1;
-        free((yyvsp[(1) - (1)].str));
     }
+#line 1653 "y.tab.c"
     break;
 
-  case 46:
-/* Line 1792 of yacc.c  */
-#line 317 "y.y"
-    { 
-        (yyval.val) = (yyvsp[(2) - (2)].val);
-        if((yyval.val).type == 0 || (yyval.val).type == 3) (yyval.val).i_val = -(yyval.val).i_val;
-        else if((yyval.val).type == 1) (yyval.val).f_val = -(yyval.val).f_val;
+  case 46: /* factor: MINUS factor  */
+#line 273 "y.y"
+                                { 
+        (yyval.val) = (yyvsp[0].val);
+        if((yyval.val) == TYPE_INT || (yyval.val) == TYPE_CHAR) EMIT(OP_NEG_INT, 0);
+        else if((yyval.val) == TYPE_FLOAT) EMIT(OP_NEG_FLOAT, 0);
         else yyerror("Cannot negate a string");
     }
+#line 1664 "y.tab.c"
     break;
 
-  case 47:
-/* Line 1792 of yacc.c  */
-#line 323 "y.y"
-    { 
-        (yyval.val) = (yyvsp[(2) - (2)].val); 
-        if((yyval.val).type == 2) yyerror("Cannot use + on string");
+  case 47: /* factor: PLUS factor  */
+#line 279 "y.y"
+                              { 
+        (yyval.val) = (yyvsp[0].val); 
+        if((yyval.val) == TYPE_STRING) yyerror("Cannot use + on string");
     }
+#line 1673 "y.tab.c"
     break;
 
-  case 48:
-/* Line 1792 of yacc.c  */
-#line 327 "y.y"
-    { (yyval.val) = (yyvsp[(2) - (3)].val); }
+  case 48: /* factor: LPAREN expr RPAREN  */
+#line 283 "y.y"
+                         { (yyval.val) = (yyvsp[-1].val); }
+#line 1679 "y.tab.c"
     break;
 
-  case 49:
-/* Line 1792 of yacc.c  */
-#line 330 "y.y"
-    {
-        (yyval.str) = processString((yyvsp[(1) - (1)].str)); /* UPDATED */
-        free((yyvsp[(1) - (1)].str));
-    }
+  case 49: /* string_val: STRING_LITERAL  */
+#line 286 "y.y"
+                           { (yyval.lit) = (yyvsp[0].lit); }
+#line 1685 "y.tab.c"
     break;
 
-  case 50:
-/* Line 1792 of yacc.c  */
-#line 336 "y.y"
-    {
-        char* temp = processString((yyvsp[(1) - (1)].str)); /* UPDATED */
-        (yyval.str) = temp;
-        free((yyvsp[(1) - (1)].str));
-    }
+  case 50: /* char_val: CHARACTER  */
+#line 289 "y.y"
+                    { (yyval.lit) = (yyvsp[0].lit); }
+#line 1691 "y.tab.c"
     break;
 
 
-/* Line 1792 of yacc.c  */
-#line 1921 "y.tab.c"
+#line 1695 "y.tab.c"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -1931,96 +1706,58 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
-	 error, discard it.  */
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
     }
 
   /* Else will try to reuse lookahead token after shifting the error
@@ -2032,14 +1769,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2052,29 +1788,30 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2086,7 +1823,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2097,26 +1834,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2125,69 +1866,56 @@ yyreturn:
       yydestruct ("Cleanup: discarding lookahead",
                   yytoken, &yylval);
     }
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
 
+  return yyresult;
+}
 
-/* Line 2055 of yacc.c  */
-#line 343 "y.y"
+#line 292 "y.y"
 
 
 /* --- Helper Functions --- */
 
-void update_variable(char *name, ExprVal val, char op) {
-    if (!varExists(name)) yyerror("Undeclared variable");
-    
-    symbol *var = getSymbol(name);
-    
-    float val_f = (val.type == 1) ? val.f_val : (float)val.i_val;
-    int val_i   = (val.type == 1) ? (int)val.f_val : val.i_val;
+/* Maps '+', '-', '*', '/' onto the matching opcode of a group laid out
+   in that order (OP_ADD_INT, OP_ADD_TO_FLOAT, ...) */
+static Opcode arithmetic_opcode(Opcode add, char op) {
+    switch (op) {
+        case '-': return add + 1;
+        case '*': return add + 2;
+        case '/': return add + 3;
+        default:  return add;
+    }
+}
+
+/* Applies op to a variable using the value on top of the stack */
+void update_variable(int id, ValueType val, char op) {
+    symbol *var = getSymbol(id);
     
-    if (strcmp(var->type, "int") == 0) {
-        if (val.type == 2) yyerror("Cannot assign string to int");
-        switch(op) {
-            case '=': var->value.int_val = val_i; break;
-            case '+': var->value.int_val += val_i; break;
-            case '-': var->value.int_val -= val_i; break;
-            case '*': var->value.int_val *= val_i; break;
-            case '/': 
-                if (checkError(var->value.int_val, val_i) == -1) yyerror("Division by zero");
-                var->value.int_val /= val_i; 
-                break;
-        }
+    if (var->type == TYPE_INT) {
+        if (val == TYPE_STRING) yyerror("Cannot assign string to int");
+        if (val == TYPE_FLOAT) EMIT(OP_FLOAT_TO_INT, 0);
+        if (op == '=') EMIT(OP_STORE, var->slot);
+        else EMIT(arithmetic_opcode(OP_ADD_TO_INT, op), var->slot);
         var->is_initialized = 1;
     } 
-    else if (strcmp(var->type, "float") == 0) {
-        if (val.type == 2) yyerror("Cannot assign string to float");
-        switch(op) {
-            case '=': var->value.float_val = val_f; break;
-            case '+': var->value.float_val += val_f; break;
-            case '-': var->value.float_val -= val_f; break;
-            case '*': var->value.float_val *= val_f; break;
-            case '/': 
-                if (val_f == 0.0) yyerror("Division by zero");
-                var->value.float_val /= val_f; 
-                break;
-        }
+    else if (var->type == TYPE_FLOAT) {
+        if (val == TYPE_STRING) yyerror("Cannot assign string to float");
+        if (val != TYPE_FLOAT) EMIT(OP_INT_TO_FLOAT, 0);
+        if (op == '=') EMIT(OP_STORE, var->slot);
+        else EMIT(arithmetic_opcode(OP_ADD_TO_FLOAT, op), var->slot);
         var->is_initialized = 1;
     }
     else {
@@ -2195,58 +1923,34 @@ void update_variable(char *name, ExprVal val, char op) {
     }
 }
 
-ExprVal do_math(ExprVal v1, ExprVal v2, char op) {
-    ExprVal res;
-    res.i_val = 0; res.f_val = 0; res.s_val = NULL;
+/* ++ (delta 1) and -- (delta -1), prefix or postfix */
+void step_variable(int id, int delta) {
+    symbol *var = getSymbol(id);
+    if (var->type == TYPE_INT) EMIT(delta > 0 ? OP_INC_INT : OP_DEC_INT, var->slot);
+    else if (var->type == TYPE_FLOAT) EMIT(delta > 0 ? OP_INC_FLOAT : OP_DEC_FLOAT, var->slot);
+    else yyerror(delta > 0 ? "++ only for numeric types" : "-- only for numeric types");
+}
 
-    if (v1.type == 2 || v2.type == 2) {
+/* Both operands are on the stack; returns the type of the result */
+ValueType do_math(ValueType v1, ValueType v2, char op) {
+    if (v1 == TYPE_STRING || v2 == TYPE_STRING) {
         yyerror("Cannot perform arithmetic on strings");
     }
 
-    int is_float = (v1.type == 1 || v2.type == 1);
-    
-    float f1 = (v1.type == 1) ? v1.f_val : (float)v1.i_val;
-    float f2 = (v2.type == 1) ? v2.f_val : (float)v2.i_val;
-    
-    int i1 = (v1.type == 1) ? (int)v1.f_val : v1.i_val;
-    int i2 = (v2.type == 1) ? (int)v2.f_val : v2.i_val;
-
-    res.type = is_float ? 1 : 0;
-
-    switch(op) {
-        case '+': 
-            if(is_float) res.f_val = f1 + f2; 
-            else res.i_val = i1 + i2; 
-            break;
-        case '-': 
-            if(is_float) res.f_val = f1 - f2; 
-            else res.i_val = i1 - i2; 
-            break;
-        case '*': 
-            if(is_float) res.f_val = f1 * f2; 
-            else res.i_val = i1 * i2; 
-            break;
-        case '/': 
-            if (is_float) {
-                if (f2 == 0.0) yyerror("Division by zero");
-                res.f_val = f1 / f2;
-            } else {
-                if (checkError(i1, i2) == -1) yyerror("Division by zero");
-                res.i_val = i1 / i2; 
-            }
-            break;
+    if (v1 == TYPE_FLOAT || v2 == TYPE_FLOAT) {
+        if (v1 != TYPE_FLOAT) EMIT(OP_INT_TO_FLOAT_2, 0);
+        if (v2 != TYPE_FLOAT) EMIT(OP_INT_TO_FLOAT, 0);
+        EMIT(arithmetic_opcode(OP_ADD_FLOAT, op), 0);
+        return TYPE_FLOAT;
     }
-    return res;
+    EMIT(arithmetic_opcode(OP_ADD_INT, op), 0);
+    return TYPE_INT;
 }
 
-/* REPLACED removeQuotes with processString to handle \n */
-char* processString(const char *raw_str) {
-    if (raw_str == NULL) return NULL;
+/* REPLACED removeQuotes with processString to handle \n. Writes at most
+   strlen(raw_str) + 1 bytes to processed and returns the length. */
+size_t processString(const char *raw_str, char *processed) {
     int len = strlen(raw_str);
-    
-    char *processed = malloc(len + 1);
-    if (!processed) return NULL;
-
     int i = 0, j = 0;
     
     // Check for surrounding quotes to strip them
@@ -2272,35 +1976,124 @@ char* processString(const char *raw_str) {
         }
     }
     processed[j] = '\0';
-    return processed;
+    return j;
+}
+
+/* Called by the lexer for every STRING_LITERAL and CHARACTER, quotes
+   included. Returns the interned id of the unescaped text, so a literal
+   that appears many times is unescaped into one scratch buffer and stored
+   once. */
+int intern_literal(const char *raw_str) {
+    static char *scratch = NULL;
+    static size_t scratch_size = 0;
+    size_t needed = strlen(raw_str) + 1;
+    if (needed > scratch_size) {
+        scratch_size = needed > 256 ? needed : 256;
+        scratch = realloc(scratch, scratch_size);
+    }
+    size_t length = processString(raw_str, scratch);
+    return intern_string(&program, scratch, length);
+}
+
+static void grow_symbol_index(void) {
+    free(symbolIndex);
+    symbolIndexSize = symbolIndexSize ? symbolIndexSize * 2 : 256;
+    symbolIndex = malloc(symbolIndexSize * sizeof(int));
+    memset(symbolIndex, -1, symbolIndexSize * sizeof(int));
+    for (int id = 0; id < symCount; id++) {
+        unsigned i = table[id].hash & (symbolIndexSize - 1);
+        while (symbolIndex[i] != -1) i = (i + 1) & (symbolIndexSize - 1);
+        symbolIndex[i] = id;
+    }
 }
 
-symbol* getSymbol(const char *name) {
-    for (int i = 0; i < symCount; i++)
-        if (strcmp(table[i].name, name) == 0)
-            return &table[i];
-    return NULL;
+/* Called by the lexer for every IDENTIFIER. Returns the same id for the
+   same name, declared or not. */
+int intern_symbol(const char *name) {
+    if (2 * (symCount + 1) > symbolIndexSize) grow_symbol_index();
+
+    unsigned hash = hash_bytes(name, strlen(name));
+    unsigned i = hash & (symbolIndexSize - 1);
+    while (symbolIndex[i] != -1) {
+        symbol *sym = &table[symbolIndex[i]];
+        if (sym->hash == hash && strcmp(sym->name, name) == 0) return symbolIndex[i];
+        i = (i + 1) & (symbolIndexSize - 1);
+    }
+
+    if (symCount == symCapacity) {
+        symCapacity = symCapacity ? symCapacity * 2 : 128;
+        table = realloc(table, symCapacity * sizeof(symbol));
+    }
+    symbol *sym = &table[symCount];
+    memset(sym, 0, sizeof(*sym));
+    sym->name = strdup(name);
+    sym->hash = hash;
+    symbolIndex[i] = symCount;
+    return symCount++;
 }
 
-int varExists(const char *name) {
-    return getSymbol(name) != NULL;
+/* The declared variable behind a symbol id */
+symbol* getSymbol(int id) {
+    if (!table[id].declared) yyerror("Undeclared variable");
+    return &table[id];
 }
 
-void declareVar(const char *name, const char *type) {
-    if (varExists(name)) yyerror("Redeclaration of variable");
-    if (symCount >= 100) yyerror("Symbol table overflow");
+void declareVar(int id, ValueType type) {
+    symbol *var = &table[id];
+    if (var->declared) yyerror("Redeclaration of variable");
     
-    strcpy(table[symCount].name, name);
-    strcpy(table[symCount].type, type);
-    table[symCount].value.int_val = 0; 
-    table[symCount].value.str_val = NULL;
-    table[symCount].is_initialized = 0;
-    table[symCount].is_used = 0;
-    symCount++;
+    /* every run starts with zeroed slots, so declarations emit no code */
+    var->declared = 1;
+    var->type = type;
+    var->slot = program.slot_count++;
+    var->is_initialized = 0;
+    var->is_used = 0;
+}
+
+static void free_symbols(void) {
+    for (int i = 0; i < symCount; i++) free(table[i].name);
+    free(table);
+    free(symbolIndex);
+    table = NULL;
+    symCount = symCapacity = 0;
+    symbolIndex = NULL;
+    symbolIndexSize = 0;
 }
 
+/* Print items are carved out of blocks and go back on a spare list after
+   a print statement is compiled, so a script only needs as many as its
+   longest print statement. reset_print_items reclaims every node between
+   scripts, including the ones a compile error abandoned. */
+#define PRINT_ITEM_BLOCK_SIZE 64
+
+typedef struct print_item_block {
+    struct print_item_block *next;
+    int used;
+    print_item items[PRINT_ITEM_BLOCK_SIZE];
+} print_item_block;
+
+static print_item_block *print_item_blocks = NULL;
+static print_item_block *current_print_block = NULL;
+static print_item *spare_print_items = NULL;
+
 print_item* create_print_item() {
-    print_item *item = (print_item*)malloc(sizeof(print_item));
+    print_item *item = spare_print_items;
+    if (item) {
+        spare_print_items = item->next;
+    } else {
+        if (!current_print_block || current_print_block->used == PRINT_ITEM_BLOCK_SIZE) {
+            print_item_block *next = current_print_block ? current_print_block->next : print_item_blocks;
+            if (!next) {
+                next = malloc(sizeof(print_item_block));
+                next->next = NULL;
+                if (current_print_block) current_print_block->next = next;
+                else print_item_blocks = next;
+            }
+            next->used = 0;
+            current_print_block = next;
+        }
+        item = &current_print_block->items[current_print_block->used++];
+    }
     item->next = NULL;
     item->value.str = NULL; 
     return item;
@@ -2309,70 +2102,112 @@ print_item* create_print_item() {
 void free_print_list(print_item *list) {
     while (list) {
         print_item *next = list->next;
-        if (list->type == PRINT_STRING && list->value.str) {
-            free(list->value.str);
-        } 
-        else if (list->type == PRINT_EXPR && list->value.expr_val.type == 2 && list->value.expr_val.value.s_val) {
-            free(list->value.expr_val.value.s_val);
-        }
-        free(list);
+        list->next = spare_print_items;
+        spare_print_items = list;
         list = next;
     }
 }
 
-/* UPDATED execute_print to handle spacing around newlines */
-void execute_print(print_item *list) {
-    print_item *current = list;
+print_item* reverse_print_list(print_item *list) {
+    print_item *reversed = NULL;
+    while (list) {
+        print_item *next = list->next;
+        list->next = reversed;
+        reversed = list;
+        list = next;
+    }
+    return reversed;
+}
+
+static void reset_print_items(void) {
+    spare_print_items = NULL;
+    current_print_block = NULL;
+}
+
+static void free_print_items(void) {
+    while (print_item_blocks) {
+        print_item_block *next = print_item_blocks->next;
+        free(print_item_blocks);
+        print_item_blocks = next;
+    }
+    reset_print_items();
+}
+
+/* Emits a PRINT_TEXT for the constant text collected so far */
+static void flush_text(char *pending, size_t *length) {
+    if (*length == 0) return;
+    EMIT(OP_PRINT_TEXT, intern_string(&program, pending, *length));
+    *length = 0;
+}
+
+/* Compiles a print statement. The spacing rule (a space between items
+   unless the previous one ended in \n) only depends on the literals, so
+   it is decided here and merged into the constant text. Expression values
+   were all pushed before anything prints, as the old interpreter
+   evaluated every item first. */
+void compile_print(print_item *list) {
+    static const Opcode print_opcodes[] = {
+        [TYPE_INT] = OP_PRINT_INT, [TYPE_FLOAT] = OP_PRINT_FLOAT,
+        [TYPE_STRING] = OP_PRINT_STRING, [TYPE_CHAR] = OP_PRINT_CHAR,
+    };
+    size_t size = 2;
+    int values = 0;
+    for (print_item *current = list; current; current = current->next) {
+        size += 1;
+        if (current->type == PRINT_STRING) size += strlen(current->value.str);
+        else if (current->type == PRINT_CHAR) size += 1;
+        else values++;
+    }
+
+    char *pending = malloc(size);
+    size_t length = 0;
+    int depth = values;
     int last_was_newline = 0; /* Tracks if the previous print ended in \n */
 
-    while (current) {
+    for (print_item *current = list; current; current = current->next) {
         /* Only print a space if it's NOT the first item AND the last item didn't end in \n */
         if (current != list && !last_was_newline) {
-            printf(" ");
+            pending[length++] = ' ';
         }
 
         switch (current->type) {
-            case PRINT_STRING:
-                printf("%s", current->value.str);
-                if (current->value.str && strlen(current->value.str) > 0) {
-                     char last = current->value.str[strlen(current->value.str) - 1];
-                     last_was_newline = (last == '\n');
-                } else {
-                     last_was_newline = 0;
-                }
+            case PRINT_STRING: {
+                size_t n = strlen(current->value.str);
+                memcpy(pending + length, current->value.str, n);
+                length += n;
+                last_was_newline = n > 0 && current->value.str[n - 1] == '\n';
                 break;
+            }
             case PRINT_CHAR:
-                printf("%c", current->value.char_val);
+                pending[length++] = current->value.char_val;
                 last_was_newline = (current->value.char_val == '\n');
                 break;
             case PRINT_EXPR:
-                if (current->value.expr_val.type == 1) { // Float
-                    printf("%.2f", current->value.expr_val.value.f_val);
-                } else if (current->value.expr_val.type == 0) { // Int
-                    printf("%d", current->value.expr_val.value.i_val);
-                } else if (current->value.expr_val.type == 2) { // String Variable
-                    printf("%s", current->value.expr_val.value.s_val ? current->value.expr_val.value.s_val : "(null)");
-                } else if (current->value.expr_val.type == 3) { // Char Variable
-                    printf("%c", (char)current->value.expr_val.value.i_val);
-                }
+                flush_text(pending, &length);
+                EMIT(print_opcodes[current->value.expr_type], depth--);
                 last_was_newline = 0; // Assume numbers/exprs don't end in \n
                 break;
         }
-        current = current->next;
     }
-    printf("\n");
+    pending[length++] = '\n';
+    flush_text(pending, &length);
+    if (values) EMIT(OP_POP, values);
+    free(pending);
 }
 
 void check_unused_variables() {
     printf("\n=== Variable Usage Report ===\n");
     int warnings = 0;
+    /* A name seen before its declaration is an error, so on a successful
+       run ids are in declaration order */
     for (int i = 0; i < symCount; i++) {
+        if (!table[i].declared) continue;
         if (!table[i].is_used) {
-            printf("Warning: Variable '%s' (type: %s) declared but never used\n", table[i].name, table[i].type);
+            printf("Warning: Variable '%s' (type: %s) declared but never used\n", table[i].name, type_names[table[i].type]);
             warnings++;
         }
         if (!table[i].is_initialized && table[i].is_used) {
-            printf("Warning: Variable '%s' (type: %s) used but may not have been initialized\n", table[i].name, table[i].type);
+            printf("Warning: Variable '%s' (type: %s) used but may not have been initialized\n", table[i].name, type_names[table[i].type]);
             warnings++;
         }
     }
@@ -2381,20 +2216,133 @@ void check_unused_variables() {
     }
 }
 
-int main(void) {
+/* Called by the lexer on a character no token starts with */
+void lexer_error(char c) {
+    char message[128];
+    snprintf(message, sizeof(message), "LEXER ERROR: Invalid character '%c' at line %d", c, yylineno);
+    EMIT(OP_RAISE, intern_string(&program, message, strlen(message)));
+    longjmp(compile_abort, 1);
+}
+
+/* Parses the lexer's input into program. An error leaves an OP_RAISE as
+   the last instruction, so the program reports it once it gets that far. */
+static int compile_script(void) {
+    if (setjmp(compile_abort) != 0) return 1;
+    return yyparse();
+}
+
+/* Compiles one script, runs it, prints the usage report and releases
+   everything it allocated. Returns the exit status for the script. */
+static int run_script(int runs) {
     yylineno = 1;
-    int result = yyparse();
-    check_unused_variables();
+    program_init(&program);
+    int result = compile_script();
+    EMIT(OP_HALT, 0);
+    reset_print_items();
+
+    int failed = 0;
+    for (int run = 0; run < runs && !failed; run++) {
+        failed = run_program(&program) != 0;
+    }
+    if (!failed) check_unused_variables();
     
-    for (int i = 0; i < symCount; i++) {
-        if (strcmp(table[i].type, "string") == 0 && table[i].value.str_val) {
-            free(table[i].value.str_val);
+    free_symbols();
+    program_free(&program);
+    return failed ? 1 : result;
+}
+
+/* Flex buffer functions from lex.yy.c */
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+YY_BUFFER_STATE yy_scan_bytes(const char *bytes, int len);
+void yy_delete_buffer(YY_BUFFER_STATE buffer);
+
+/* Appends stdin lines to the script buffer up to the next line that is
+   exactly the delimiter (which is dropped). Returns 0 after a delimiter,
+   1 at end of input. */
+static int read_script(const char *delimiter, char **script, size_t *length, size_t *capacity) {
+    char chunk[4096];
+    size_t line_start = *length;
+    size_t delimiter_length = strlen(delimiter);
+
+    while (fgets(chunk, sizeof(chunk), stdin)) {
+        size_t n = strlen(chunk);
+        if (*length + n + 1 > *capacity) {
+            *capacity = (*length + n + 1) * 2;
+            *script = realloc(*script, *capacity);
+        }
+        memcpy(*script + *length, chunk, n);
+        *length += n;
+        if (chunk[n - 1] != '\n' && !feof(stdin)) continue;  /* line goes on */
+
+        size_t line_length = *length - line_start;
+        const char *line = *script + line_start;
+        if (line_length && line[line_length - 1] == '\n') line_length--;
+        if (line_length && line[line_length - 1] == '\r') line_length--;
+        if (line_length == delimiter_length && memcmp(line, delimiter, delimiter_length) == 0) {
+            *length = line_start;
+            return 0;
+        }
+        line_start = *length;
+    }
+    return 1;
+}
+
+/* Runs every delimiter-separated script on stdin in this process. After a
+   script's output, "<delimiter> <status>" goes to stdout and both streams
+   are flushed, so a harness can match output and errors to scripts. */
+static int run_stream(const char *delimiter, int runs) {
+    char *script = NULL;
+    size_t capacity = 0;
+    int failures = 0;
+    int at_end = 0;
+
+    while (!at_end) {
+        size_t length = 0;
+        at_end = read_script(delimiter, &script, &length, &capacity);
+        if (at_end && length == 0) break;
+
+        YY_BUFFER_STATE buffer = yy_scan_bytes(script ? script : "", (int)length);
+        int status = run_script(runs);
+        yy_delete_buffer(buffer);
+
+        printf("%s %d\n", delimiter, status);
+        fflush(stdout);
+        fflush(stderr);
+        if (status != 0) failures++;
+    }
+    free(script);
+    return failures ? 1 : 0;
+}
+
+/* usage: ilimbag [--runs N] [--stream [--delimiter TEXT]] < script
+   The script is compiled once; --runs executes it N times (default 1).
+   --stream runs each script of a stream separated by delimiter lines
+   (default "---"), resetting all state in between. */
+int main(int argc, char **argv) {
+    int runs = 1;
+    int stream = 0;
+    const char *delimiter = "---";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream = 1;
+        } else if (strcmp(argv[i], "--delimiter") == 0 && i + 1 < argc && argv[i + 1][0]) {
+            delimiter = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--runs N] [--stream [--delimiter TEXT]] < script\n", argv[0]);
+            return 1;
         }
     }
+
+    int result = stream ? run_stream(delimiter, runs) : run_script(runs);
+    free_print_items();
     return result;
 }
 
 void yyerror(const char *s) {
-    fprintf(stderr, "LINE %d ERROR: %s\n", yylineno, s);
-    exit(1); 
-}
\ No newline at end of file
+    char message[128];
+    snprintf(message, sizeof(message), "LINE %d ERROR: %s", yylineno, s);
+    EMIT(OP_RAISE, intern_string(&program, message, strlen(message)));
+    longjmp(compile_abort, 1);
+}
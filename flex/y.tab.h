@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2012 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 #ifndef YY_YY_Y_TAB_H_INCLUDED
 # define YY_YY_Y_TAB_H_INCLUDED
-/* Enabling traces.  */
+/* Debug traces.  */
 #ifndef YYDEBUG
 # define YYDEBUG 0
 #endif
@@ -40,80 +45,109 @@
 extern int yydebug;
 #endif
 
-/* Tokens.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     NEWLINE = 258,
-     ilimbag = 259,
-     numero = 260,
-     sulat = 261,
-     letra = 262,
-     desimal = 263,
-     ASSIGN = 264,
-     COMMA = 265,
-     SEMICOLON = 266,
-     LPAREN = 267,
-     RPAREN = 268,
-     PLUS = 269,
-     MINUS = 270,
-     MULTIPLY = 271,
-     DIVIDE = 272,
-     INCREMENT = 273,
-     DECREMENT = 274,
-     PLUS_ASSIGN = 275,
-     MINUS_ASSIGN = 276,
-     MULTIPLY_ASSIGN = 277,
-     DIVIDE_ASSIGN = 278,
-     STRING_LITERAL = 279,
-     INTEGER = 280,
-     FLOAT = 281,
-     CHARACTER = 282,
-     IDENTIFIER = 283,
-     ERROR_CHAR = 284,
-     UPLUS = 285,
-     UMINUS = 286
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    NEWLINE = 258,                 /* NEWLINE  */
+    ilimbag = 259,                 /* ilimbag  */
+    numero = 260,                  /* numero  */
+    sulat = 261,                   /* sulat  */
+    letra = 262,                   /* letra  */
+    desimal = 263,                 /* desimal  */
+    ASSIGN = 264,                  /* ASSIGN  */
+    COMMA = 265,                   /* COMMA  */
+    SEMICOLON = 266,               /* SEMICOLON  */
+    LPAREN = 267,                  /* LPAREN  */
+    RPAREN = 268,                  /* RPAREN  */
+    PLUS = 269,                    /* PLUS  */
+    MINUS = 270,                   /* MINUS  */
+    MULTIPLY = 271,                /* MULTIPLY  */
+    DIVIDE = 272,                  /* DIVIDE  */
+    INCREMENT = 273,               /* INCREMENT  */
+    DECREMENT = 274,               /* DECREMENT  */
+    PLUS_ASSIGN = 275,             /* PLUS_ASSIGN  */
+    MINUS_ASSIGN = 276,            /* MINUS_ASSIGN  */
+    MULTIPLY_ASSIGN = 277,         /* MULTIPLY_ASSIGN  */
+    DIVIDE_ASSIGN = 278,           /* DIVIDE_ASSIGN  */
+    STRING_LITERAL = 279,          /* STRING_LITERAL  */
+    INTEGER = 280,                 /* INTEGER  */
+    FLOAT = 281,                   /* FLOAT  */
+    CHARACTER = 282,               /* CHARACTER  */
+    IDENTIFIER = 283,              /* IDENTIFIER  */
+    ERROR_CHAR = 284,              /* ERROR_CHAR  */
+    UMINUS = 285,                  /* UMINUS  */
+    UPLUS = 286                    /* UPLUS  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define NEWLINE 258
+#define ilimbag 259
+#define numero 260
+#define sulat 261
+#define letra 262
+#define desimal 263
+#define ASSIGN 264
+#define COMMA 265
+#define SEMICOLON 266
+#define LPAREN 267
+#define RPAREN 268
+#define PLUS 269
+#define MINUS 270
+#define MULTIPLY 271
+#define DIVIDE 272
+#define INCREMENT 273
+#define DECREMENT 274
+#define PLUS_ASSIGN 275
+#define MINUS_ASSIGN 276
+#define MULTIPLY_ASSIGN 277
+#define DIVIDE_ASSIGN 278
+#define STRING_LITERAL 279
+#define INTEGER 280
+#define FLOAT 281
+#define CHARACTER 282
+#define IDENTIFIER 283
+#define ERROR_CHAR 284
+#define UMINUS 285
+#define UPLUS 286
 
-
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
+union YYSTYPE
 {
-/* Line 2058 of yacc.c  */
-#line 50 "y.y"
+#line 65 "y.y"
 
     int num;
     float float_num;
     char *str;
-    ExprVal val;
+    int sym;         /* symbol id from intern_symbol */
+    int lit;         /* string id from intern_literal */
+    ValueType val;   /* static type; the value itself is on the VM stack */
     print_item *print_list;
 
+#line 139 "y.tab.h"
 
-/* Line 2058 of yacc.c  */
-#line 97 "y.tab.h"
-} YYSTYPE;
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
 
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
+
 int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
+
 
 #endif /* !YY_YY_Y_TAB_H_INCLUDED  */
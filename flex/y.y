@@ -3,44 +3,59 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <setjmp.h>
 #include "types.h" 
+#include "vm.h"
 
 extern int yylex();
 extern void yyerror(const char *s);
 extern int yylineno;
 
-/* Declare the function from tools.c */
-extern int checkError(int a, int b);
-
-/* Symbol Table Definition */
+/* Symbol Table Definition. The lexer interns every identifier it sees
+   and hands the parser its index, so grammar actions never compare names.
+   Values live in VM slots; the table only exists while compiling. */
 typedef struct {
-    char name[50];
-    union {
-        int int_val;
-        float float_val;
-        char char_val;
-        char *str_val;
-    } value;
-    char type[10];  // "int", "float", "char", "string"
+    char *name;
+    unsigned hash;
+    ValueType type;
+    int declared;
+    int slot;
     int is_initialized;
     int is_used;
 } symbol;
 
-symbol table[100];
+symbol *table = NULL;           /* indexed by symbol id */
 int symCount = 0;
+static int symCapacity = 0;
+static int *symbolIndex = NULL; /* open addressing over ids, -1 when empty */
+static int symbolIndexSize = 0;
+
+static const char *type_names[] = { "int", "float", "string", "char" };
+
+/* The script being compiled. Grammar actions append to it as they reduce. */
+Program program;
+#define EMIT(opcode, operand) emit(&program, (opcode), (operand), yylineno)
+
+/* yyerror and lexer_error jump back to main, which runs what was compiled
+   up to the error so output stays in the same order as the error */
+static jmp_buf compile_abort;
 
 /* Function Prototypes */
-symbol* getSymbol(const char *name);
-int varExists(const char *name);
-void declareVar(const char *name, const char *type);
-char* processString(const char *raw_str); /* UPDATED NAME */
-ExprVal do_math(ExprVal v1, ExprVal v2, char op);
-void update_variable(char *name, ExprVal val, char op);
+int intern_symbol(const char *name);
+symbol* getSymbol(int id);
+void declareVar(int id, ValueType type);
+size_t processString(const char *raw_str, char *processed);
+int intern_literal(const char *raw_str);
+ValueType do_math(ValueType v1, ValueType v2, char op);
+void update_variable(int id, ValueType val, char op);
+void step_variable(int id, int delta);
+void lexer_error(char c);
 
 /* Print list functions */
 print_item* create_print_item();
+print_item* reverse_print_list(print_item *list);
 void free_print_list(print_item *list);
-void execute_print(print_item *list);
+void compile_print(print_item *list);
 
 int yyparse(void);
 void check_unused_variables();
@@ -51,7 +66,9 @@ void check_unused_variables();
     int num;
     float float_num;
     char *str;
-    ExprVal val;
+    int sym;         /* symbol id from intern_symbol */
+    int lit;         /* string id from intern_literal */
+    ValueType val;   /* static type; the value itself is on the VM stack */
     print_item *print_list;
 }
 
@@ -62,11 +79,11 @@ void check_unused_variables();
 %token PLUS MINUS MULTIPLY DIVIDE 
 %token INCREMENT DECREMENT
 %token PLUS_ASSIGN MINUS_ASSIGN MULTIPLY_ASSIGN DIVIDE_ASSIGN 
-%token <str> STRING_LITERAL
+%token <lit> STRING_LITERAL
 %token <num> INTEGER
 %token <float_num> FLOAT
-%token <str> CHARACTER
-%token <str> IDENTIFIER
+%token <lit> CHARACTER
+%token <sym> IDENTIFIER
 %token ERROR_CHAR
 
 // Operator precedence
@@ -76,7 +93,7 @@ void check_unused_variables();
 
 // Types
 %type <val> expr term factor
-%type <str> string_val char_val
+%type <lit> string_val char_val
 %type <print_list> print_items print_item
 
 %%
@@ -93,186 +110,139 @@ line: statement NEWLINE
 statement: declaration      
     | assignment            
     | print_stmt
-    | expr { /* Silent execution */ }
+    | expr { EMIT(OP_POP, 1); /* Silent execution */ }
     ;
 
 declaration: numero IDENTIFIER {
-        declareVar($2, "int");
-        free($2);
+        declareVar($2, TYPE_INT);
     }
     | numero IDENTIFIER ASSIGN expr {
-        declareVar($2, "int");
-        symbol *var = getSymbol($2);
-        if ($4.type == 0 || $4.type == 3) var->value.int_val = $4.i_val;
-        else if ($4.type == 1) var->value.int_val = (int)$4.f_val;
-        else yyerror("Cannot assign string to int");
+        declareVar($2, TYPE_INT);
+        symbol *var = &table[$2];
+        if ($4 == TYPE_FLOAT) EMIT(OP_FLOAT_TO_INT, 0);
+        else if ($4 == TYPE_STRING) yyerror("Cannot assign string to int");
+        EMIT(OP_STORE, var->slot);
         var->is_initialized = 1;
-        free($2);
     }
     | desimal IDENTIFIER {
-        declareVar($2, "float");
-        free($2);
+        declareVar($2, TYPE_FLOAT);
     }
     | desimal IDENTIFIER ASSIGN expr {
-        declareVar($2, "float");
-        symbol *var = getSymbol($2);
-        if ($4.type == 1) var->value.float_val = $4.f_val;
-        else if ($4.type == 0 || $4.type == 3) var->value.float_val = (float)$4.i_val;
-        else yyerror("Cannot assign string to float");
+        declareVar($2, TYPE_FLOAT);
+        symbol *var = &table[$2];
+        if ($4 == TYPE_INT || $4 == TYPE_CHAR) EMIT(OP_INT_TO_FLOAT, 0);
+        else if ($4 == TYPE_STRING) yyerror("Cannot assign string to float");
+        EMIT(OP_STORE, var->slot);
         var->is_initialized = 1;
-        free($2);
     }
     | letra IDENTIFIER {
-        declareVar($2, "char");
-        free($2);
+        declareVar($2, TYPE_CHAR);
     }
     | letra IDENTIFIER ASSIGN char_val {
-        declareVar($2, "char");
-        symbol *var = getSymbol($2);
-        if ($4 && $4[0]) var->value.char_val = $4[0];
+        declareVar($2, TYPE_CHAR);
+        symbol *var = &table[$2];
+        char c = program.strings[$4][0];
+        if (c) {
+            EMIT(OP_PUSH_INT, c);
+            EMIT(OP_STORE, var->slot);
+        }
         var->is_initialized = 1;
-        free($2);
-        free($4);
     }
     | sulat IDENTIFIER {
-        declareVar($2, "string");
-        free($2);
+        declareVar($2, TYPE_STRING);
     }
     | sulat IDENTIFIER ASSIGN string_val {
-        declareVar($2, "string");
-        symbol *var = getSymbol($2);
-        var->value.str_val = $4; 
+        declareVar($2, TYPE_STRING);
+        symbol *var = &table[$2];
+        EMIT(OP_PUSH_STRING, $4);
+        EMIT(OP_STORE, var->slot);
         var->is_initialized = 1;
-        free($2);
     }
     ;
 
 assignment: IDENTIFIER ASSIGN expr {
         update_variable($1, $3, '=');
-        free($1);
     }
     | IDENTIFIER PLUS_ASSIGN expr {
         update_variable($1, $3, '+');
-        free($1);
     }
     | IDENTIFIER MINUS_ASSIGN expr {
         update_variable($1, $3, '-');
-        free($1);
     }
     | IDENTIFIER MULTIPLY_ASSIGN expr {
         update_variable($1, $3, '*');
-        free($1);
     }
     | IDENTIFIER DIVIDE_ASSIGN expr {
         update_variable($1, $3, '/');
-        free($1);
     }
     | IDENTIFIER ASSIGN char_val {
-        if (!varExists($1)) yyerror("Undeclared variable");
         symbol *var = getSymbol($1);
-        if (strcmp(var->type, "char") == 0) {
-            var->value.char_val = $3[0];
+        char c = program.strings[$3][0];
+        if (var->type == TYPE_CHAR) {
+            EMIT(OP_PUSH_INT, c);
+            EMIT(OP_STORE, var->slot);
             var->is_initialized = 1;
-        } else if (strcmp(var->type, "string") == 0) {
-             if (var->value.str_val) free(var->value.str_val);
-             char *s = malloc(2); s[0]=$3[0]; s[1]='\0';
-             var->value.str_val = s;
+        } else if (var->type == TYPE_STRING) {
+             EMIT(OP_PUSH_STRING, intern_string(&program, &c, c ? 1 : 0));
+             EMIT(OP_STORE, var->slot);
              var->is_initialized = 1;
         } else {
              yyerror("Type mismatch in assignment");
         }
-        free($1); free($3);
     }
     | IDENTIFIER ASSIGN string_val {
-        if (!varExists($1)) yyerror("Undeclared variable");
         symbol *var = getSymbol($1);
-        if (strcmp(var->type, "string") != 0) yyerror("Cannot assign string to non-string variable");
-        if (var->value.str_val) free(var->value.str_val);
-        var->value.str_val = $3;
+        if (var->type != TYPE_STRING) yyerror("Cannot assign string to non-string variable");
+        EMIT(OP_PUSH_STRING, $3);
+        EMIT(OP_STORE, var->slot);
         var->is_initialized = 1;
-        free($1);
     }
     | IDENTIFIER INCREMENT {
-        if (!varExists($1)) yyerror("Undeclared variable");
-        symbol *var = getSymbol($1);
-        if (strcmp(var->type, "int") == 0) var->value.int_val++;
-        else if (strcmp(var->type, "float") == 0) var->value.float_val += 1.0;
-        else yyerror("++ only for numeric types");
-        free($1);
+        step_variable($1, 1);
     }
     | IDENTIFIER DECREMENT {
-        if (!varExists($1)) yyerror("Undeclared variable");
-        symbol *var = getSymbol($1);
-        if (strcmp(var->type, "int") == 0) var->value.int_val--;
-        else if (strcmp(var->type, "float") == 0) var->value.float_val -= 1.0;
-        else yyerror("-- only for numeric types");
-        free($1);
+        step_variable($1, -1);
     }
     | INCREMENT IDENTIFIER {
-        if (!varExists($2)) yyerror("Undeclared variable");
-        symbol *var = getSymbol($2);
-        if (strcmp(var->type, "int") == 0) var->value.int_val++;
-        else if (strcmp(var->type, "float") == 0) var->value.float_val += 1.0;
-        else yyerror("++ only for numeric types");
-        free($2);
+        step_variable($2, 1);
     }
     | DECREMENT IDENTIFIER {
-        if (!varExists($2)) yyerror("Undeclared variable");
-        symbol *var = getSymbol($2);
-        if (strcmp(var->type, "int") == 0) var->value.int_val--;
-        else if (strcmp(var->type, "float") == 0) var->value.float_val -= 1.0;
-        else yyerror("-- only for numeric types");
-        free($2);
+        step_variable($2, -1);
     }
     ;
 
 print_stmt: ilimbag print_items {
-        execute_print($2);
-        free_print_list($2);
+        print_item *list = reverse_print_list($2);
+        compile_print(list);
+        free_print_list(list);
     }
     | ilimbag {
-        printf("\n");
+        compile_print(NULL);
     }
     ;
 
+/* Built newest-first so appending is O(1); print_stmt reverses it */
 print_items: print_item { $$ = $1; }
     | print_items COMMA print_item {
-        print_item *current = $1;
-        while (current->next) current = current->next;
-        current->next = $3;
-        $$ = $1;
+        $3->next = $1;
+        $$ = $3;
     }
     ;
 
 print_item: STRING_LITERAL {
         $$ = create_print_item();
         $$->type = PRINT_STRING;
-        $$->value.str = processString($1); /* UPDATED */
-        free($1);
+        $$->value.str = program.strings[$1];
     }
     | CHARACTER {
         $$ = create_print_item();
         $$->type = PRINT_CHAR;
-        char *temp = processString($1); /* UPDATED */
-        $$->value.char_val = temp[0];
-        free(temp);
-        free($1);
+        $$->value.char_val = program.strings[$1][0];
     }
     | expr {
         $$ = create_print_item();
         $$->type = PRINT_EXPR;
-        
-        $$->value.expr_val.type = $1.type;
-        
-        if ($1.type == 0) { // int
-            $$->value.expr_val.value.i_val = $1.i_val;
-        } else if ($1.type == 1) { // float
-            $$->value.expr_val.value.f_val = $1.f_val;
-        } else if ($1.type == 2) { // string
-            $$->value.expr_val.value.s_val = $1.s_val ? strdup($1.s_val) : NULL;
-        } else if ($1.type == 3) { // char
-            $$->value.expr_val.value.i_val = $1.i_val;
-        }
+        $$->value.expr_type = $1;
     }
     ;
 
@@ -287,97 +257,69 @@ term: factor { $$ = $1; }
     ;
 
 factor: INTEGER { 
-        $$.type = 0; 
-        $$.i_val = $1; 
-        $$.f_val = 0.0; 
+        EMIT(OP_PUSH_INT, $1);
+        $$ = TYPE_INT; 
     }
     | FLOAT { 
-        $$.type = 1; 
-        $$.i_val = 0; 
-        $$.f_val = $1; 
+        emit_float(&program, $1, yylineno);
+        $$ = TYPE_FLOAT; 
     }
     | IDENTIFIER {
-        if (!varExists($1)) yyerror("Undeclared variable");
         symbol *var = getSymbol($1);
-        if (strcmp(var->type, "int") == 0) {
-            $$.type = 0; $$.i_val = var->value.int_val;
-        } else if (strcmp(var->type, "float") == 0) {
-            $$.type = 1; $$.f_val = var->value.float_val;
-        } else if (strcmp(var->type, "char") == 0) {
-            $$.type = 3; /* Type 3 for Char */
-            $$.i_val = (int)var->value.char_val; 
-        } else if (strcmp(var->type, "string") == 0) {
-            $$.type = 2; $$.s_val = var->value.str_val;
-        } else {
-             $$.type=0; 
-        }
+        EMIT(OP_LOAD, var->slot);
+        $$ = var->type; /* a char stays a char until arithmetic widens it */
         var->is_used = 1;
-        free($1);
     }
     | MINUS factor %prec UMINUS { 
         $$ = $2;
-        if($$.type == 0 || $$.type == 3) $$.i_val = -$$.i_val;
-        else if($$.type == 1) $$.f_val = -$$.f_val;
+        if($$ == TYPE_INT || $$ == TYPE_CHAR) EMIT(OP_NEG_INT, 0);
+        else if($$ == TYPE_FLOAT) EMIT(OP_NEG_FLOAT, 0);
         else yyerror("Cannot negate a string");
     }
     | PLUS factor %prec UPLUS { 
         $$ = $2; 
-        if($$.type == 2) yyerror("Cannot use + on string");
+        if($$ == TYPE_STRING) yyerror("Cannot use + on string");
     }
     | LPAREN expr RPAREN { $$ = $2; }
     ;
 
-string_val: STRING_LITERAL {
-        $$ = processString($1); /* UPDATED */
-        free($1);
-    }
+string_val: STRING_LITERAL { $$ = $1; }
     ;
 
-char_val: CHARACTER {
-        char* temp = processString($1); /* UPDATED */
-        $$ = temp;
-        free($1);
-    }
+char_val: CHARACTER { $$ = $1; }
     ;
 
 %%
 
 /* --- Helper Functions --- */
 
-void update_variable(char *name, ExprVal val, char op) {
-    if (!varExists(name)) yyerror("Undeclared variable");
-    
-    symbol *var = getSymbol(name);
-    
-    float val_f = (val.type == 1) ? val.f_val : (float)val.i_val;
-    int val_i   = (val.type == 1) ? (int)val.f_val : val.i_val;
+/* Maps '+', '-', '*', '/' onto the matching opcode of a group laid out
+   in that order (OP_ADD_INT, OP_ADD_TO_FLOAT, ...) */
+static Opcode arithmetic_opcode(Opcode add, char op) {
+    switch (op) {
+        case '-': return add + 1;
+        case '*': return add + 2;
+        case '/': return add + 3;
+        default:  return add;
+    }
+}
+
+/* Applies op to a variable using the value on top of the stack */
+void update_variable(int id, ValueType val, char op) {
+    symbol *var = getSymbol(id);
     
-    if (strcmp(var->type, "int") == 0) {
-        if (val.type == 2) yyerror("Cannot assign string to int");
-        switch(op) {
-            case '=': var->value.int_val = val_i; break;
-            case '+': var->value.int_val += val_i; break;
-            case '-': var->value.int_val -= val_i; break;
-            case '*': var->value.int_val *= val_i; break;
-            case '/': 
-                if (checkError(var->value.int_val, val_i) == -1) yyerror("Division by zero");
-                var->value.int_val /= val_i; 
-                break;
-        }
+    if (var->type == TYPE_INT) {
+        if (val == TYPE_STRING) yyerror("Cannot assign string to int");
+        if (val == TYPE_FLOAT) EMIT(OP_FLOAT_TO_INT, 0);
+        if (op == '=') EMIT(OP_STORE, var->slot);
+        else EMIT(arithmetic_opcode(OP_ADD_TO_INT, op), var->slot);
         var->is_initialized = 1;
     } 
-    else if (strcmp(var->type, "float") == 0) {
-        if (val.type == 2) yyerror("Cannot assign string to float");
-        switch(op) {
-            case '=': var->value.float_val = val_f; break;
-            case '+': var->value.float_val += val_f; break;
-            case '-': var->value.float_val -= val_f; break;
-            case '*': var->value.float_val *= val_f; break;
-            case '/': 
-                if (val_f == 0.0) yyerror("Division by zero");
-                var->value.float_val /= val_f; 
-                break;
-        }
+    else if (var->type == TYPE_FLOAT) {
+        if (val == TYPE_STRING) yyerror("Cannot assign string to float");
+        if (val != TYPE_FLOAT) EMIT(OP_INT_TO_FLOAT, 0);
+        if (op == '=') EMIT(OP_STORE, var->slot);
+        else EMIT(arithmetic_opcode(OP_ADD_TO_FLOAT, op), var->slot);
         var->is_initialized = 1;
     }
     else {
@@ -385,58 +327,34 @@ void update_variable(char *name, ExprVal val, char op) {
     }
 }
 
-ExprVal do_math(ExprVal v1, ExprVal v2, char op) {
-    ExprVal res;
-    res.i_val = 0; res.f_val = 0; res.s_val = NULL;
+/* ++ (delta 1) and -- (delta -1), prefix or postfix */
+void step_variable(int id, int delta) {
+    symbol *var = getSymbol(id);
+    if (var->type == TYPE_INT) EMIT(delta > 0 ? OP_INC_INT : OP_DEC_INT, var->slot);
+    else if (var->type == TYPE_FLOAT) EMIT(delta > 0 ? OP_INC_FLOAT : OP_DEC_FLOAT, var->slot);
+    else yyerror(delta > 0 ? "++ only for numeric types" : "-- only for numeric types");
+}
 
-    if (v1.type == 2 || v2.type == 2) {
+/* Both operands are on the stack; returns the type of the result */
+ValueType do_math(ValueType v1, ValueType v2, char op) {
+    if (v1 == TYPE_STRING || v2 == TYPE_STRING) {
         yyerror("Cannot perform arithmetic on strings");
     }
 
-    int is_float = (v1.type == 1 || v2.type == 1);
-    
-    float f1 = (v1.type == 1) ? v1.f_val : (float)v1.i_val;
-    float f2 = (v2.type == 1) ? v2.f_val : (float)v2.i_val;
-    
-    int i1 = (v1.type == 1) ? (int)v1.f_val : v1.i_val;
-    int i2 = (v2.type == 1) ? (int)v2.f_val : v2.i_val;
-
-    res.type = is_float ? 1 : 0;
-
-    switch(op) {
-        case '+': 
-            if(is_float) res.f_val = f1 + f2; 
-            else res.i_val = i1 + i2; 
-            break;
-        case '-': 
-            if(is_float) res.f_val = f1 - f2; 
-            else res.i_val = i1 - i2; 
-            break;
-        case '*': 
-            if(is_float) res.f_val = f1 * f2; 
-            else res.i_val = i1 * i2; 
-            break;
-        case '/': 
-            if (is_float) {
-                if (f2 == 0.0) yyerror("Division by zero");
-                res.f_val = f1 / f2;
-            } else {
-                if (checkError(i1, i2) == -1) yyerror("Division by zero");
-                res.i_val = i1 / i2; 
-            }
-            break;
+    if (v1 == TYPE_FLOAT || v2 == TYPE_FLOAT) {
+        if (v1 != TYPE_FLOAT) EMIT(OP_INT_TO_FLOAT_2, 0);
+        if (v2 != TYPE_FLOAT) EMIT(OP_INT_TO_FLOAT, 0);
+        EMIT(arithmetic_opcode(OP_ADD_FLOAT, op), 0);
+        return TYPE_FLOAT;
     }
-    return res;
+    EMIT(arithmetic_opcode(OP_ADD_INT, op), 0);
+    return TYPE_INT;
 }
 
-/* REPLACED removeQuotes with processString to handle \n */
-char* processString(const char *raw_str) {
-    if (raw_str == NULL) return NULL;
+/* REPLACED removeQuotes with processString to handle \n. Writes at most
+   strlen(raw_str) + 1 bytes to processed and returns the length. */
+size_t processString(const char *raw_str, char *processed) {
     int len = strlen(raw_str);
-    
-    char *processed = malloc(len + 1);
-    if (!processed) return NULL;
-
     int i = 0, j = 0;
     
     // Check for surrounding quotes to strip them
@@ -462,35 +380,124 @@ char* processString(const char *raw_str) {
         }
     }
     processed[j] = '\0';
-    return processed;
+    return j;
+}
+
+/* Called by the lexer for every STRING_LITERAL and CHARACTER, quotes
+   included. Returns the interned id of the unescaped text, so a literal
+   that appears many times is unescaped into one scratch buffer and stored
+   once. */
+int intern_literal(const char *raw_str) {
+    static char *scratch = NULL;
+    static size_t scratch_size = 0;
+    size_t needed = strlen(raw_str) + 1;
+    if (needed > scratch_size) {
+        scratch_size = needed > 256 ? needed : 256;
+        scratch = realloc(scratch, scratch_size);
+    }
+    size_t length = processString(raw_str, scratch);
+    return intern_string(&program, scratch, length);
 }
 
-symbol* getSymbol(const char *name) {
-    for (int i = 0; i < symCount; i++)
-        if (strcmp(table[i].name, name) == 0)
-            return &table[i];
-    return NULL;
+static void grow_symbol_index(void) {
+    free(symbolIndex);
+    symbolIndexSize = symbolIndexSize ? symbolIndexSize * 2 : 256;
+    symbolIndex = malloc(symbolIndexSize * sizeof(int));
+    memset(symbolIndex, -1, symbolIndexSize * sizeof(int));
+    for (int id = 0; id < symCount; id++) {
+        unsigned i = table[id].hash & (symbolIndexSize - 1);
+        while (symbolIndex[i] != -1) i = (i + 1) & (symbolIndexSize - 1);
+        symbolIndex[i] = id;
+    }
 }
 
-int varExists(const char *name) {
-    return getSymbol(name) != NULL;
+/* Called by the lexer for every IDENTIFIER. Returns the same id for the
+   same name, declared or not. */
+int intern_symbol(const char *name) {
+    if (2 * (symCount + 1) > symbolIndexSize) grow_symbol_index();
+
+    unsigned hash = hash_bytes(name, strlen(name));
+    unsigned i = hash & (symbolIndexSize - 1);
+    while (symbolIndex[i] != -1) {
+        symbol *sym = &table[symbolIndex[i]];
+        if (sym->hash == hash && strcmp(sym->name, name) == 0) return symbolIndex[i];
+        i = (i + 1) & (symbolIndexSize - 1);
+    }
+
+    if (symCount == symCapacity) {
+        symCapacity = symCapacity ? symCapacity * 2 : 128;
+        table = realloc(table, symCapacity * sizeof(symbol));
+    }
+    symbol *sym = &table[symCount];
+    memset(sym, 0, sizeof(*sym));
+    sym->name = strdup(name);
+    sym->hash = hash;
+    symbolIndex[i] = symCount;
+    return symCount++;
 }
 
-void declareVar(const char *name, const char *type) {
-    if (varExists(name)) yyerror("Redeclaration of variable");
-    if (symCount >= 100) yyerror("Symbol table overflow");
+/* The declared variable behind a symbol id */
+symbol* getSymbol(int id) {
+    if (!table[id].declared) yyerror("Undeclared variable");
+    return &table[id];
+}
+
+void declareVar(int id, ValueType type) {
+    symbol *var = &table[id];
+    if (var->declared) yyerror("Redeclaration of variable");
     
-    strcpy(table[symCount].name, name);
-    strcpy(table[symCount].type, type);
-    table[symCount].value.int_val = 0; 
-    table[symCount].value.str_val = NULL;
-    table[symCount].is_initialized = 0;
-    table[symCount].is_used = 0;
-    symCount++;
+    /* every run starts with zeroed slots, so declarations emit no code */
+    var->declared = 1;
+    var->type = type;
+    var->slot = program.slot_count++;
+    var->is_initialized = 0;
+    var->is_used = 0;
 }
 
+static void free_symbols(void) {
+    for (int i = 0; i < symCount; i++) free(table[i].name);
+    free(table);
+    free(symbolIndex);
+    table = NULL;
+    symCount = symCapacity = 0;
+    symbolIndex = NULL;
+    symbolIndexSize = 0;
+}
+
+/* Print items are carved out of blocks and go back on a spare list after
+   a print statement is compiled, so a script only needs as many as its
+   longest print statement. reset_print_items reclaims every node between
+   scripts, including the ones a compile error abandoned. */
+#define PRINT_ITEM_BLOCK_SIZE 64
+
+typedef struct print_item_block {
+    struct print_item_block *next;
+    int used;
+    print_item items[PRINT_ITEM_BLOCK_SIZE];
+} print_item_block;
+
+static print_item_block *print_item_blocks = NULL;
+static print_item_block *current_print_block = NULL;
+static print_item *spare_print_items = NULL;
+
 print_item* create_print_item() {
-    print_item *item = (print_item*)malloc(sizeof(print_item));
+    print_item *item = spare_print_items;
+    if (item) {
+        spare_print_items = item->next;
+    } else {
+        if (!current_print_block || current_print_block->used == PRINT_ITEM_BLOCK_SIZE) {
+            print_item_block *next = current_print_block ? current_print_block->next : print_item_blocks;
+            if (!next) {
+                next = malloc(sizeof(print_item_block));
+                next->next = NULL;
+                if (current_print_block) current_print_block->next = next;
+                else print_item_blocks = next;
+            }
+            next->used = 0;
+            current_print_block = next;
+        }
+        item = &current_print_block->items[current_print_block->used++];
+    }
     item->next = NULL;
     item->value.str = NULL; 
     return item;
@@ -499,70 +506,112 @@ print_item* create_print_item() {
 void free_print_list(print_item *list) {
     while (list) {
         print_item *next = list->next;
-        if (list->type == PRINT_STRING && list->value.str) {
-            free(list->value.str);
-        } 
-        else if (list->type == PRINT_EXPR && list->value.expr_val.type == 2 && list->value.expr_val.value.s_val) {
-            free(list->value.expr_val.value.s_val);
-        }
-        free(list);
+        list->next = spare_print_items;
+        spare_print_items = list;
+        list = next;
+    }
+}
+
+print_item* reverse_print_list(print_item *list) {
+    print_item *reversed = NULL;
+    while (list) {
+        print_item *next = list->next;
+        list->next = reversed;
+        reversed = list;
         list = next;
     }
+    return reversed;
 }
 
-/* UPDATED execute_print to handle spacing around newlines */
-void execute_print(print_item *list) {
-    print_item *current = list;
+static void reset_print_items(void) {
+    spare_print_items = NULL;
+    current_print_block = NULL;
+}
+
+static void free_print_items(void) {
+    while (print_item_blocks) {
+        print_item_block *next = print_item_blocks->next;
+        free(print_item_blocks);
+        print_item_blocks = next;
+    }
+    reset_print_items();
+}
+
+/* Emits a PRINT_TEXT for the constant text collected so far */
+static void flush_text(char *pending, size_t *length) {
+    if (*length == 0) return;
+    EMIT(OP_PRINT_TEXT, intern_string(&program, pending, *length));
+    *length = 0;
+}
+
+/* Compiles a print statement. The spacing rule (a space between items
+   unless the previous one ended in \n) only depends on the literals, so
+   it is decided here and merged into the constant text. Expression values
+   were all pushed before anything prints, as the old interpreter
+   evaluated every item first. */
+void compile_print(print_item *list) {
+    static const Opcode print_opcodes[] = {
+        [TYPE_INT] = OP_PRINT_INT, [TYPE_FLOAT] = OP_PRINT_FLOAT,
+        [TYPE_STRING] = OP_PRINT_STRING, [TYPE_CHAR] = OP_PRINT_CHAR,
+    };
+    size_t size = 2;
+    int values = 0;
+    for (print_item *current = list; current; current = current->next) {
+        size += 1;
+        if (current->type == PRINT_STRING) size += strlen(current->value.str);
+        else if (current->type == PRINT_CHAR) size += 1;
+        else values++;
+    }
+
+    char *pending = malloc(size);
+    size_t length = 0;
+    int depth = values;
     int last_was_newline = 0; /* Tracks if the previous print ended in \n */
 
-    while (current) {
+    for (print_item *current = list; current; current = current->next) {
         /* Only print a space if it's NOT the first item AND the last item didn't end in \n */
         if (current != list && !last_was_newline) {
-            printf(" ");
+            pending[length++] = ' ';
         }
 
         switch (current->type) {
-            case PRINT_STRING:
-                printf("%s", current->value.str);
-                if (current->value.str && strlen(current->value.str) > 0) {
-                     char last = current->value.str[strlen(current->value.str) - 1];
-                     last_was_newline = (last == '\n');
-                } else {
-                     last_was_newline = 0;
-                }
+            case PRINT_STRING: {
+                size_t n = strlen(current->value.str);
+                memcpy(pending + length, current->value.str, n);
+                length += n;
+                last_was_newline = n > 0 && current->value.str[n - 1] == '\n';
                 break;
+            }
             case PRINT_CHAR:
-                printf("%c", current->value.char_val);
+                pending[length++] = current->value.char_val;
                 last_was_newline = (current->value.char_val == '\n');
                 break;
             case PRINT_EXPR:
-                if (current->value.expr_val.type == 1) { // Float
-                    printf("%.2f", current->value.expr_val.value.f_val);
-                } else if (current->value.expr_val.type == 0) { // Int
-                    printf("%d", current->value.expr_val.value.i_val);
-                } else if (current->value.expr_val.type == 2) { // String Variable
-                    printf("%s", current->value.expr_val.value.s_val ? current->value.expr_val.value.s_val : "(null)");
-                } else if (current->value.expr_val.type == 3) { // Char Variable
-                    printf("%c", (char)current->value.expr_val.value.i_val);
-                }
+                flush_text(pending, &length);
+                EMIT(print_opcodes[current->value.expr_type], depth--);
                 last_was_newline = 0; // Assume numbers/exprs don't end in \n
                 break;
         }
-        current = current->next;
     }
-    printf("\n");
+    pending[length++] = '\n';
+    flush_text(pending, &length);
+    if (values) EMIT(OP_POP, values);
+    free(pending);
 }
 
 void check_unused_variables() {
     printf("\n=== Variable Usage Report ===\n");
     int warnings = 0;
+    /* A name seen before its declaration is an error, so on a successful
+       run ids are in declaration order */
     for (int i = 0; i < symCount; i++) {
+        if (!table[i].declared) continue;
         if (!table[i].is_used) {
-            printf("Warning: Variable '%s' (type: %s) declared but never used\n", table[i].name, table[i].type);
+            printf("Warning: Variable '%s' (type: %s) declared but never used\n", table[i].name, type_names[table[i].type]);
             warnings++;
         }
         if (!table[i].is_initialized && table[i].is_used) {
-            printf("Warning: Variable '%s' (type: %s) used but may not have been initialized\n", table[i].name, table[i].type);
+            printf("Warning: Variable '%s' (type: %s) used but may not have been initialized\n", table[i].name, type_names[table[i].type]);
             warnings++;
         }
     }
@@ -571,20 +620,133 @@ void check_unused_variables() {
     }
 }
 
-int main(void) {
+/* Called by the lexer on a character no token starts with */
+void lexer_error(char c) {
+    char message[128];
+    snprintf(message, sizeof(message), "LEXER ERROR: Invalid character '%c' at line %d", c, yylineno);
+    EMIT(OP_RAISE, intern_string(&program, message, strlen(message)));
+    longjmp(compile_abort, 1);
+}
+
+/* Parses the lexer's input into program. An error leaves an OP_RAISE as
+   the last instruction, so the program reports it once it gets that far. */
+static int compile_script(void) {
+    if (setjmp(compile_abort) != 0) return 1;
+    return yyparse();
+}
+
+/* Compiles one script, runs it, prints the usage report and releases
+   everything it allocated. Returns the exit status for the script. */
+static int run_script(int runs) {
     yylineno = 1;
-    int result = yyparse();
-    check_unused_variables();
+    program_init(&program);
+    int result = compile_script();
+    EMIT(OP_HALT, 0);
+    reset_print_items();
+
+    int failed = 0;
+    for (int run = 0; run < runs && !failed; run++) {
+        failed = run_program(&program) != 0;
+    }
+    if (!failed) check_unused_variables();
     
-    for (int i = 0; i < symCount; i++) {
-        if (strcmp(table[i].type, "string") == 0 && table[i].value.str_val) {
-            free(table[i].value.str_val);
+    free_symbols();
+    program_free(&program);
+    return failed ? 1 : result;
+}
+
+/* Flex buffer functions from lex.yy.c */
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+YY_BUFFER_STATE yy_scan_bytes(const char *bytes, int len);
+void yy_delete_buffer(YY_BUFFER_STATE buffer);
+
+/* Appends stdin lines to the script buffer up to the next line that is
+   exactly the delimiter (which is dropped). Returns 0 after a delimiter,
+   1 at end of input. */
+static int read_script(const char *delimiter, char **script, size_t *length, size_t *capacity) {
+    char chunk[4096];
+    size_t line_start = *length;
+    size_t delimiter_length = strlen(delimiter);
+
+    while (fgets(chunk, sizeof(chunk), stdin)) {
+        size_t n = strlen(chunk);
+        if (*length + n + 1 > *capacity) {
+            *capacity = (*length + n + 1) * 2;
+            *script = realloc(*script, *capacity);
+        }
+        memcpy(*script + *length, chunk, n);
+        *length += n;
+        if (chunk[n - 1] != '\n' && !feof(stdin)) continue;  /* line goes on */
+
+        size_t line_length = *length - line_start;
+        const char *line = *script + line_start;
+        if (line_length && line[line_length - 1] == '\n') line_length--;
+        if (line_length && line[line_length - 1] == '\r') line_length--;
+        if (line_length == delimiter_length && memcmp(line, delimiter, delimiter_length) == 0) {
+            *length = line_start;
+            return 0;
         }
+        line_start = *length;
     }
+    return 1;
+}
+
+/* Runs every delimiter-separated script on stdin in this process. After a
+   script's output, "<delimiter> <status>" goes to stdout and both streams
+   are flushed, so a harness can match output and errors to scripts. */
+static int run_stream(const char *delimiter, int runs) {
+    char *script = NULL;
+    size_t capacity = 0;
+    int failures = 0;
+    int at_end = 0;
+
+    while (!at_end) {
+        size_t length = 0;
+        at_end = read_script(delimiter, &script, &length, &capacity);
+        if (at_end && length == 0) break;
+
+        YY_BUFFER_STATE buffer = yy_scan_bytes(script ? script : "", (int)length);
+        int status = run_script(runs);
+        yy_delete_buffer(buffer);
+
+        printf("%s %d\n", delimiter, status);
+        fflush(stdout);
+        fflush(stderr);
+        if (status != 0) failures++;
+    }
+    free(script);
+    return failures ? 1 : 0;
+}
+
+/* usage: ilimbag [--runs N] [--stream [--delimiter TEXT]] < script
+   The script is compiled once; --runs executes it N times (default 1).
+   --stream runs each script of a stream separated by delimiter lines
+   (default "---"), resetting all state in between. */
+int main(int argc, char **argv) {
+    int runs = 1;
+    int stream = 0;
+    const char *delimiter = "---";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            stream = 1;
+        } else if (strcmp(argv[i], "--delimiter") == 0 && i + 1 < argc && argv[i + 1][0]) {
+            delimiter = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--runs N] [--stream [--delimiter TEXT]] < script\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int result = stream ? run_stream(delimiter, runs) : run_script(runs);
+    free_print_items();
     return result;
 }
 
 void yyerror(const char *s) {
-    fprintf(stderr, "LINE %d ERROR: %s\n", yylineno, s);
-    exit(1); 
-}
\ No newline at end of file
+    char message[128];
+    snprintf(message, sizeof(message), "LINE %d ERROR: %s", yylineno, s);
+    EMIT(OP_RAISE, intern_string(&program, message, strlen(message)));
+    longjmp(compile_abort, 1);
+}
@@ -5,10 +5,29 @@
 #include <stdbool.h>
 #include <stdarg.h>
 
-#define MAX_NAME_LENGTH 32
-#define MAX_TOKENS 1000
-#define MAX_SYMBOLS 100
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#define INITIAL_TOKEN_CAPACITY 1024
+#define INITIAL_SYMBOL_CAPACITY 64
 #define MAX_ERRORS 100
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define INITIAL_CODE_CAPACITY (16 * 1024)
+#define INITIAL_INSTRUCTION_CAPACITY 1024
+#define DATA_SEGMENT_LIMIT 32768  // slots are addressed as offset(r0), a signed 16-bit offset
 
 typedef enum {
     END_OF_FILE, NUMBER, IDENTIFIER, PLUS, MINUS,
@@ -23,21 +42,40 @@ typedef enum {
 typedef enum { 
     PROGRAM_NODE, ASSIGNMENT_NODE, VARIABLE_NODE, 
     NUMBER_NODE, OPERATION_NODE, UNARY_NODE,
-    COMPOUND_ASSIGN_NODE, CHAR_NODE, DECLARATION_NODE
+    COMPOUND_ASSIGN_NODE, CHAR_NODE, DECLARATION_NODE,
+    SHIFT_NODE  // left_child shifted by the constant right_child; '*' left, '/' right
 } ASTNodeType;
 
+// Instructions are named by opcode at codegen time; the encoding rules
+// below are looked up by index, so no mnemonic is ever compared
+typedef enum {
+    OP_DADDIU, OP_LB, OP_SB,
+    OP_DADDU, OP_DSUBU, OP_DMULU, OP_DDIVU, OP_MFLO,
+    OP_DSLL, OP_DSRL, OP_DSLL32, OP_DSRA32,
+    INSTRUCTION_COUNT
+} Opcode;
+
+// Token text is a slice (pointer + length) into the source code, or into the
+// compile arena for literals whose value differs from their spelling
 typedef struct {
     TokenType type;
-    char text[MAX_NAME_LENGTH];
+    const char* text;
+    int length;
     int line_number;
 } Token;
 
 typedef struct {
-    char name[MAX_NAME_LENGTH];
+    const char* name;
+    int name_length;
+    unsigned int name_hash;
     int is_initialized;
     int is_used;
     int memory_location;
     int size;
+    int live_range;       // index into register_allocation.ranges, -1 = not accessed
+    int home_register;    // register given by the allocator, 0 = lives in memory
+    bool is_dirty;        // register is newer than memory
+    bool is_normalized;   // register holds the sign-extended byte lb would give
 } Symbol;
 
 typedef struct ASTNode {
@@ -60,87 +98,320 @@ typedef struct {
     int register_count;
 } RegisterPool;
 
-Token all_tokens[MAX_TOKENS];
-int current_token_count = 0;
-int current_token_position = 0;
-Symbol symbol_table[MAX_SYMBOLS];
-int symbols_found = 0;
-int next_memory_location = 0;
-ErrorList error_log = {0};
-RegisterPool register_pool = {0};
+// Statements from first to last access of one variable, and its register
+typedef struct {
+    int start;
+    int end;
+    int symbol;           // index into symbol_table
+    int home_register;    // 0 = spilled
+} LiveRange;
+
+typedef struct {
+    LiveRange* ranges;        // every accessed variable, ordered by start
+    int range_count;
+    int range_capacity;
+    LiveRange* ended;         // the ranges that got a register, ordered by end
+    int ended_count;
+    int ended_capacity;
+    int next_start;           // cursors into ranges and ended during codegen
+    int next_end;
+    bool full_width_reads;    // operands of ddivu/dsrl need lb-exact values
+    int statement_line;       // for errors raised during codegen
+    bool out_of_registers;    // reported once per compile
+} RegisterAllocation;
+
+// Bump allocator for everything whose lifetime is one compile. Blocks are
+// kept after a reset and reused by the next compile on the same context.
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock* first;
+    ArenaBlock* current;
+} Arena;
+
+// Generated listing, built in memory and written out in one piece once the
+// program has compiled. The storage is kept across compiles.
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    bool out_of_memory;
+} CodeBuffer;
+
+// One instruction as code generation produced it. Its machine code is only
+// rendered once the peephole pass has looked at the whole program.
+typedef struct {
+    Opcode opcode;
+    int source_reg;
+    int target_reg;
+    int dest_reg;
+    int immediate_value;
+    size_t line_start;      // its assembly line in assembly_text
+    size_t line_length;
+    long rewritten_start;   // replacement line in rewritten_text, -1 = none
+    int rewritten_length;
+    bool removed;
+} PendingInstruction;
+
+typedef struct {
+    PendingInstruction* items;
+    int count;
+    int capacity;
+    CodeBuffer assembly_text;   // everything code generation emitted, in order
+    CodeBuffer rewritten_text;  // lines for instructions the peephole pass changed
+} InstructionList;
+
+// How render_machine_code renders each instruction word
+typedef enum {
+    MACHINE_CODE_BINARY,  // ";0110 0100 ..." after each instruction (default)
+    MACHINE_CODE_HEX,     // ";0x64010005" after each instruction
+    MACHINE_CODE_RAW_LE,  // words collected into a little-endian object file
+    MACHINE_CODE_RAW_BE   // words collected into a big-endian object file
+} MachineCodeFormat;
+
+// Where compile_program sends the listing
+typedef enum {
+    EMIT_FILE = 1,
+    EMIT_STDOUT = 2,
+    EMIT_BOTH = EMIT_FILE | EMIT_STDOUT
+} EmitTarget;
+
+// Phases --stats json times, in the order a compile runs them
+typedef enum {
+    PHASE_LEX, PHASE_PARSE, PHASE_SEMANTIC, PHASE_OPTIMIZE, PHASE_CODEGEN, PHASE_OUTPUT,
+    PHASE_COUNT
+} CompilePhase;
+
+// Wall time per phase and the counters that only exist while compiling;
+// the others are read from the context when the stats line is written
+typedef struct {
+    bool enabled;
+    struct timespec phase_start;
+    double phase_milliseconds[PHASE_COUNT];
+    int ast_nodes;
+    int spilled_registers;  // live ranges the allocator left in memory
+    size_t bytes_written;
+} CompileStats;
+
+typedef struct {
+    Token* all_tokens;
+    int current_token_count;
+    int token_capacity;
+    int current_token_position;
+    Symbol* symbol_table;
+    int symbols_found;
+    int symbol_capacity;
+    int* symbol_slots;      // open-addressing index: symbol_table index + 1, 0 = empty
+    int slot_capacity;      // always a power of two, at least twice symbol_capacity
+    int next_memory_location;
+    ErrorList error_log;
+    RegisterPool register_pool;
+    RegisterAllocation register_allocation;
+    InstructionList instructions;
+    int code_section_emitted;
+    Arena node_arena;
+    CodeBuffer code_output;
+    CodeBuffer object_output;   // raw instruction words for the RAW formats
+    MachineCodeFormat machine_format;
+    bool drop_unused_variables; // --unused drop
+    CompileStats stats;
+    FILE* report_output;
+    const char* error_heading;  // phase of the errors in error_log
+} CompilerContext;
+
+// How the operand fields are packed into the 32-bit word
+typedef enum {
+    FORMAT_R,         // opcode | rs | rt | rd | 0 | function
+    FORMAT_I,         // opcode | rs | rt | immediate
+    FORMAT_MUL_DIV,   // opcode | rs | rt | 0 | subcode | function
+    FORMAT_MOVE_LO,   // opcode | 0 | 0 | rd | 0 | function
+    FORMAT_SHIFT      // opcode | 0 | rt | rd | shift | function
+} InstructionFormat;
 
 typedef struct {
     const char* instruction_name;
     unsigned int opcode_value;
-    unsigned int instruction_format;  
+    InstructionFormat instruction_format;
     unsigned int sub_code;
     unsigned int function_code;
 } Instruction;
 
-Instruction supported_instructions[] = {
-    {"daddiu", 0b011001, 1, 0, 0b000000},
-    {"lb",     0b100000, 1, 0, 0b000000},
-    {"sb",     0b101000, 1, 0, 0b000000},
-    
-    {"daddu",  0b000000, 0, 0b00000, 0b101101},
-    {"dsubu",  0b000000, 0, 0b00000, 0b101111},
-    {"dmulu",  0b000000, 0, 0b00010, 0b011101},
-    {"ddivu",  0b000000, 0, 0b00010, 0b011111},
-    {"mflo",   0b000000, 0, 0b00000, 0b010010}
+const Instruction supported_instructions[INSTRUCTION_COUNT] = {
+    [OP_DADDIU] = {"daddiu", 0b011001, FORMAT_I, 0, 0b000000},
+    [OP_LB]     = {"lb",     0b100000, FORMAT_I, 0, 0b000000},
+    [OP_SB]     = {"sb",     0b101000, FORMAT_I, 0, 0b000000},
+
+    [OP_DADDU]  = {"daddu",  0b000000, FORMAT_R,       0b00000, 0b101101},
+    [OP_DSUBU]  = {"dsubu",  0b000000, FORMAT_R,       0b00000, 0b101111},
+    [OP_DMULU]  = {"dmulu",  0b000000, FORMAT_MUL_DIV, 0b00010, 0b011101},
+    [OP_DDIVU]  = {"ddivu",  0b000000, FORMAT_MUL_DIV, 0b00010, 0b011111},
+    [OP_MFLO]   = {"mflo",   0b000000, FORMAT_MOVE_LO, 0b00000, 0b010010},
+
+    [OP_DSLL]   = {"dsll",   0b000000, FORMAT_SHIFT,   0b00000, 0b111000},
+    [OP_DSRL]   = {"dsrl",   0b000000, FORMAT_SHIFT,   0b00000, 0b111010},
+    [OP_DSLL32] = {"dsll32", 0b000000, FORMAT_SHIFT,   0b00000, 0b111100},
+    [OP_DSRA32] = {"dsra32", 0b000000, FORMAT_SHIFT,   0b00000, 0b111111}
 };
 
-int find_instruction(const char* instruction_name) {
-    int total_instructions = sizeof(supported_instructions) / sizeof(supported_instructions[0]);
-    for (int i = 0; i < total_instructions; i++) {
-        if (strcmp(supported_instructions[i].instruction_name, instruction_name) == 0) {
-            return i;
-        }
+unsigned int create_instruction_code(Opcode opcode, int source_reg,
+                                   int target_reg, int dest_reg, int immediate_value) {
+    const Instruction* inst = &supported_instructions[opcode];
+
+    switch (inst->instruction_format) {
+        case FORMAT_I:
+            return (inst->opcode_value << 26) | (source_reg << 21) |
+                   (target_reg << 16) | (immediate_value & 0xFFFF);
+        case FORMAT_MOVE_LO:
+            return (inst->opcode_value << 26) | (dest_reg << 11) | inst->function_code;
+        case FORMAT_MUL_DIV:
+            return (inst->opcode_value << 26) | (source_reg << 21) | (target_reg << 16) |
+                   (inst->sub_code << 6) | inst->function_code;
+        case FORMAT_SHIFT:
+            // source_reg is 'rt', dest_reg is 'rd' and the immediate is the shift amount
+            return (inst->opcode_value << 26) | (source_reg << 16) | (dest_reg << 11) |
+                   ((immediate_value & 0x1F) << 6) | inst->function_code;
+        default:
+            return (inst->opcode_value << 26) | (source_reg << 21) | (target_reg << 16) |
+                   (dest_reg << 11) | inst->function_code;
     }
-    return -1;
 }
 
-unsigned int create_instruction_code(const char* instruction_name, int source_reg, 
-                                   int target_reg, int dest_reg, int immediate_value) {
-    int instruction_index = find_instruction(instruction_name);
-    if (instruction_index == -1) return 0;
-    
-    Instruction inst = supported_instructions[instruction_index];
-    
-    if (inst.instruction_format == 1) {  
-        unsigned int immediate_16bit = immediate_value & 0xFFFF;
-        return (inst.opcode_value << 26) | (source_reg << 21) | 
-               (target_reg << 16) | immediate_16bit;
-    } else {  
-        if (strcmp(instruction_name, "mflo") == 0) {
-            return (inst.opcode_value << 26) | (dest_reg << 11) | inst.function_code;
-        } else if (strcmp(instruction_name, "dmulu") == 0 || strcmp(instruction_name, "ddivu") == 0) {
-            return (inst.opcode_value << 26) | (source_reg << 21) | (target_reg << 16) |
-                   (inst.sub_code << 6) | inst.function_code;
-        } else {
-            return (inst.opcode_value << 26) | (source_reg << 21) | (target_reg << 16) |
-                   (dest_reg << 11) | inst.function_code;
+bool reserve_code_space(CodeBuffer* buffer, size_t extra) {
+    if (buffer->length + extra <= buffer->capacity) return true;
+    if (buffer->out_of_memory) return false;
+
+    size_t capacity = buffer->capacity ? buffer->capacity : INITIAL_CODE_CAPACITY;
+    while (capacity < buffer->length + extra) capacity *= 2;
+    char* data = realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->out_of_memory = true;
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+void emit_bytes(CodeBuffer* buffer, const char* bytes, size_t length) {
+    if (!length || !reserve_code_space(buffer, length)) return;
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+void emit_code(CodeBuffer* buffer, const char* format, ...) {
+    if (!reserve_code_space(buffer, 64)) return;
+    for (;;) {
+        size_t room = buffer->capacity - buffer->length;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer->data + buffer->length, room, format, args);
+        va_end(args);
+        if (written < 0) return;
+        if ((size_t)written < room) {
+            buffer->length += written;
+            return;
         }
+        if (!reserve_code_space(buffer, (size_t)written + 1)) return;
     }
 }
 
-void display_binary_code(unsigned int value, FILE* output) {
-    fprintf(output, ";");
-    for (int i = 31; i >= 0; i--) {
-        fprintf(output, "%d", (value >> i) & 1);
-        if (i % 4 == 0 && i != 0) fprintf(output, " ");
+void clear_code_buffer(CodeBuffer* buffer) {
+    buffer->length = 0;
+    buffer->out_of_memory = false;
+}
+
+bool write_code_buffer(const CodeBuffer* buffer, FILE* file) {
+    return fwrite(buffer->data, 1, buffer->length, file) == buffer->length;
+}
+
+// Four digits per nibble, so a word is rendered with eight table copies
+static const char nibble_digits[16][4] = {
+    {'0','0','0','0'}, {'0','0','0','1'}, {'0','0','1','0'}, {'0','0','1','1'},
+    {'0','1','0','0'}, {'0','1','0','1'}, {'0','1','1','0'}, {'0','1','1','1'},
+    {'1','0','0','0'}, {'1','0','0','1'}, {'1','0','1','0'}, {'1','0','1','1'},
+    {'1','1','0','0'}, {'1','1','0','1'}, {'1','1','1','0'}, {'1','1','1','1'}
+};
+
+// Emits the whole machine code line (leading space, digits, newline) at once
+void display_binary_code(unsigned int value, CodeBuffer* output) {
+    char line[48] = " ;";
+    int length = sizeof(" ;") - 1;
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        memcpy(line + length, nibble_digits[(value >> shift) & 0xF], 4);
+        length += 4;
+        if (shift) line[length++] = ' ';
     }
+    line[length++] = '\n';
+    emit_bytes(output, line, length);
 }
 
-void produce_machine_code(const char* instruction_name, int source_reg, int target_reg, 
-                         int dest_reg, int immediate_value, FILE* output) {
-    unsigned int machine_instruction = create_instruction_code(instruction_name, source_reg, 
-                                                             target_reg, dest_reg, immediate_value);
-    
-    if (machine_instruction != 0) {
-        fprintf(output, " ");
-        display_binary_code(machine_instruction, output);
-        fprintf(output, "\n");
+void display_hex_code(unsigned int value, CodeBuffer* output) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    char line[24] = " ;" "0x";
+    int length = sizeof(" ;" "0x") - 1;
+    for (int shift = 28; shift >= 0; shift -= 4) line[length++] = hex_digits[(value >> shift) & 0xF];
+    line[length++] = '\n';
+    emit_bytes(output, line, length);
+}
+
+void append_object_word(CodeBuffer* object, unsigned int value, bool big_endian) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) {
+        int shift = big_endian ? 24 - 8 * i : 8 * i;
+        bytes[i] = (unsigned char)(value >> shift);
     }
+    emit_bytes(object, (const char*)bytes, sizeof(bytes));
+}
+
+void render_machine_code(CompilerContext* ctx, const PendingInstruction* instruction, CodeBuffer* output) {
+    unsigned int machine_instruction = create_instruction_code(instruction->opcode, instruction->source_reg,
+                                                             instruction->target_reg, instruction->dest_reg,
+                                                             instruction->immediate_value);
+    if (machine_instruction == 0) return;
+
+    switch (ctx->machine_format) {
+        case MACHINE_CODE_BINARY:
+            display_binary_code(machine_instruction, output);
+            break;
+        case MACHINE_CODE_HEX:
+            display_hex_code(machine_instruction, output);
+            break;
+        case MACHINE_CODE_RAW_LE:
+        case MACHINE_CODE_RAW_BE:
+            append_object_word(&ctx->object_output, machine_instruction,
+                               ctx->machine_format == MACHINE_CODE_RAW_BE);
+            break;
+    }
+}
+
+// Records the instruction whose assembly line was just emitted into output
+// (the context's assembly_text); rendering waits for the peephole pass
+void produce_machine_code(CompilerContext* ctx, Opcode opcode, int source_reg, int target_reg,
+                         int dest_reg, int immediate_value, CodeBuffer* output) {
+    InstructionList* list = &ctx->instructions;
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : INITIAL_INSTRUCTION_CAPACITY;
+        PendingInstruction* items = realloc(list->items, capacity * sizeof(PendingInstruction));
+        if (!items) {
+            output->out_of_memory = true;
+            return;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+
+    size_t line_end = output->length;
+    size_t line_start = line_end ? line_end - 1 : 0;
+    while (line_start > 0 && output->data[line_start - 1] != '\n') line_start--;
+    list->items[list->count++] = (PendingInstruction){
+        opcode, source_reg, target_reg, dest_reg, immediate_value,
+        line_start, line_end - line_start, -1, 0, false
+    };
 }
 
 int get_register_number(const char* register_name) {
@@ -153,36 +424,82 @@ int get_register_number(const char* register_name) {
     return 0;
 }
 
-void free_program_tree(ASTNode* node) {
-    if (!node) return;
-    free_program_tree(node->left_child);
-    free_program_tree(node->right_child);
-    free_program_tree(node->next);
-    free(node);
+void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + 15) & ~(size_t)15;
+
+    while (arena->current && arena->current->used + size > arena->current->capacity) {
+        if (!arena->current->next) break;
+        arena->current = arena->current->next;
+        arena->current->used = 0;
+    }
+
+    if (!arena->current || arena->current->used + size > arena->current->capacity) {
+        size_t capacity = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        ArenaBlock* block = malloc(sizeof(ArenaBlock) + capacity);
+        if (!block) return NULL;
+        block->next = NULL;
+        block->used = 0;
+        block->capacity = capacity;
+        if (arena->current) {
+            block->next = arena->current->next;
+            arena->current->next = block;
+        } else {
+            arena->first = block;
+        }
+        arena->current = block;
+    }
+
+    void* memory = arena->current->data + arena->current->used;
+    arena->current->used += size;
+    return memory;
+}
+
+void arena_reset(Arena* arena) {
+    arena->current = arena->first;
+    if (arena->first) arena->first->used = 0;
+}
+
+void arena_release(Arena* arena) {
+    ArenaBlock* block = arena->first;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = arena->current = NULL;
 }
 
-void record_error(int line_number, const char* message_format, ...) {
-    if (error_log.error_count < MAX_ERRORS) {
+void record_error(CompilerContext* ctx, int line_number, const char* message_format, ...) {
+    if (ctx->error_log.error_count < MAX_ERRORS) {
         va_list args;
         va_start(args, message_format);
-        vsnprintf(error_log.error_messages[error_log.error_count], 256, message_format, args);
-        snprintf(error_log.error_messages[error_log.error_count] + 
-                strlen(error_log.error_messages[error_log.error_count]), 
-                256 - strlen(error_log.error_messages[error_log.error_count]), 
+        vsnprintf(ctx->error_log.error_messages[ctx->error_log.error_count], 256, message_format, args);
+        snprintf(ctx->error_log.error_messages[ctx->error_log.error_count] + 
+                strlen(ctx->error_log.error_messages[ctx->error_log.error_count]), 
+                256 - strlen(ctx->error_log.error_messages[ctx->error_log.error_count]), 
                 " at line %d", line_number);
         va_end(args);
-        error_log.error_count++;
+        ctx->error_log.error_count++;
     }
 }
 
-void display_errors() {
-    for (int i = 0; i < error_log.error_count; i++) {
-        fprintf(stderr, "Error: %s\n", error_log.error_messages[i]);
-        printf("Error: %s\n", error_log.error_messages[i]);
+void display_errors(CompilerContext* ctx) {
+    for (int i = 0; i < ctx->error_log.error_count; i++) {
+        fprintf(stderr, "Error: %s\n", ctx->error_log.error_messages[i]);
+        fprintf(ctx->report_output, "Error: %s\n", ctx->error_log.error_messages[i]);
     }
 }
 
-void setup_registers() {
+// Errors stay in ctx->error_log when report_output is NULL (batch mode
+// prints them itself, prefixed with the source file name)
+void report_errors(CompilerContext* ctx, const char* heading) {
+    ctx->error_heading = heading;
+    if (!ctx->report_output) return;
+    fprintf(ctx->report_output, "%s", heading);
+    display_errors(ctx);
+}
+
+void setup_registers(CompilerContext* ctx) {
     const char* register_names[] = {
         "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
         "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15",
@@ -191,539 +508,753 @@ void setup_registers() {
     };
     
     for (int i = 0; i < 32; i++) {
-        register_pool.available_registers[i] = register_names[i];
+        ctx->register_pool.available_registers[i] = register_names[i];
     }
 
-    register_pool.next_register_index = 1;
-    register_pool.register_count = 32;
-    memset(register_pool.used_registers, 0, sizeof(register_pool.used_registers));
-    register_pool.used_registers[0] = 1;
+    ctx->register_pool.next_register_index = 1;
+    ctx->register_pool.register_count = 32;
+    memset(ctx->register_pool.used_registers, 0, sizeof(ctx->register_pool.used_registers));
+    ctx->register_pool.used_registers[0] = 1;
 }
 
-const char* get_register() {
-    for (int i = 1; i < register_pool.register_count; i++) {
-        if (!register_pool.used_registers[i]) {
-            register_pool.used_registers[i] = 1;
-            return register_pool.available_registers[i];
+const char* get_register(CompilerContext* ctx) {
+    for (int i = 1; i < ctx->register_pool.register_count; i++) {
+        if (!ctx->register_pool.used_registers[i]) {
+            ctx->register_pool.used_registers[i] = 1;
+            return ctx->register_pool.available_registers[i];
         }
     }
+    if (!ctx->register_allocation.out_of_registers) {
+        record_error(ctx, ctx->register_allocation.statement_line, "Expression needs more registers than are free");
+        ctx->register_allocation.out_of_registers = true;
+    }
     return "r31";
 }
 
-void release_register_by_name(const char* reg_name) {
-    for (int i = 0; i < register_pool.register_count; i++) {
-        if (strcmp(register_pool.available_registers[i], reg_name) == 0) {
-            register_pool.used_registers[i] = 0;
+void release_register_by_name(CompilerContext* ctx, const char* reg_name) {
+    for (int i = 0; i < ctx->register_pool.register_count; i++) {
+        if (strcmp(ctx->register_pool.available_registers[i], reg_name) == 0) {
+            ctx->register_pool.used_registers[i] = 0;
             break;
         }
     }
 }
 
-void clear_registers() {
-    memset(register_pool.used_registers, 0, sizeof(register_pool.used_registers));
-    register_pool.used_registers[0] = 1;
+void clear_registers(CompilerContext* ctx) {
+    memset(ctx->register_pool.used_registers, 0, sizeof(ctx->register_pool.used_registers));
+    ctx->register_pool.used_registers[0] = 1;
+}
+
+// Every source byte is classified with one table lookup. Bytes 128-255 are
+// left zero, which is CHAR_OTHER.
+typedef enum {
+    CHAR_OTHER, CHAR_END, CHAR_SPACE, CHAR_NEWLINE,
+    CHAR_LETTER, CHAR_DIGIT, CHAR_QUOTE, CHAR_OPERATOR
+} CharClass;
+
+#define OT CHAR_OTHER
+#define EN CHAR_END
+#define SP CHAR_SPACE
+#define NL CHAR_NEWLINE
+#define LT CHAR_LETTER
+#define DG CHAR_DIGIT
+#define QT CHAR_QUOTE
+#define OP CHAR_OPERATOR
+static const unsigned char char_classes[256] = {
+    EN, OT, OT, OT, OT, OT, OT, OT, OT, SP, NL, OT, OT, SP, OT, OT,
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    SP, OT, OT, OT, OT, OT, OT, QT, OP, OP, OP, OP, OP, OP, OT, OP,
+    DG, DG, DG, DG, DG, DG, DG, DG, DG, DG, OT, OP, OT, OP, OT, OT,
+    OT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT,
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, OT, OT, OT, OT, LT,
+    OT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT,
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, OT, OT, OT, OT, OT,
+};
+#undef OT
+#undef EN
+#undef SP
+#undef NL
+#undef LT
+#undef DG
+#undef QT
+#undef OP
+
+#define CHAR_CLASS(c) ((CharClass)char_classes[(unsigned char)(c)])
+
+// Operator DFA: the first byte selects a row, and the second byte either
+// doubles it ("++"), adds '=' ("+=") or ends the token. END_OF_FILE (0)
+// marks a missing transition.
+typedef struct {
+    TokenType single;
+    TokenType doubled;
+    TokenType with_assign;
+} OperatorTransition;
+
+static const OperatorTransition operator_transitions[256] = {
+    ['+'] = {PLUS, INCREMENT, PLUS_ASSIGN},
+    ['-'] = {MINUS, DECREMENT, MINUS_ASSIGN},
+    ['*'] = {MULTIPLY, END_OF_FILE, MULTIPLY_ASSIGN},
+    ['/'] = {DIVIDE, END_OF_FILE, DIVIDE_ASSIGN},
+    ['='] = {ASSIGN, END_OF_FILE, END_OF_FILE},
+    [';'] = {SEMICOLON, END_OF_FILE, END_OF_FILE},
+    ['('] = {LEFT_PAREN, END_OF_FILE, END_OF_FILE},
+    [')'] = {RIGHT_PAREN, END_OF_FILE, END_OF_FILE},
+    [','] = {COMMA, END_OF_FILE, END_OF_FILE},
+};
+
+// Block scanners for the whitespace/comment skipper. A block is loaded and
+// compared against a byte, giving one mask bit per matching byte. Loads
+// never go past source_length, so the remaining tail is always finished
+// by the scalar loops below (which are also the whole implementation when
+// no vector unit is available).
+#if defined(__AVX2__)
+#define SCAN_WIDTH 32
+#define SCAN_FULL_MASK 0xFFFFFFFFu
+typedef __m256i ScanBlock;
+
+static inline ScanBlock load_scan_block(const char* bytes) {
+    return _mm256_loadu_si256((const __m256i*)bytes);
+}
+
+static inline unsigned int match_scan_byte(ScanBlock block, char byte) {
+    return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(byte)));
+}
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCAN_WIDTH 16
+#define SCAN_FULL_MASK 0xFFFFu
+typedef __m128i ScanBlock;
+
+static inline ScanBlock load_scan_block(const char* bytes) {
+    return _mm_loadu_si128((const __m128i*)bytes);
+}
+
+static inline unsigned int match_scan_byte(ScanBlock block, char byte) {
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(byte)));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define SCAN_WIDTH 16
+#define SCAN_FULL_MASK 0xFFFFu
+typedef uint8x16_t ScanBlock;
+
+static inline ScanBlock load_scan_block(const char* bytes) {
+    return vld1q_u8((const uint8_t*)bytes);
+}
+
+// NEON has no movemask, so weight each lane by its bit and add up each half
+static inline unsigned int match_scan_byte(ScanBlock block, char byte) {
+    static const uint8_t lane_bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t bits = vandq_u8(vceqq_u8(block, vdupq_n_u8((uint8_t)byte)), vld1q_u8(lane_bits));
+    return vaddv_u8(vget_low_u8(bits)) | ((unsigned int)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+#else
+#define SCAN_WIDTH 0
+#endif
+
+#if SCAN_WIDTH
+#if defined(_MSC_VER) && !defined(__clang__)
+static inline int lowest_set_bit(unsigned int mask) {
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+}
+
+static inline int count_set_bits(unsigned int mask) {
+    return (int)__popcnt(mask);
+}
+#else
+static inline int lowest_set_bit(unsigned int mask) {
+    return __builtin_ctz(mask);
+}
+
+static inline int count_set_bits(unsigned int mask) {
+    return __builtin_popcount(mask);
+}
+#endif
+#endif
+
+// Returns the first position at or after pos that is not ' ', '\t', '\r' or
+// '\n', adding the newlines passed over to *line
+int skip_blank_bytes(const char* source_code, int pos, int source_length, int* line) {
+#if SCAN_WIDTH
+    while (pos + SCAN_WIDTH <= source_length) {
+        ScanBlock block = load_scan_block(source_code + pos);
+        unsigned int newlines = match_scan_byte(block, '\n');
+        unsigned int blanks = newlines | match_scan_byte(block, ' ') |
+                              match_scan_byte(block, '\t') | match_scan_byte(block, '\r');
+        unsigned int stops = ~blanks & SCAN_FULL_MASK;
+        if (stops) {
+            int offset = lowest_set_bit(stops);
+            *line += count_set_bits(newlines & ((1u << offset) - 1));
+            return pos + offset;
+        }
+        *line += count_set_bits(newlines);
+        pos += SCAN_WIDTH;
+    }
+#endif
+    for (;;) {
+        CharClass char_class = CHAR_CLASS(source_code[pos]);
+        if (char_class == CHAR_NEWLINE) (*line)++;
+        else if (char_class != CHAR_SPACE) return pos;
+        pos++;
+    }
+}
+
+// Returns the position of the newline ending a '//' comment, or of the
+// terminating '\0'
+int find_line_end(const char* source_code, int pos, int source_length) {
+#if SCAN_WIDTH
+    while (pos + SCAN_WIDTH <= source_length) {
+        unsigned int newlines = match_scan_byte(load_scan_block(source_code + pos), '\n');
+        if (newlines) return pos + lowest_set_bit(newlines);
+        pos += SCAN_WIDTH;
+    }
+#endif
+    while (source_code[pos] != '\0' && source_code[pos] != '\n') pos++;
+    return pos;
+}
+
+// Inside a block comment only '*' and '/' can change the nesting depth.
+// Returns the next one of those (or the '\0'), counting newlines on the way.
+int find_comment_marker(const char* source_code, int pos, int source_length, int* line) {
+#if SCAN_WIDTH
+    while (pos + SCAN_WIDTH <= source_length) {
+        ScanBlock block = load_scan_block(source_code + pos);
+        unsigned int newlines = match_scan_byte(block, '\n');
+        unsigned int markers = match_scan_byte(block, '*') | match_scan_byte(block, '/');
+        if (markers) {
+            int offset = lowest_set_bit(markers);
+            *line += count_set_bits(newlines & ((1u << offset) - 1));
+            return pos + offset;
+        }
+        *line += count_set_bits(newlines);
+        pos += SCAN_WIDTH;
+    }
+#endif
+    while (source_code[pos] != '\0' && source_code[pos] != '*' && source_code[pos] != '/') {
+        if (source_code[pos] == '\n') (*line)++;
+        pos++;
+    }
+    return pos;
 }
 
 bool IS_WHITESPACE(char c) {
-    return ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r');
+    return CHAR_CLASS(c) == CHAR_SPACE || CHAR_CLASS(c) == CHAR_NEWLINE;
 }
 
 bool IS_LETTER(char c) {
-    return (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || (c) == '_');
+    return CHAR_CLASS(c) == CHAR_LETTER;
 }
 
 bool IS_DIGIT(char c) {
-    return ((c) >= '0' && (c) <= '9');
+    return CHAR_CLASS(c) == CHAR_DIGIT;
 }
 
 bool IS_ALPHANUMERIC(char c) {
-    return (IS_LETTER(c) || IS_DIGIT(c));
+    return CHAR_CLASS(c) == CHAR_LETTER || CHAR_CLASS(c) == CHAR_DIGIT;
 }
 
-TokenType identify_keyword(const char* word) {
-    if (strcmp(word, "int") == 0) return INT_KEYWORD;
-    if (strcmp(word, "char") == 0) return CHAR_KEYWORD;
+// The keywords all have different lengths, so the length is a perfect hash
+// and one memcmp settles it
+typedef struct {
+    const char* text;
+    TokenType type;
+} Keyword;
+
+static const Keyword keywords_by_length[] = {
+    [3] = {"int", INT_KEYWORD},
+    [4] = {"char", CHAR_KEYWORD},
+};
+
+TokenType identify_keyword(const char* word, int length) {
+    if (length >= (int)(sizeof(keywords_by_length) / sizeof(keywords_by_length[0]))) return IDENTIFIER;
+    const Keyword* keyword = &keywords_by_length[length];
+    if (keyword->text && memcmp(word, keyword->text, length) == 0) return keyword->type;
     return IDENTIFIER;
 }
 
-void save_token(TokenType type, const char* text_value, int line_number) {
-    if (current_token_count < MAX_TOKENS) {
-        all_tokens[current_token_count].type = type;
-        all_tokens[current_token_count].line_number = line_number;
-        strncpy(all_tokens[current_token_count].text, text_value, MAX_NAME_LENGTH - 1);
-        all_tokens[current_token_count].text[MAX_NAME_LENGTH - 1] = '\0';
-        current_token_count++;
-    } else {
-        record_error(line_number, "Too many tokens in program");
+void save_token(CompilerContext* ctx, TokenType type, const char* text, int length, int line_number) {
+    if (ctx->current_token_count == ctx->token_capacity) {
+        int capacity = ctx->token_capacity ? ctx->token_capacity * 2 : INITIAL_TOKEN_CAPACITY;
+        Token* tokens = realloc(ctx->all_tokens, capacity * sizeof(Token));
+        if (!tokens) {
+            record_error(ctx, line_number, "Too many tokens in program");
+            return;
+        }
+        ctx->all_tokens = tokens;
+        ctx->token_capacity = capacity;
     }
+    ctx->all_tokens[ctx->current_token_count++] = (Token){type, text, length, line_number};
 }
 
-void skip_spaces_and_comments(const char* source_code, int* position, int* current_line) {
-    while (source_code[*position] != '\0') {
-        if (IS_WHITESPACE(source_code[*position])) {
-            if (source_code[*position] == '\n') (*current_line)++;
-            (*position)++;
-        } else if (source_code[*position] == '/' && source_code[*position + 1] == '/') {
-            *position += 2;
-            while (source_code[*position] != '\0' && source_code[*position] != '\n') {
-                (*position)++;
-            }
-            if (source_code[*position] == '\n') {
-                (*current_line)++;
-                (*position)++;
-            }
-        } else if (source_code[*position] == '/' && source_code[*position + 1] == '*') {
-            *position += 2;
+void skip_spaces_and_comments(CompilerContext* ctx, const char* source_code, int source_length, int* position, int* current_line) {
+    int pos = *position;
+    int line = *current_line;
+
+    for (;;) {
+        pos = skip_blank_bytes(source_code, pos, source_length, &line);
+        if (source_code[pos] == '/' && source_code[pos + 1] == '/') {
+            pos = find_line_end(source_code, pos + 2, source_length);
+        } else if (source_code[pos] == '/' && source_code[pos + 1] == '*') {
+            pos += 2;
             int comment_depth = 1;
-            
-            while (source_code[*position] != '\0' && comment_depth > 0) {
-                if (source_code[*position] == '\n') {
-                    (*current_line)++;
-                } else if (source_code[*position] == '/' && source_code[*position + 1] == '*') {
+
+            while (comment_depth > 0) {
+                pos = find_comment_marker(source_code, pos, source_length, &line);
+                if (source_code[pos] == '\0') break;
+                if (source_code[pos] == '/' && source_code[pos + 1] == '*') {
                     comment_depth++;
-                    *position += 2;
-                    continue;
-                } else if (source_code[*position] == '*' && source_code[*position + 1] == '/') {
+                    pos += 2;
+                } else if (source_code[pos] == '*' && source_code[pos + 1] == '/') {
                     comment_depth--;
-                    *position += 2;
-                    continue;
+                    pos += 2;
+                } else {
+                    pos++;
                 }
-                (*position)++;
             }
-            
+
             if (comment_depth > 0) {
-                record_error(*current_line, "Unterminated multi-line comment");
+                record_error(ctx, line, "Unterminated multi-line comment");
                 break;
             }
         } else {
             break;
         }
     }
+
+    *position = pos;
+    *current_line = line;
 }
 
-void break_into_tokens(const char* source_code) {
+void break_into_tokens(CompilerContext* ctx, const char* source_code) {
+    int source_length = (int)strlen(source_code);
     int position = 0;
     int current_line = 1;
-    
-    while (source_code[position] != '\0') {
-        skip_spaces_and_comments(source_code, &position, &current_line);
-        if (source_code[position] == '\0') break;
-        
-        if (source_code[position] == '\'') {
-            position++;
-            char char_buffer[4] = {0};
-            int char_value = 0;
-            
-            if (source_code[position] == '\\') {
-                position++;
-                switch (source_code[position]) {
-                    case 'n': char_value = '\n'; break;
-                    case 't': char_value = '\t'; break;
-                    case 'r': char_value = '\r'; break;
-                    case '0': char_value = '\0'; break;
-                    case '\\': char_value = '\\'; break;
-                    case '\'': char_value = '\''; break;
-                    default: 
-                        char_value = source_code[position]; 
-                        record_error(current_line, "Unknown escape sequence '\\%c'", source_code[position]);
-                        break;
-                }
-                position++;
-            } else {
-                char_value = (unsigned char)source_code[position];
-                position++;
+
+    for (;;) {
+        skip_spaces_and_comments(ctx, source_code, source_length, &position, &current_line);
+        char current = source_code[position];
+
+        switch (CHAR_CLASS(current)) {
+            case CHAR_END:
+                save_token(ctx, END_OF_FILE, "", 0, current_line);
+                return;
+
+            case CHAR_LETTER: {
+                int start = position;
+                while (IS_ALPHANUMERIC(source_code[position])) position++;
+                int length = position - start;
+                save_token(ctx, identify_keyword(source_code + start, length), source_code + start, length, current_line);
+                break;
             }
-            
-            if (source_code[position] == '\'') {
+
+            case CHAR_DIGIT: {
+                int start = position;
+                while (IS_DIGIT(source_code[position])) position++;
+                save_token(ctx, NUMBER, source_code + start, position - start, current_line);
+                break;
+            }
+
+            case CHAR_QUOTE: {
                 position++;
-                char num_str[16];
-                snprintf(num_str, sizeof(num_str), "%d", char_value);
-                save_token(CHAR_LITERAL, num_str, current_line);
-            } else {
-                record_error(current_line, "Unterminated character literal");
-                while (source_code[position] != '\0' && source_code[position] != '\'' && source_code[position] != '\n') {
+                int char_value = 0;
+
+                if (source_code[position] == '\\') {
+                    position++;
+                    switch (source_code[position]) {
+                        case 'n': char_value = '\n'; break;
+                        case 't': char_value = '\t'; break;
+                        case 'r': char_value = '\r'; break;
+                        case '0': char_value = '\0'; break;
+                        case '\\': char_value = '\\'; break;
+                        case '\'': char_value = '\''; break;
+                        default:
+                            char_value = source_code[position];
+                            record_error(ctx, current_line, "Unknown escape sequence '\\%c'", source_code[position]);
+                            break;
+                    }
+                    position++;
+                } else {
+                    char_value = (unsigned char)source_code[position];
                     position++;
                 }
-                if (source_code[position] == '\'') position++;
-            }
-            continue;
-        }
 
-        if (source_code[position] == '-' && IS_DIGIT(source_code[position + 1])) {          
-            bool is_unary_minus = false;
-            if (position > 0) {
-                char prev_char = source_code[position - 1];
-                is_unary_minus = IS_LETTER(prev_char) || IS_DIGIT(prev_char) || prev_char == ')' || prev_char == ']';
-            }
-            
-            if (!is_unary_minus) {
-                char number_buffer[MAX_NAME_LENGTH] = {0};
-                int buffer_index = 0;
-                
-                number_buffer[buffer_index++] = source_code[position++];
-                
-                while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                    number_buffer[buffer_index++] = source_code[position++];
+                if (source_code[position] == '\'') {
+                    position++;
+                    char* value_text = arena_alloc(&ctx->node_arena, 16);
+                    if (!value_text) {
+                        record_error(ctx, current_line, "Memory allocation failed");
+                        break;
+                    }
+                    int value_length = snprintf(value_text, 16, "%d", char_value);
+                    save_token(ctx, CHAR_LITERAL, value_text, value_length, current_line);
+                } else {
+                    record_error(ctx, current_line, "Unterminated character literal");
+                    while (source_code[position] != '\0' && source_code[position] != '\'' && source_code[position] != '\n') {
+                        position++;
+                    }
+                    if (source_code[position] == '\'') position++;
                 }
-                save_token(NUMBER, number_buffer, current_line);
-                continue;
+                break;
             }
-        }
 
-        if (source_code[position] == '+' && IS_DIGIT(source_code[position + 1])) {
-            bool is_unary_plus = false;
-            if (position > 0) {
-                char prev_char = source_code[position - 1];
-                is_unary_plus = IS_LETTER(prev_char) || IS_DIGIT(prev_char) || prev_char == ')' || prev_char == ']';
-            }
-            
-            if (!is_unary_plus) {
-                char number_buffer[MAX_NAME_LENGTH] = {0};
-                int buffer_index = 0;
-                position++; 
-                
-                while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                    number_buffer[buffer_index++] = source_code[position++];
+            case CHAR_OPERATOR: {
+                // A sign directly in front of a digit is part of the number,
+                // unless it follows an operand and is really a binary operator
+                if ((current == '-' || current == '+') && IS_DIGIT(source_code[position + 1])) {
+                    bool follows_operand = false;
+                    if (position > 0) {
+                        char prev_char = source_code[position - 1];
+                        follows_operand = IS_ALPHANUMERIC(prev_char) || prev_char == ')' || prev_char == ']';
+                    }
+
+                    if (!follows_operand) {
+                        // '+5' is stored as '5', '-5' keeps its sign
+                        int start = current == '+' ? ++position : position++;
+                        while (IS_DIGIT(source_code[position])) position++;
+                        save_token(ctx, NUMBER, source_code + start, position - start, current_line);
+                        break;
+                    }
                 }
-                save_token(NUMBER, number_buffer, current_line);
-                continue;
-            }
-        }
-        
-        if (IS_DIGIT(source_code[position])) {
-            char number_buffer[MAX_NAME_LENGTH] = {0};
-            int buffer_index = 0;
-            
-            while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                number_buffer[buffer_index++] = source_code[position++];
-            }
-            save_token(NUMBER, number_buffer, current_line);
-            continue;
-        }
-        
-        if (IS_LETTER(source_code[position])) {
-            char word_buffer[MAX_NAME_LENGTH] = {0};
-            int buffer_index = 0;
-            
-            while (IS_ALPHANUMERIC(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                word_buffer[buffer_index++] = source_code[position++];
+
+                const OperatorTransition* transition = &operator_transitions[(unsigned char)current];
+                char next = source_code[position + 1];
+                TokenType type = transition->single;
+                int length = 1;
+                if (next == current && transition->doubled != END_OF_FILE) {
+                    type = transition->doubled;
+                    length = 2;
+                } else if (next == '=' && transition->with_assign != END_OF_FILE) {
+                    type = transition->with_assign;
+                    length = 2;
+                }
+                save_token(ctx, type, source_code + position, length, current_line);
+                position += length;
+                break;
             }
-            save_token(identify_keyword(word_buffer), word_buffer, current_line);
-            continue;
-        }
-        
-        if (source_code[position] == '+' && source_code[position + 1] == '+') {
-            save_token(INCREMENT, "++", current_line);
-            position += 2;
-            continue;
-        }
-        if (source_code[position] == '-' && source_code[position + 1] == '-') {
-            save_token(DECREMENT, "--", current_line);
-            position += 2;
-            continue;
-        }
-        if (source_code[position] == '+' && source_code[position + 1] == '=') {
-            save_token(PLUS_ASSIGN, "+=", current_line);
-            position += 2;
-            continue;
-        }
-        if (source_code[position] == '-' && source_code[position + 1] == '=') {
-            save_token(MINUS_ASSIGN, "-=", current_line);
-            position += 2;
-            continue;
-        }
-        if (source_code[position] == '*' && source_code[position + 1] == '=') {
-            save_token(MULTIPLY_ASSIGN, "*=", current_line);
-            position += 2;
-            continue;
-        }
-        if (source_code[position] == '/' && source_code[position + 1] == '=') {
-            save_token(DIVIDE_ASSIGN, "/=", current_line);
-            position += 2;
-            continue;
-        }
-        
-        switch (source_code[position]) {
-            case '+': save_token(PLUS, "+", current_line); position++; break;
-            case '-': save_token(MINUS, "-", current_line); position++; break;
-            case '*': save_token(MULTIPLY, "*", current_line); position++; break;
-            case '/': save_token(DIVIDE, "/", current_line); position++; break;
-            case '=': save_token(ASSIGN, "=", current_line); position++; break;
-            case ';': save_token(SEMICOLON, ";", current_line); position++; break;
-            case '(': save_token(LEFT_PAREN, "(", current_line); position++; break;
-            case ')': save_token(RIGHT_PAREN, ")", current_line); position++; break;
-            case ',': save_token(COMMA, ",", current_line); position++; break;
-            default: { 
-                char unknown_char[2] = {source_code[position], '\0'};
-                save_token(UNKNOWN_TOKEN, unknown_char, current_line);
-                record_error(current_line, "Unexpected character '%c'", source_code[position]);
+
+            default:
+                save_token(ctx, UNKNOWN_TOKEN, source_code + position, 1, current_line);
+                record_error(ctx, current_line, "Unexpected character '%c'", current);
                 position++;
                 break;
-            } 
         }
     }
-    save_token(END_OF_FILE, "", current_line);
 }
 
-Symbol* find_variable(const char* variable_name) {
-    for (int i = 0; i < symbols_found; i++) {
-        if (strcmp(symbol_table[i].name, variable_name) == 0) {
-            return &symbol_table[i];
+unsigned int hash_name(const char* name, int length) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+Symbol* find_variable(CompilerContext* ctx, Token variable_name) {
+    if (!ctx->slot_capacity) return NULL;
+
+    unsigned int hash = hash_name(variable_name.text, variable_name.length);
+    unsigned int mask = ctx->slot_capacity - 1;
+    for (unsigned int slot = hash & mask; ctx->symbol_slots[slot]; slot = (slot + 1) & mask) {
+        Symbol* symbol = &ctx->symbol_table[ctx->symbol_slots[slot] - 1];
+        if (symbol->name_hash == hash && symbol->name_length == variable_name.length &&
+            memcmp(symbol->name, variable_name.text, variable_name.length) == 0) {
+            return symbol;
         }
     }
     return NULL;
 }
 
-bool add_variable(const char* variable_name, int line_number) {
-    if (symbols_found >= MAX_SYMBOLS) {
-        record_error(line_number, "Too many variables declared");
+bool grow_symbol_table(CompilerContext* ctx) {
+    int capacity = ctx->symbol_capacity ? ctx->symbol_capacity * 2 : INITIAL_SYMBOL_CAPACITY;
+    Symbol* symbols = realloc(ctx->symbol_table, capacity * sizeof(Symbol));
+    if (!symbols) return false;
+    ctx->symbol_table = symbols;
+    ctx->symbol_capacity = capacity;
+
+    int* slots = calloc(capacity * 2, sizeof(int));
+    if (!slots) return false;
+    free(ctx->symbol_slots);
+    ctx->symbol_slots = slots;
+    ctx->slot_capacity = capacity * 2;
+
+    unsigned int mask = ctx->slot_capacity - 1;
+    for (int i = 0; i < ctx->symbols_found; i++) {
+        unsigned int slot = ctx->symbol_table[i].name_hash & mask;
+        while (ctx->symbol_slots[slot]) slot = (slot + 1) & mask;
+        ctx->symbol_slots[slot] = i + 1;
+    }
+    return true;
+}
+
+bool add_variable(CompilerContext* ctx, Token variable_name) {
+    if (find_variable(ctx, variable_name) != NULL) {
+        record_error(ctx, variable_name.line_number, "Variable '%.*s' is already declared",
+                     variable_name.length, variable_name.text);
         return false;
     }
-    
-    if (find_variable(variable_name) != NULL) {
-        record_error(line_number, "Variable '%s' is already declared", variable_name);
+
+    if (ctx->next_memory_location + 8 > DATA_SEGMENT_LIMIT) {
+        record_error(ctx, variable_name.line_number, "Too many variables for r0-relative addressing");
+        return false;
+    }
+    if (ctx->symbols_found == ctx->symbol_capacity && !grow_symbol_table(ctx)) {
+        record_error(ctx, variable_name.line_number, "Too many variables declared");
         return false;
     }
     
-    symbol_table[symbols_found] = (Symbol){{0}, 0, 0, next_memory_location, 4};
-    strncpy(symbol_table[symbols_found].name, variable_name, MAX_NAME_LENGTH - 1);
-    symbols_found++;
-    next_memory_location += 8;
+    Symbol* symbol = &ctx->symbol_table[ctx->symbols_found];
+    *symbol = (Symbol){
+        .name = variable_name.text,
+        .name_length = variable_name.length,
+        .name_hash = hash_name(variable_name.text, variable_name.length),
+        .is_initialized = 0,
+        .is_used = 0,
+        .memory_location = ctx->next_memory_location,
+        .size = 4,
+        .live_range = -1,
+        .home_register = 0,
+        .is_dirty = false,
+        .is_normalized = false,
+    };
+
+    unsigned int mask = ctx->slot_capacity - 1;
+    unsigned int slot = symbol->name_hash & mask;
+    while (ctx->symbol_slots[slot]) slot = (slot + 1) & mask;
+    ctx->symbol_slots[slot] = ctx->symbols_found + 1;
+
+    ctx->symbols_found++;
+    ctx->next_memory_location += 8;
     return true;
 }
 
-void mark_variable_initialized(const char* variable_name) {
-    Symbol* variable = find_variable(variable_name);
+void mark_variable_initialized(CompilerContext* ctx, Token variable_name) {
+    Symbol* variable = find_variable(ctx, variable_name);
     if (variable) variable->is_initialized = 1;
 }
 
-void mark_variable_used(const char* variable_name) {
-    Symbol* variable = find_variable(variable_name);
+void mark_variable_used(CompilerContext* ctx, Token variable_name) {
+    Symbol* variable = find_variable(ctx, variable_name);
     if (variable) variable->is_used = 1;
 }
 
-Token get_next_token() {
-    return (current_token_position < current_token_count) ? 
-           all_tokens[current_token_position++] : all_tokens[current_token_count - 1];
+Token get_next_token(CompilerContext* ctx) {
+    return (ctx->current_token_position < ctx->current_token_count) ? 
+           ctx->all_tokens[ctx->current_token_position++] : ctx->all_tokens[ctx->current_token_count - 1];
 }
 
-Token peek_next_token() {
-    return (current_token_position < current_token_count) ? 
-           all_tokens[current_token_position] : all_tokens[current_token_count - 1];
+Token peek_next_token(CompilerContext* ctx) {
+    return (ctx->current_token_position < ctx->current_token_count) ? 
+           ctx->all_tokens[ctx->current_token_position] : ctx->all_tokens[ctx->current_token_count - 1];
 }
 
-bool expect_token(TokenType expected_type, const char* expected_text) {
-    Token next_token = peek_next_token();
+bool expect_token(CompilerContext* ctx, TokenType expected_type, const char* expected_text) {
+    Token next_token = peek_next_token(ctx);
     if (next_token.type != expected_type) {
-        record_error(next_token.line_number, "Expected '%s'", expected_text);
+        record_error(ctx, next_token.line_number, "Expected '%s'", expected_text);
         return false;
     }
-    get_next_token();
+    get_next_token(ctx);
     return true;
 }
 
-ASTNode* create_tree_node(ASTNodeType node_type, Token token_data, 
+ASTNode* create_tree_node(CompilerContext* ctx, ASTNodeType node_type, Token token_data, 
                          ASTNode* left_child, ASTNode* right_child) {
-    ASTNode* new_node = malloc(sizeof(ASTNode));
+    ASTNode* new_node = arena_alloc(&ctx->node_arena, sizeof(ASTNode));
     if (!new_node) {
-        record_error(token_data.line_number, "Memory allocation failed");
+        record_error(ctx, token_data.line_number, "Memory allocation failed");
         return NULL;
     }
     *new_node = (ASTNode){node_type, token_data, left_child, right_child, NULL};
+    ctx->stats.ast_nodes++;
     return new_node;
 }
 
-ASTNode* parse_expression();
-ASTNode* parse_term();
-ASTNode* parse_factor();
-ASTNode* parse_unary_expression();
-ASTNode* parse_postfix_expression();
-ASTNode* parse_primary_expression();
-ASTNode* parse_multiplicative_expression();
-ASTNode* parse_additive_expression();
-
-ASTNode* parse_unary_expression() {
-    Token current_token = peek_next_token();
+ASTNode* parse_expression(CompilerContext* ctx);
+ASTNode* parse_term(CompilerContext* ctx);
+ASTNode* parse_factor(CompilerContext* ctx);
+ASTNode* parse_unary_expression(CompilerContext* ctx);
+ASTNode* parse_postfix_expression(CompilerContext* ctx);
+ASTNode* parse_primary_expression(CompilerContext* ctx);
+ASTNode* parse_multiplicative_expression(CompilerContext* ctx);
+ASTNode* parse_additive_expression(CompilerContext* ctx);
+
+ASTNode* parse_unary_expression(CompilerContext* ctx) {
+    Token current_token = peek_next_token(ctx);
     
     if (current_token.type == PLUS || current_token.type == MINUS) {
-        Token operator_token = get_next_token();
-        ASTNode* operand = parse_unary_expression();
+        Token operator_token = get_next_token(ctx);
+        ASTNode* operand = parse_unary_expression(ctx);
         
         if (!operand) {
-            record_error(operator_token.line_number, "Expected expression after unary operator");
+            record_error(ctx, operator_token.line_number, "Expected expression after unary operator");
             return NULL;
         }
         
-        return create_tree_node(UNARY_NODE, operator_token, operand, NULL);
+        return create_tree_node(ctx, UNARY_NODE, operator_token, operand, NULL);
     }
     
     if (current_token.type == INCREMENT || current_token.type == DECREMENT) {
-        Token operator_token = get_next_token();
+        Token operator_token = get_next_token(ctx);
         
-        ASTNode* operand = parse_primary_expression();
+        ASTNode* operand = parse_primary_expression(ctx);
         
         if (!operand) {
-            record_error(operator_token.line_number, "Expected variable after prefix operator");
+            record_error(ctx, operator_token.line_number, "Expected variable after prefix operator");
             return NULL;
         }
         
         if (operand->node_type != VARIABLE_NODE) {
-            record_error(operator_token.line_number, "Prefix operator requires a variable");
-            free_program_tree(operand);
+            record_error(ctx, operator_token.line_number, "Prefix operator requires a variable");
             return NULL;
         }
         
-        return create_tree_node(UNARY_NODE, operator_token, operand, NULL);
+        return create_tree_node(ctx, UNARY_NODE, operator_token, operand, NULL);
     }
     
-    return parse_postfix_expression();
+    return parse_postfix_expression(ctx);
 }
 
-ASTNode* parse_primary_expression() {
-    Token current_token = peek_next_token();
+ASTNode* parse_primary_expression(CompilerContext* ctx) {
+    Token current_token = peek_next_token(ctx);
     
     if (current_token.type == NUMBER) {
-        Token token = get_next_token();
-        return create_tree_node(NUMBER_NODE, token, NULL, NULL);
+        Token token = get_next_token(ctx);
+        return create_tree_node(ctx, NUMBER_NODE, token, NULL, NULL);
     } else if (current_token.type == CHAR_LITERAL) {
-        Token token = get_next_token();
-        return create_tree_node(CHAR_NODE, token, NULL, NULL);
+        Token token = get_next_token(ctx);
+        return create_tree_node(ctx, CHAR_NODE, token, NULL, NULL);
     } else if (current_token.type == IDENTIFIER) {
-        Token token = get_next_token();
-        mark_variable_used(token.text);
-        return create_tree_node(VARIABLE_NODE, token, NULL, NULL);
+        Token token = get_next_token(ctx);
+        mark_variable_used(ctx, token);
+        return create_tree_node(ctx, VARIABLE_NODE, token, NULL, NULL);
     }
     
     if (current_token.type == LEFT_PAREN) {
-        get_next_token();
-        ASTNode* expression = parse_expression();
+        get_next_token(ctx);
+        ASTNode* expression = parse_expression(ctx);
         if (!expression) return NULL;
         
-        if (!expect_token(RIGHT_PAREN, ")")) {
-            free_program_tree(expression);
+        if (!expect_token(ctx, RIGHT_PAREN, ")")) {
             return NULL;
         }
         return expression;
     }
     
-    record_error(current_token.line_number, "Expected expression");
+    record_error(ctx, current_token.line_number, "Expected expression");
     return NULL;
 }
 
-ASTNode* parse_postfix_expression() {
-    ASTNode* left_side = parse_primary_expression();
+ASTNode* parse_postfix_expression(CompilerContext* ctx) {
+    ASTNode* left_side = parse_primary_expression(ctx);
     if (!left_side) return NULL;
     
-    Token next_token = peek_next_token();
+    Token next_token = peek_next_token(ctx);
     if ((next_token.type == INCREMENT || next_token.type == DECREMENT) && 
         left_side->node_type == VARIABLE_NODE) {
-        Token operator_token = get_next_token();
+        Token operator_token = get_next_token(ctx);
         
-        ASTNode* operation_node = create_tree_node(UNARY_NODE, operator_token, left_side, NULL);
+        ASTNode* operation_node = create_tree_node(ctx, UNARY_NODE, operator_token, left_side, NULL);
         return operation_node;
     }
     
     return left_side;
 }
 
-ASTNode* parse_multiplicative_expression() {
-    ASTNode* left_side = parse_unary_expression();
+ASTNode* parse_multiplicative_expression(CompilerContext* ctx) {
+    ASTNode* left_side = parse_unary_expression(ctx);
     if (!left_side) return NULL;
     
-    while (peek_next_token().type == MULTIPLY || peek_next_token().type == DIVIDE) {
-        Token operator_token = get_next_token();
-        ASTNode* right_side = parse_unary_expression();
+    while (peek_next_token(ctx).type == MULTIPLY || peek_next_token(ctx).type == DIVIDE) {
+        Token operator_token = get_next_token(ctx);
+        ASTNode* right_side = parse_unary_expression(ctx);
         
         if (!right_side) {
-            free_program_tree(left_side);
             return NULL;
         }
         
-        left_side = create_tree_node(OPERATION_NODE, operator_token, left_side, right_side);
+        left_side = create_tree_node(ctx, OPERATION_NODE, operator_token, left_side, right_side);
         if (!left_side) {
-            free_program_tree(right_side);
             return NULL;
         }
     }
     return left_side;
 }
 
-ASTNode* parse_additive_expression() {
-    ASTNode* left_side = parse_multiplicative_expression();
+ASTNode* parse_additive_expression(CompilerContext* ctx) {
+    ASTNode* left_side = parse_multiplicative_expression(ctx);
     if (!left_side) return NULL;
     
-    while (peek_next_token().type == PLUS || peek_next_token().type == MINUS) {
-        Token operator_token = get_next_token();
-        ASTNode* right_side = parse_multiplicative_expression();
+    while (peek_next_token(ctx).type == PLUS || peek_next_token(ctx).type == MINUS) {
+        Token operator_token = get_next_token(ctx);
+        ASTNode* right_side = parse_multiplicative_expression(ctx);
         
         if (!right_side) {
-            free_program_tree(left_side);
             return NULL;
         }
         
-        left_side = create_tree_node(OPERATION_NODE, operator_token, left_side, right_side);
+        left_side = create_tree_node(ctx, OPERATION_NODE, operator_token, left_side, right_side);
         if (!left_side) {
-            free_program_tree(right_side);
             return NULL;
         }
     }
     return left_side;
 }
 
-ASTNode* parse_expression() {
-    return parse_additive_expression();
+ASTNode* parse_expression(CompilerContext* ctx) {
+    return parse_additive_expression(ctx);
 }
 
-ASTNode* parse_assignment() {
-    Token variable_token = get_next_token();
+ASTNode* parse_assignment(CompilerContext* ctx) {
+    Token variable_token = get_next_token(ctx);
     if (variable_token.type != IDENTIFIER) {
-        record_error(variable_token.line_number, "Expected variable name");
+        record_error(ctx, variable_token.line_number, "Expected variable name");
         return NULL;
     }
     
-    Token operator_token = peek_next_token();
+    Token operator_token = peek_next_token(ctx);
     
     if (operator_token.type == PLUS_ASSIGN || operator_token.type == MINUS_ASSIGN ||
         operator_token.type == MULTIPLY_ASSIGN || operator_token.type == DIVIDE_ASSIGN) {
-        get_next_token();
+        get_next_token(ctx);
         
-        ASTNode* expression = parse_expression();
+        ASTNode* expression = parse_expression(ctx);
         if (!expression) return NULL;
         
-        mark_variable_initialized(variable_token.text);
-        return create_tree_node(COMPOUND_ASSIGN_NODE, operator_token, 
-                              create_tree_node(VARIABLE_NODE, variable_token, NULL, NULL), 
+        mark_variable_initialized(ctx, variable_token);
+        return create_tree_node(ctx, COMPOUND_ASSIGN_NODE, operator_token, 
+                              create_tree_node(ctx, VARIABLE_NODE, variable_token, NULL, NULL), 
                               expression);
     }
     
-    if (!expect_token(ASSIGN, "=")) return NULL;
+    if (!expect_token(ctx, ASSIGN, "=")) return NULL;
     
-    Token next_token = peek_next_token();
+    Token next_token = peek_next_token(ctx);
     if (next_token.type == IDENTIFIER) {
-        Token lookahead = (current_token_position + 1 < current_token_count) ? 
-                         all_tokens[current_token_position + 1] : all_tokens[current_token_count - 1];
+        Token lookahead = (ctx->current_token_position + 1 < ctx->current_token_count) ? 
+                         ctx->all_tokens[ctx->current_token_position + 1] : ctx->all_tokens[ctx->current_token_count - 1];
         
         if (lookahead.type == ASSIGN) {
-            ASTNode* nested_assignment = parse_assignment();
+            ASTNode* nested_assignment = parse_assignment(ctx);
             if (!nested_assignment) return NULL;
             
-            mark_variable_initialized(variable_token.text);
-            return create_tree_node(ASSIGNMENT_NODE, variable_token, nested_assignment, NULL);
+            mark_variable_initialized(ctx, variable_token);
+            return create_tree_node(ctx, ASSIGNMENT_NODE, variable_token, nested_assignment, NULL);
         }
     }
     
-    ASTNode* expression = parse_expression();
+    ASTNode* expression = parse_expression(ctx);
     if (!expression) return NULL;
     
-    mark_variable_initialized(variable_token.text);
-    return create_tree_node(ASSIGNMENT_NODE, variable_token, expression, NULL);
+    mark_variable_initialized(ctx, variable_token);
+    return create_tree_node(ctx, ASSIGNMENT_NODE, variable_token, expression, NULL);
 }
 
-ASTNode* parse_declaration() {
-    Token type_token = get_next_token();
+ASTNode* parse_declaration(CompilerContext* ctx) {
+    Token type_token = get_next_token(ctx);
     
     if (type_token.type != INT_KEYWORD && type_token.type != CHAR_KEYWORD) {
-        record_error(type_token.line_number, "Expected 'int' or 'char'");
+        record_error(ctx, type_token.line_number, "Expected 'int' or 'char'");
         return NULL;
     }
     
@@ -731,17 +1262,17 @@ ASTNode* parse_declaration() {
     ASTNode* last_declaration = NULL;
     
     while (1) {
-        Token variable_token = get_next_token();
+        Token variable_token = get_next_token(ctx);
         if (variable_token.type != IDENTIFIER) {
-            record_error(variable_token.line_number, "Expected variable name");
+            record_error(ctx, variable_token.line_number, "Expected variable name");
             return NULL;
         }
         
-        bool variable_added = add_variable(variable_token.text, variable_token.line_number);
+        bool variable_added = add_variable(ctx, variable_token);
         
         ASTNode* assignment_node = NULL;
         
-        Token next_token = peek_next_token();
+        Token next_token = peek_next_token(ctx);
         
         if (next_token.type == ASSIGN || 
             next_token.type == PLUS_ASSIGN || 
@@ -749,33 +1280,32 @@ ASTNode* parse_declaration() {
             next_token.type == MULTIPLY_ASSIGN ||
             next_token.type == DIVIDE_ASSIGN) {
             
-            Token assign_token = get_next_token();
+            Token assign_token = get_next_token(ctx);
             
             if (assign_token.type != ASSIGN) {
-                record_error(assign_token.line_number, 
-                           "Cannot use compound assignment '%s' in variable declaration", 
-                           assign_token.text);
-                ASTNode* expr = parse_expression();
-                if (expr) free_program_tree(expr);
+                record_error(ctx, assign_token.line_number, 
+                           "Cannot use compound assignment '%.*s' in variable declaration", 
+                           assign_token.length, assign_token.text);
+                parse_expression(ctx);
                 
-                assignment_node = create_tree_node(VARIABLE_NODE, variable_token, NULL, NULL);
+                assignment_node = create_tree_node(ctx, VARIABLE_NODE, variable_token, NULL, NULL);
             } else {
-                ASTNode* expression = parse_expression();
+                ASTNode* expression = parse_expression(ctx);
                 if (!expression) {
-                    record_error(variable_token.line_number, "Expected expression after '='");
-                    expression = create_tree_node(NUMBER_NODE, (Token){NUMBER, "0", variable_token.line_number}, NULL, NULL);
+                    record_error(ctx, variable_token.line_number, "Expected expression after '='");
+                    expression = create_tree_node(ctx, NUMBER_NODE, (Token){NUMBER, "0", 1, variable_token.line_number}, NULL, NULL);
                 }
                 
                 if (variable_added) {
-                    mark_variable_initialized(variable_token.text);
+                    mark_variable_initialized(ctx, variable_token);
                 }
-                assignment_node = create_tree_node(ASSIGNMENT_NODE, variable_token, expression, NULL);
+                assignment_node = create_tree_node(ctx, ASSIGNMENT_NODE, variable_token, expression, NULL);
             }
         } else {
-            assignment_node = create_tree_node(VARIABLE_NODE, variable_token, NULL, NULL);
+            assignment_node = create_tree_node(ctx, VARIABLE_NODE, variable_token, NULL, NULL);
         }
         
-        ASTNode* decl_node = create_tree_node(DECLARATION_NODE, type_token, assignment_node, NULL);
+        ASTNode* decl_node = create_tree_node(ctx, DECLARATION_NODE, type_token, assignment_node, NULL);
         
         if (!declaration_list) {
             declaration_list = decl_node;
@@ -784,125 +1314,120 @@ ASTNode* parse_declaration() {
         }
         last_declaration = decl_node;
         
-        if (peek_next_token().type == COMMA) {
-            get_next_token();
+        if (peek_next_token(ctx).type == COMMA) {
+            get_next_token(ctx);
         } else {
             break;
         }
     }
     
-    if (!expect_token(SEMICOLON, ";")) {
-        free_program_tree(declaration_list);
+    if (!expect_token(ctx, SEMICOLON, ";")) {
         return NULL;
     }
     
     return declaration_list;
 }
 
-ASTNode* parse_statement() {
-    if (peek_next_token().type == SEMICOLON) {
-        get_next_token();
+ASTNode* parse_statement(CompilerContext* ctx) {
+    if (peek_next_token(ctx).type == SEMICOLON) {
+        get_next_token(ctx);
         return NULL;
     }
 
-    if (peek_next_token().type == INT_KEYWORD || peek_next_token().type == CHAR_KEYWORD) 
-        return parse_declaration();
+    if (peek_next_token(ctx).type == INT_KEYWORD || peek_next_token(ctx).type == CHAR_KEYWORD) 
+        return parse_declaration(ctx);
     
-    if (peek_next_token().type == INCREMENT || peek_next_token().type == DECREMENT) {
-        Token op_token = get_next_token();
+    if (peek_next_token(ctx).type == INCREMENT || peek_next_token(ctx).type == DECREMENT) {
+        Token op_token = get_next_token(ctx);
         
-        if (peek_next_token().type != IDENTIFIER) {
-            record_error(op_token.line_number, "Expected variable after prefix operator");
-            while (peek_next_token().type != SEMICOLON && peek_next_token().type != END_OF_FILE) {
-                get_next_token();
+        if (peek_next_token(ctx).type != IDENTIFIER) {
+            record_error(ctx, op_token.line_number, "Expected variable after prefix operator");
+            while (peek_next_token(ctx).type != SEMICOLON && peek_next_token(ctx).type != END_OF_FILE) {
+                get_next_token(ctx);
             }
-            if (peek_next_token().type == SEMICOLON) {
-                get_next_token();
+            if (peek_next_token(ctx).type == SEMICOLON) {
+                get_next_token(ctx);
             }
             return NULL;
         }
         
-        Token var_token = get_next_token();
-        mark_variable_used(var_token.text);
-        mark_variable_initialized(var_token.text);
+        Token var_token = get_next_token(ctx);
+        mark_variable_used(ctx, var_token);
+        mark_variable_initialized(ctx, var_token);
         
-        ASTNode* node = create_tree_node(UNARY_NODE, op_token, 
-                              create_tree_node(VARIABLE_NODE, var_token, NULL, NULL), NULL);
+        ASTNode* node = create_tree_node(ctx, UNARY_NODE, op_token, 
+                              create_tree_node(ctx, VARIABLE_NODE, var_token, NULL, NULL), NULL);
         
-        if (!expect_token(SEMICOLON, ";")) {
-            free_program_tree(node);
+        if (!expect_token(ctx, SEMICOLON, ";")) {
             return NULL;
         }
         return node;
     }
     
-    if (peek_next_token().type == IDENTIFIER) {
-        Token next_token = peek_next_token();
-        Token lookahead = (current_token_position + 1 < current_token_count) ? 
-                         all_tokens[current_token_position + 1] : all_tokens[current_token_count - 1];
+    if (peek_next_token(ctx).type == IDENTIFIER) {
+        Token next_token = peek_next_token(ctx);
+        Token lookahead = (ctx->current_token_position + 1 < ctx->current_token_count) ? 
+                         ctx->all_tokens[ctx->current_token_position + 1] : ctx->all_tokens[ctx->current_token_count - 1];
         
         if (lookahead.type == PLUS_ASSIGN || lookahead.type == MINUS_ASSIGN || 
             lookahead.type == MULTIPLY_ASSIGN || lookahead.type == DIVIDE_ASSIGN) {
             
-            Token var_token = get_next_token();
-            Token op_token = get_next_token();
+            Token var_token = get_next_token(ctx);
+            Token op_token = get_next_token(ctx);
             
-            Symbol* var = find_variable(var_token.text);
+            Symbol* var = find_variable(ctx, var_token);
             if (!var) {
-                record_error(var_token.line_number, "Variable '%s' was not declared", var_token.text);
-                while (peek_next_token().type != SEMICOLON && peek_next_token().type != END_OF_FILE) {
-                    get_next_token();
+                record_error(ctx, var_token.line_number, "Variable '%.*s' was not declared",
+                             var_token.length, var_token.text);
+                while (peek_next_token(ctx).type != SEMICOLON && peek_next_token(ctx).type != END_OF_FILE) {
+                    get_next_token(ctx);
                 }
-                if (peek_next_token().type == SEMICOLON) get_next_token();
+                if (peek_next_token(ctx).type == SEMICOLON) get_next_token(ctx);
                 return NULL;
             }
             
-            mark_variable_used(var_token.text);
+            mark_variable_used(ctx, var_token);
             
-            ASTNode* expression = parse_expression();
+            ASTNode* expression = parse_expression(ctx);
             if (!expression) {
-                record_error(op_token.line_number, "Expected expression after compound assignment operator");
+                record_error(ctx, op_token.line_number, "Expected expression after compound assignment operator");
                 return NULL;
             }
             
-            ASTNode* compound_assign = create_tree_node(COMPOUND_ASSIGN_NODE, op_token,
-                create_tree_node(VARIABLE_NODE, var_token, NULL, NULL),
+            ASTNode* compound_assign = create_tree_node(ctx, COMPOUND_ASSIGN_NODE, op_token,
+                create_tree_node(ctx, VARIABLE_NODE, var_token, NULL, NULL),
                 expression);
             
-            if (!expect_token(SEMICOLON, ";")) {
-                free_program_tree(compound_assign);
+            if (!expect_token(ctx, SEMICOLON, ";")) {
                 return NULL;
             }
             
             return compound_assign;
         }
         else if (lookahead.type == ASSIGN) {
-            ASTNode* assignment = parse_assignment();
-            if (assignment && !expect_token(SEMICOLON, ";")) {
-                free_program_tree(assignment);
+            ASTNode* assignment = parse_assignment(ctx);
+            if (assignment && !expect_token(ctx, SEMICOLON, ";")) {
                 return NULL;
             }
             return assignment;
         } else if (lookahead.type == INCREMENT || lookahead.type == DECREMENT) {
-            Token var_token = get_next_token();
-            Token op_token = get_next_token();
+            Token var_token = get_next_token(ctx);
+            Token op_token = get_next_token(ctx);
             
-            mark_variable_used(var_token.text);
-            mark_variable_initialized(var_token.text);
+            mark_variable_used(ctx, var_token);
+            mark_variable_initialized(ctx, var_token);
             
-            ASTNode* node = create_tree_node(UNARY_NODE, op_token, 
-                                  create_tree_node(VARIABLE_NODE, var_token, NULL, NULL), NULL);
+            ASTNode* node = create_tree_node(ctx, UNARY_NODE, op_token, 
+                                  create_tree_node(ctx, VARIABLE_NODE, var_token, NULL, NULL), NULL);
             
-            if (!expect_token(SEMICOLON, ";")) {
-                free_program_tree(node);
+            if (!expect_token(ctx, SEMICOLON, ";")) {
                 return NULL;
             }
             return node;
         } else {
-            ASTNode* expr = parse_expression();
+            ASTNode* expr = parse_expression(ctx);
             if (expr) {
-                if (!expect_token(SEMICOLON, ";")) {
-                    free_program_tree(expr);
+                if (!expect_token(ctx, SEMICOLON, ";")) {
                     return NULL;
                 }
                 return expr;
@@ -910,36 +1435,36 @@ ASTNode* parse_statement() {
         }
     }
     
-    ASTNode* expr = parse_expression();
+    ASTNode* expr = parse_expression(ctx);
     if (expr) {
-        if (!expect_token(SEMICOLON, ";")) {
-            free_program_tree(expr);
+        if (!expect_token(ctx, SEMICOLON, ";")) {
             return NULL;
         }
         return expr;
     }
     
-    Token error_token = peek_next_token();
+    Token error_token = peek_next_token(ctx);
     if (error_token.type != END_OF_FILE) {
-        record_error(error_token.line_number, "Invalid statement starting with '%s'", error_token.text);
+        record_error(ctx, error_token.line_number, "Invalid statement starting with '%.*s'",
+                     error_token.length, error_token.text);
         
-        while (peek_next_token().type != SEMICOLON && peek_next_token().type != END_OF_FILE) {
-            get_next_token();
+        while (peek_next_token(ctx).type != SEMICOLON && peek_next_token(ctx).type != END_OF_FILE) {
+            get_next_token(ctx);
         }
-        if (peek_next_token().type == SEMICOLON) {
-            get_next_token();
+        if (peek_next_token(ctx).type == SEMICOLON) {
+            get_next_token(ctx);
         }
     }
     
     return NULL;
 }
 
-ASTNode* parse_program() {
+ASTNode* parse_program(CompilerContext* ctx) {
     ASTNode *program_start = NULL;
     ASTNode *current_statement = NULL;
     
-    while (peek_next_token().type != END_OF_FILE) {
-        ASTNode* statement = parse_statement();
+    while (peek_next_token(ctx).type != END_OF_FILE) {
+        ASTNode* statement = parse_statement(ctx);
         if (statement) {
             if (!program_start) {
                 program_start = current_statement = statement;
@@ -952,191 +1477,802 @@ ASTNode* parse_program() {
     return program_start;
 }
 
-void check_program_semantics(ASTNode* node) {
+void check_program_semantics(CompilerContext* ctx, ASTNode* node) {
     if (!node) return;
     
     switch (node->node_type) {
         case VARIABLE_NODE: 
             {
-                Symbol* variable = find_variable(node->token_info.text);
+                Symbol* variable = find_variable(ctx, node->token_info);
                 if (!variable) {
-                    record_error(node->token_info.line_number, 
-                               "Variable '%s' was not declared", node->token_info.text);
+                    record_error(ctx, node->token_info.line_number, 
+                               "Variable '%.*s' was not declared",
+                               node->token_info.length, node->token_info.text);
                 } else if (!variable->is_initialized) {
-                    // fprintf(stderr, "Warning at line %d: Variable '%s' might not have a value\n", 
-                    //        node->token_info.line_number, node->token_info.text);
+                    // fprintf(stderr, "Warning at line %d: Variable '%.*s' might not have a value\n", 
+                    //        node->token_info.line_number, node->token_info.length, node->token_info.text);
                 }
             }
             break;
         
         case UNARY_NODE:
             if (node->left_child && node->left_child->node_type == VARIABLE_NODE) {
-                Symbol* variable = find_variable(node->left_child->token_info.text);
+                Symbol* variable = find_variable(ctx, node->left_child->token_info);
                 if (!variable) {
-                    record_error(node->token_info.line_number, 
-                               "Variable '%s' was not declared", node->left_child->token_info.text);
+                    record_error(ctx, node->token_info.line_number, 
+                               "Variable '%.*s' was not declared",
+                               node->left_child->token_info.length, node->left_child->token_info.text);
                 } else if (!variable->is_initialized) {
-                    fprintf(stderr, "Warning at line %d: Variable '%s' might not have a value\n", 
-                           node->token_info.line_number, node->left_child->token_info.text);
+                    fprintf(stderr, "Warning at line %d: Variable '%.*s' might not have a value\n", 
+                           node->token_info.line_number, node->left_child->token_info.length,
+                           node->left_child->token_info.text);
                 }
-                mark_variable_used(node->left_child->token_info.text);
+                mark_variable_used(ctx, node->left_child->token_info);
             }
             break;
             
         case ASSIGNMENT_NODE: 
             {
-                Symbol* variable = find_variable(node->token_info.text);
+                Symbol* variable = find_variable(ctx, node->token_info);
                 if (!variable) {
-                    record_error(node->token_info.line_number, 
-                               "Variable '%s' was not declared", node->token_info.text);
+                    record_error(ctx, node->token_info.line_number, 
+                               "Variable '%.*s' was not declared",
+                               node->token_info.length, node->token_info.text);
                 }
-                check_program_semantics(node->left_child);
+                check_program_semantics(ctx, node->left_child);
             }
             break;
             
         case COMPOUND_ASSIGN_NODE:
             if (node->left_child && node->left_child->node_type == VARIABLE_NODE) {
-                Symbol* variable = find_variable(node->left_child->token_info.text);
+                Symbol* variable = find_variable(ctx, node->left_child->token_info);
                 if (!variable) {
-                    record_error(node->token_info.line_number, 
-                               "Variable '%s' was not declared", node->left_child->token_info.text);
+                    record_error(ctx, node->token_info.line_number, 
+                               "Variable '%.*s' was not declared",
+                               node->left_child->token_info.length, node->left_child->token_info.text);
                 }
-                mark_variable_used(node->left_child->token_info.text);
+                mark_variable_used(ctx, node->left_child->token_info);
             }
-            check_program_semantics(node->right_child);
+            check_program_semantics(ctx, node->right_child);
             break;
             
         case OPERATION_NODE:
-            check_program_semantics(node->left_child);
-            check_program_semantics(node->right_child);
+            check_program_semantics(ctx, node->left_child);
+            check_program_semantics(ctx, node->right_child);
             break;
             
         case DECLARATION_NODE:
-            check_program_semantics(node->left_child);
+            check_program_semantics(ctx, node->left_child);
             break;
             
         default:
             break;
     }
     
-    check_program_semantics(node->next);
+    check_program_semantics(ctx, node->next);
 }
 
-void check_for_unused_variables() {
-    for (int i = 0; i < symbols_found; i++) {
-        if (!symbol_table[i].is_used) {
+void check_for_unused_variables(CompilerContext* ctx) {
+    for (int i = 0; i < ctx->symbols_found; i++) {
+        if (!ctx->symbol_table[i].is_used) {
             // fprintf(stderr, "Warning: Variable '%s' was declared but never used\n", 
-            //        symbol_table[i].name);
+            //        ctx->symbol_table[i].name);
         }
     }
 }
 
-void generate_expression_code(ASTNode* node, FILE* output, const char* result_register) {
-    if (!node) return;
-    
-    switch (node->node_type) {
-        case NUMBER_NODE:
-            fprintf(output, "    daddiu %s, r0, %s\n", result_register, node->token_info.text);
-            produce_machine_code("daddiu", 0, get_register_number(result_register), 
-                               -1, atoi(node->token_info.text), output);
+// --- Optimization ---
+//
+// Runs between semantic analysis and codegen. Expressions are rewritten in
+// place: constant subtrees are folded, identity operations dropped and
+// multiply/divide by a power of two turned into a shift. The statements
+// themselves are left to eliminate_dead_code, since a bare "-a;" negates a in
+// place.
+
+// Constants end up as daddiu immediates, which are sign-extended from 16 bits
+#define FOLD_MIN -32768
+#define FOLD_MAX 32767
+
+bool constant_value(ASTNode* node, long long* value) {
+    if (!node || (node->node_type != NUMBER_NODE && node->node_type != CHAR_NODE)) return false;
+    long long parsed = strtoll(node->token_info.text, NULL, 10);
+    if (parsed < FOLD_MIN || parsed > FOLD_MAX) return false;
+    *value = parsed;
+    return true;
+}
+
+// Evaluates with the semantics of the generated code: 64-bit wraparound and
+// unsigned division. Division by zero is left for the machine.
+bool evaluate_operation(TokenType operator, long long left, long long right, long long* result) {
+    unsigned long long a = (unsigned long long)left, b = (unsigned long long)right;
+    switch (operator) {
+        case PLUS: *result = (long long)(a + b); return true;
+        case MINUS: *result = (long long)(a - b); return true;
+        case MULTIPLY: *result = (long long)(a * b); return true;
+        case DIVIDE:
+            if (b == 0) return false;
+            *result = (long long)(a / b);
+            return true;
+        default: return false;
+    }
+}
+
+// Returns k when value == 2^k for k >= 1, otherwise 0
+int power_of_two_exponent(long long value) {
+    if (value < 2 || (value & (value - 1)) != 0) return 0;
+    int exponent = 0;
+    while (value > 1) {
+        value >>= 1;
+        exponent++;
+    }
+    return exponent;
+}
+
+ASTNode* create_constant_node(CompilerContext* ctx, long long value, int line_number) {
+    char* value_text = arena_alloc(&ctx->node_arena, 8);
+    if (!value_text) return NULL;
+    int value_length = snprintf(value_text, 8, "%lld", value);
+    Token constant = {NUMBER, value_text, value_length, line_number};
+    return create_tree_node(ctx, NUMBER_NODE, constant, NULL, NULL);
+}
+
+// Replaces node by a constant when the value fits an immediate
+ASTNode* fold_to_constant(CompilerContext* ctx, ASTNode* node, long long value) {
+    if (value < FOLD_MIN || value > FOLD_MAX) return node;
+    ASTNode* constant = create_constant_node(ctx, value, node->token_info.line_number);
+    return constant ? constant : node;
+}
+
+// operand * 2^k becomes dsll, operand / 2^k becomes dsrl; ddivu is unsigned,
+// so the logical shift gives exactly the same quotient
+ASTNode* create_shift_node(CompilerContext* ctx, ASTNode* node, ASTNode* operand, int exponent) {
+    ASTNode* amount = create_constant_node(ctx, exponent, node->token_info.line_number);
+    if (!amount) return node;
+    ASTNode* shift = create_tree_node(ctx, SHIFT_NODE, node->token_info, operand, amount);
+    return shift ? shift : node;
+}
+
+ASTNode* optimize_expression(CompilerContext* ctx, ASTNode* node) {
+    if (!node) return NULL;
+    long long left_value = 0, right_value = 0, result;
+
+    if (node->node_type == UNARY_NODE) {
+        // ++ and -- store to their variable and have to stay
+        if (node->token_info.type != PLUS && node->token_info.type != MINUS) return node;
+        node->left_child = optimize_expression(ctx, node->left_child);
+        ASTNode* operand = node->left_child;
+        if (!operand) return node;
+        if (node->token_info.type == PLUS) return operand;
+        if (constant_value(operand, &left_value)) return fold_to_constant(ctx, node, -left_value);
+        if (operand->node_type == UNARY_NODE && operand->token_info.type == MINUS) {
+            return operand->left_child ? operand->left_child : node;
+        }
+        return node;
+    }
+
+    if (node->node_type != OPERATION_NODE) return node;
+
+    node->left_child = optimize_expression(ctx, node->left_child);
+    node->right_child = optimize_expression(ctx, node->right_child);
+    if (!node->left_child || !node->right_child) return node;
+
+    bool left_constant = constant_value(node->left_child, &left_value);
+    bool right_constant = constant_value(node->right_child, &right_value);
+
+    if (left_constant && right_constant &&
+        evaluate_operation(node->token_info.type, left_value, right_value, &result)) {
+        ASTNode* folded = fold_to_constant(ctx, node, result);
+        if (folded != node) return folded;
+    }
+
+    switch (node->token_info.type) {
+        case PLUS:
+            if (right_constant && right_value == 0) return node->left_child;
+            if (left_constant && left_value == 0) return node->right_child;
             break;
-            
-        case CHAR_NODE:
-            fprintf(output, "    daddiu %s, r0, %s\n", result_register, node->token_info.text);
-            produce_machine_code("daddiu", 0, get_register_number(result_register), 
-                               -1, atoi(node->token_info.text), output);
+        case MINUS:
+            if (right_constant && right_value == 0) return node->left_child;
             break;
-            
-        case VARIABLE_NODE: 
-            {
-                Symbol* variable = find_variable(node->token_info.text);
-                if (variable) {
-                    fprintf(output, "    lb %s, %d(r0)\n", result_register, variable->memory_location);
-                    produce_machine_code("lb", 0, get_register_number(result_register), 
-                                       -1, variable->memory_location, output);
-                }
+        case MULTIPLY:
+            if (right_constant && right_value == 1) return node->left_child;
+            if (left_constant && left_value == 1) return node->right_child;
+            if (right_constant && power_of_two_exponent(right_value)) {
+                return create_shift_node(ctx, node, node->left_child, power_of_two_exponent(right_value));
+            }
+            if (left_constant && power_of_two_exponent(left_value)) {
+                return create_shift_node(ctx, node, node->right_child, power_of_two_exponent(left_value));
+            }
+            break;
+        case DIVIDE:
+            if (right_constant && right_value == 1) return node->left_child;
+            if (right_constant && power_of_two_exponent(right_value)) {
+                return create_shift_node(ctx, node, node->left_child, power_of_two_exponent(right_value));
+            }
+            break;
+        default:
+            break;
+    }
+    return node;
+}
+
+void optimize_program(CompilerContext* ctx, ASTNode* program) {
+    for (ASTNode* statement = program; statement; statement = statement->next) {
+        switch (statement->node_type) {
+            case ASSIGNMENT_NODE:
+                statement->left_child = optimize_expression(ctx, statement->left_child);
+                break;
+            case DECLARATION_NODE:
+                if (statement->left_child && statement->left_child->node_type == ASSIGNMENT_NODE) {
+                    ASTNode* assignment = statement->left_child;
+                    assignment->left_child = optimize_expression(ctx, assignment->left_child);
+                }
+                break;
+            case COMPOUND_ASSIGN_NODE:
+                statement->right_child = optimize_expression(ctx, statement->right_child);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// --- Dead Code Elimination ---
+//
+// Only run with --unused drop. The program has no output, so the values that
+// matter are those of variables some statement reads; check_for_unused_variables
+// flags the ones nothing reads at all. This extends that to def-use chains: a
+// read only counts when it is made by a statement that stays, and a variable
+// reading itself ("a = a + 1;", "a++;") does not keep itself alive. A store to
+// a variable nobody reads is dropped, and so is an expression statement like
+// "6 - 3;", unless an ++, -- or nested assignment in it changes another
+// variable. The surviving variables are then packed into consecutive slots.
+
+// Whether an ++, -- or "b = ..." in node changes a variable other than target
+bool changes_other_variable(CompilerContext* ctx, ASTNode* node, int target) {
+    if (!node) return false;
+    Symbol* variable = NULL;
+    if (node->node_type == UNARY_NODE &&
+        (node->token_info.type == INCREMENT || node->token_info.type == DECREMENT) &&
+        node->left_child && node->left_child->node_type == VARIABLE_NODE) {
+        variable = find_variable(ctx, node->left_child->token_info);
+    } else if (node->node_type == ASSIGNMENT_NODE) {
+        variable = find_variable(ctx, node->token_info);
+    }
+    if (variable && variable - ctx->symbol_table != target) return true;
+    return changes_other_variable(ctx, node->left_child, target) ||
+           changes_other_variable(ctx, node->right_child, target);
+}
+
+// Index of the variable a statement stores to, or -1 for an expression
+// statement, which generate_assembly_code emits nothing for
+int stored_variable_index(CompilerContext* ctx, ASTNode* statement) {
+    Token name;
+    switch (statement->node_type) {
+        case ASSIGNMENT_NODE:
+            name = statement->token_info;
+            break;
+        case DECLARATION_NODE:
+            if (!statement->left_child) return -1;
+            name = statement->left_child->token_info;
+            break;
+        case COMPOUND_ASSIGN_NODE:
+        case UNARY_NODE:
+            if (!statement->left_child || statement->left_child->node_type != VARIABLE_NODE) return -1;
+            name = statement->left_child->token_info;
+            break;
+        default:
+            return -1;
+    }
+    Symbol* variable = find_variable(ctx, name);
+    return variable ? (int)(variable - ctx->symbol_table) : -1;
+}
+
+// Adds delta to the read count of every variable the statement reads, other
+// than the one it stores to. Variables whose count drops to zero go on the
+// worklist.
+void count_variable_reads(CompilerContext* ctx, ASTNode* node, int target, int delta,
+                         int* read_counts, int* worklist, int* worklist_count) {
+    if (!node) return;
+    if (node->node_type == VARIABLE_NODE) {
+        Symbol* variable = find_variable(ctx, node->token_info);
+        int index = variable ? (int)(variable - ctx->symbol_table) : -1;
+        if (index >= 0 && index != target) {
+            read_counts[index] += delta;
+            if (read_counts[index] == 0) {
+                worklist[(*worklist_count)++] = index;
+            }
+        }
+    }
+    count_variable_reads(ctx, node->left_child, target, delta, read_counts, worklist, worklist_count);
+    count_variable_reads(ctx, node->right_child, target, delta, read_counts, worklist, worklist_count);
+}
+
+// Returns the remaining statements. When none are left the first one becomes
+// an empty PROGRAM_NODE, so the listing still gets its .code section. When the
+// scratch arrays cannot be had the program is kept as it is.
+ASTNode* eliminate_dead_code(CompilerContext* ctx, ASTNode* program) {
+    int statement_count = 0;
+    for (ASTNode* statement = program; statement; statement = statement->next) statement_count++;
+    int symbol_count = ctx->symbols_found;
+
+    ASTNode** statements = malloc((statement_count + 1) * sizeof(ASTNode*));
+    int* targets = malloc((statement_count + 1) * sizeof(int));
+    int* next_store = malloc((statement_count + 1) * sizeof(int));
+    bool* removed = calloc(statement_count + 1, sizeof(bool));
+    int* read_counts = calloc(symbol_count + 1, sizeof(int));
+    int* first_store = malloc((symbol_count + 1) * sizeof(int));
+    int* worklist = malloc((symbol_count + 1) * sizeof(int));
+    bool* keeps_slot = calloc(symbol_count + 1, sizeof(bool));
+    if (!statements || !targets || !next_store || !removed || !read_counts ||
+        !first_store || !worklist || !keeps_slot) {
+        free(statements); free(targets); free(next_store); free(removed);
+        free(read_counts); free(first_store); free(worklist); free(keeps_slot);
+        return program;
+    }
+
+    // A statement that changes another variable is kept, and so are the
+    // earlier values of the variable it stores to: its reads of itself count.
+    // Only the other stores hang off their variable's list.
+    for (int i = 0; i < symbol_count; i++) first_store[i] = -1;
+    int worklist_count = 0;
+    int index = 0;
+    for (ASTNode* statement = program; statement; statement = statement->next, index++) {
+        statements[index] = statement;
+        targets[index] = stored_variable_index(ctx, statement);
+        if (changes_other_variable(ctx, statement, targets[index])) {
+            count_variable_reads(ctx, statement, -1, 1, read_counts, worklist, &worklist_count);
+        } else if (targets[index] < 0) {
+            removed[index] = true;
+        } else {
+            next_store[index] = first_store[targets[index]];
+            first_store[targets[index]] = index;
+            count_variable_reads(ctx, statement, targets[index], 1, read_counts, worklist, &worklist_count);
+        }
+    }
+    for (int i = 0; i < symbol_count; i++) {
+        if (read_counts[i] == 0) worklist[worklist_count++] = i;
+    }
+
+    // Each variable enters the worklist once, when its count reaches zero
+    while (worklist_count) {
+        int variable = worklist[--worklist_count];
+        for (int store = first_store[variable]; store >= 0; store = next_store[store]) {
+            removed[store] = true;
+            count_variable_reads(ctx, statements[store], variable, -1, read_counts, worklist, &worklist_count);
+        }
+        first_store[variable] = -1;
+    }
+
+    ASTNode* remaining = NULL;
+    ASTNode* last = NULL;
+    for (int i = 0; i < statement_count; i++) {
+        if (removed[i]) continue;
+        if (targets[i] >= 0) keeps_slot[targets[i]] = true;
+        statements[i]->next = NULL;
+        if (last) last->next = statements[i];
+        else remaining = statements[i];
+        last = statements[i];
+    }
+
+    ctx->next_memory_location = 0;
+    for (int i = 0; i < symbol_count; i++) {
+        if (read_counts[i] > 0 || keeps_slot[i]) {
+            ctx->symbol_table[i].memory_location = ctx->next_memory_location;
+            ctx->next_memory_location += 8;
+        } else {
+            ctx->symbol_table[i].memory_location = -1;
+        }
+    }
+
+    if (!remaining) {
+        *program = (ASTNode){PROGRAM_NODE, program->token_info, NULL, NULL, NULL};
+        remaining = program;
+    }
+
+    free(statements); free(targets); free(next_store); free(removed);
+    free(read_counts); free(first_store); free(worklist); free(keeps_slot);
+    return remaining;
+}
+
+// --- Register Allocation ---
+//
+// Variables live in r8-r23 from the first statement that touches them to the
+// last one, so straight-line code works on them without going through
+// memory. A variable is loaded when its range starts if that statement reads
+// it, and stored back when its range ends if it was written. When more
+// ranges overlap than there are registers, linear scan spills the one that
+// ends last; a spilled variable keeps its lb/sb on every access.
+//
+// Memory holds one byte per variable, so a register may carry high bits
+// that lb would have replaced with copies of the sign bit. Only ddivu and
+// dsrl can tell the difference; their operands are sign-extended in place
+// (dsll32/dsra32 by 24, i.e. 56 bits) before use.
+
+#define FIRST_VARIABLE_REGISTER 8
+#define VARIABLE_REGISTER_COUNT 16
+
+void note_live_variable(CompilerContext* ctx, Token name, int statement_index) {
+    Symbol* variable = find_variable(ctx, name);
+    if (!variable) return;
+
+    RegisterAllocation* allocation = &ctx->register_allocation;
+    if (variable->live_range >= 0) {
+        allocation->ranges[variable->live_range].end = statement_index;
+        return;
+    }
+    if (allocation->range_count == allocation->range_capacity) {
+        int capacity = allocation->range_capacity ? allocation->range_capacity * 2 : 64;
+        LiveRange* ranges = realloc(allocation->ranges, capacity * sizeof(LiveRange));
+        // Without a range the variable simply stays in memory
+        if (!ranges) return;
+        allocation->ranges = ranges;
+        allocation->range_capacity = capacity;
+    }
+    variable->live_range = allocation->range_count++;
+    allocation->ranges[variable->live_range] =
+        (LiveRange){statement_index, statement_index, (int)(variable - ctx->symbol_table), 0};
+}
+
+void note_live_variables(CompilerContext* ctx, ASTNode* node, int statement_index) {
+    if (!node) return;
+    if (node->node_type == VARIABLE_NODE || node->node_type == ASSIGNMENT_NODE) {
+        note_live_variable(ctx, node->token_info, statement_index);
+    }
+    note_live_variables(ctx, node->left_child, statement_index);
+    note_live_variables(ctx, node->right_child, statement_index);
+}
+
+int compare_range_ends(const void* a, const void* b) {
+    return ((const LiveRange*)a)->end - ((const LiveRange*)b)->end;
+}
+
+// Keeps active ordered by increasing end
+void insert_active_range(const LiveRange* ranges, int* active, int* active_count, int range) {
+    int position = (*active_count)++;
+    while (position > 0 && ranges[active[position - 1]].end > ranges[range].end) {
+        active[position] = active[position - 1];
+        position--;
+    }
+    active[position] = range;
+}
+
+void allocate_variable_registers(CompilerContext* ctx, ASTNode* program) {
+    RegisterAllocation* allocation = &ctx->register_allocation;
+    allocation->range_count = 0;
+    allocation->ended_count = 0;
+    allocation->next_start = 0;
+    allocation->next_end = 0;
+    allocation->full_width_reads = false;
+    allocation->out_of_registers = false;
+    for (int i = 0; i < ctx->symbols_found; i++) {
+        ctx->symbol_table[i].live_range = -1;
+        ctx->symbol_table[i].home_register = 0;
+    }
+
+    // Statements are visited in order, so ranges come out sorted by start
+    int statement_index = 0;
+    for (ASTNode* statement = program; statement; statement = statement->next, statement_index++) {
+        // "int a;" only claims the slot, which generate_assembly_code zeroes
+        if (statement->node_type == DECLARATION_NODE && statement->left_child &&
+            statement->left_child->node_type == VARIABLE_NODE) continue;
+        note_live_variables(ctx, statement, statement_index);
+    }
+
+    LiveRange* ranges = allocation->ranges;
+    int active[VARIABLE_REGISTER_COUNT];
+    int active_count = 0;
+    int free_registers[VARIABLE_REGISTER_COUNT];
+    int free_count = 0;
+    for (int i = VARIABLE_REGISTER_COUNT - 1; i >= 0; i--) {
+        free_registers[free_count++] = FIRST_VARIABLE_REGISTER + i;
+    }
+
+    for (int i = 0; i < allocation->range_count; i++) {
+        while (active_count && ranges[active[0]].end < ranges[i].start) {
+            free_registers[free_count++] = ranges[active[0]].home_register;
+            memmove(active, active + 1, --active_count * sizeof(int));
+        }
+        if (free_count) {
+            ranges[i].home_register = free_registers[--free_count];
+            insert_active_range(ranges, active, &active_count, i);
+            continue;
+        }
+        // Out of registers: whichever of the two ranges ends last is spilled
+        int last = active[active_count - 1];
+        if (ranges[last].end > ranges[i].end) {
+            ranges[i].home_register = ranges[last].home_register;
+            ranges[last].home_register = 0;
+            active_count--;
+            insert_active_range(ranges, active, &active_count, i);
+        }
+    }
+
+    if (allocation->range_count > allocation->ended_capacity) {
+        LiveRange* ended = realloc(allocation->ended, allocation->range_count * sizeof(LiveRange));
+        if (!ended) {
+            // Storing back needs the ranges ordered by end; keep everything in memory
+            ctx->stats.spilled_registers += allocation->range_count;
+            allocation->range_count = 0;
+            return;
+        }
+        allocation->ended = ended;
+        allocation->ended_capacity = allocation->range_count;
+    }
+    for (int i = 0; i < allocation->range_count; i++) {
+        if (!ranges[i].home_register) {
+            ctx->stats.spilled_registers++;
+            continue;
+        }
+        ctx->symbol_table[ranges[i].symbol].home_register = ranges[i].home_register;
+        allocation->ended[allocation->ended_count++] = ranges[i];
+    }
+    if (allocation->ended_count) {
+        qsort(allocation->ended, allocation->ended_count, sizeof(LiveRange), compare_range_ends);
+    }
+}
+
+// Whether node reads (or with writes_only, modifies) variable
+bool expression_uses_variable(CompilerContext* ctx, ASTNode* node, Symbol* variable, bool writes_only) {
+    if (!node) return false;
+    if (node->node_type == UNARY_NODE && (node->token_info.type == INCREMENT || node->token_info.type == DECREMENT) &&
+        node->left_child && node->left_child->node_type == VARIABLE_NODE &&
+        find_variable(ctx, node->left_child->token_info) == variable) return true;
+    if (node->node_type == ASSIGNMENT_NODE && find_variable(ctx, node->token_info) == variable) return true;
+    if (!writes_only && node->node_type == VARIABLE_NODE && find_variable(ctx, node->token_info) == variable) return true;
+    return expression_uses_variable(ctx, node->left_child, variable, writes_only) ||
+           expression_uses_variable(ctx, node->right_child, variable, writes_only);
+}
+
+// Only "a = <expression without a>" can skip loading a first
+bool statement_reads_variable(CompilerContext* ctx, ASTNode* statement, Symbol* variable) {
+    ASTNode* assignment = statement->node_type == DECLARATION_NODE ? statement->left_child : statement;
+    if (assignment && assignment->node_type == ASSIGNMENT_NODE &&
+        find_variable(ctx, assignment->token_info) == variable) {
+        return expression_uses_variable(ctx, assignment->left_child, variable, false);
+    }
+    return true;
+}
+
+void begin_live_ranges(CompilerContext* ctx, ASTNode* statement, int statement_index, CodeBuffer* output) {
+    RegisterAllocation* allocation = &ctx->register_allocation;
+    allocation->statement_line = statement->token_info.line_number;
+    while (allocation->next_start < allocation->range_count &&
+           allocation->ranges[allocation->next_start].start == statement_index) {
+        LiveRange* range = &allocation->ranges[allocation->next_start++];
+        if (!range->home_register) continue;
+
+        Symbol* variable = &ctx->symbol_table[range->symbol];
+        ctx->register_pool.used_registers[range->home_register] = 1;
+        variable->is_dirty = false;
+        variable->is_normalized = false;
+        if (statement_reads_variable(ctx, statement, variable)) {
+            const char* home = ctx->register_pool.available_registers[range->home_register];
+            emit_code(output, "    lb %s, %d(r0)\n", home, variable->memory_location);
+            produce_machine_code(ctx, OP_LB, 0, range->home_register, -1, variable->memory_location, output);
+            variable->is_normalized = true;
+        }
+    }
+}
+
+void end_live_ranges(CompilerContext* ctx, int statement_index, CodeBuffer* output) {
+    RegisterAllocation* allocation = &ctx->register_allocation;
+    while (allocation->next_end < allocation->ended_count &&
+           allocation->ended[allocation->next_end].end == statement_index) {
+        LiveRange* range = &allocation->ended[allocation->next_end++];
+        Symbol* variable = &ctx->symbol_table[range->symbol];
+        if (variable->is_dirty) {
+            const char* home = ctx->register_pool.available_registers[range->home_register];
+            emit_code(output, "    sb %s, %d(r0)\n", home, variable->memory_location);
+            produce_machine_code(ctx, OP_SB, 0, range->home_register, -1, variable->memory_location, output);
+        }
+        ctx->register_pool.used_registers[range->home_register] = 0;
+    }
+}
+
+// The variable's register, sign-extended first when a full-width read needs it
+const char* variable_register(CompilerContext* ctx, Symbol* variable, CodeBuffer* output) {
+    const char* home = ctx->register_pool.available_registers[variable->home_register];
+    if (ctx->register_allocation.full_width_reads && !variable->is_normalized) {
+        emit_code(output, "    dsll32 %s, %s, 24\n", home, home);
+        produce_machine_code(ctx, OP_DSLL32, variable->home_register, -1, variable->home_register, 24, output);
+        emit_code(output, "    dsra32 %s, %s, 24\n", home, home);
+        produce_machine_code(ctx, OP_DSRA32, variable->home_register, -1, variable->home_register, 24, output);
+        variable->is_normalized = true;
+    }
+    return home;
+}
+
+// A variable operand that has a register is read from there directly, unless
+// evaluating sibling first could change it
+const char* resident_operand(CompilerContext* ctx, ASTNode* operand, ASTNode* sibling, CodeBuffer* output) {
+    if (!operand || operand->node_type != VARIABLE_NODE) return NULL;
+    Symbol* variable = find_variable(ctx, operand->token_info);
+    if (!variable || !variable->home_register) return NULL;
+    if (sibling && expression_uses_variable(ctx, sibling, variable, true)) return NULL;
+    return variable_register(ctx, variable, output);
+}
+
+// Whether a register loaded from expression already looks like an lb result
+bool holds_byte_value(CompilerContext* ctx, ASTNode* expression) {
+    long long value;
+    if (constant_value(expression, &value)) return value >= -128 && value <= 127;
+    if (expression && expression->node_type == VARIABLE_NODE) {
+        Symbol* source = find_variable(ctx, expression->token_info);
+        return source && (!source->home_register || source->is_normalized);
+    }
+    return false;
+}
+
+void generate_expression_code(CompilerContext* ctx, ASTNode* node, CodeBuffer* output, const char* result_register) {
+    if (!node) return;
+    
+    switch (node->node_type) {
+        case NUMBER_NODE:
+            emit_code(output, "    daddiu %s, r0, %.*s\n", result_register, node->token_info.length, node->token_info.text);
+            produce_machine_code(ctx, OP_DADDIU, 0, get_register_number(result_register), 
+                               -1, atoi(node->token_info.text), output);
+            break;
+            
+        case CHAR_NODE:
+            emit_code(output, "    daddiu %s, r0, %.*s\n", result_register, node->token_info.length, node->token_info.text);
+            produce_machine_code(ctx, OP_DADDIU, 0, get_register_number(result_register), 
+                               -1, atoi(node->token_info.text), output);
+            break;
+            
+        case VARIABLE_NODE: 
+            {
+                Symbol* variable = find_variable(ctx, node->token_info);
+                if (variable && variable->home_register) {
+                    const char* home = variable_register(ctx, variable, output);
+                    emit_code(output, "    daddu %s, %s, r0\n", result_register, home);
+                    produce_machine_code(ctx, OP_DADDU, variable->home_register, 0,
+                                       get_register_number(result_register), -1, output);
+                } else if (variable) {
+                    emit_code(output, "    lb %s, %d(r0)\n", result_register, variable->memory_location);
+                    produce_machine_code(ctx, OP_LB, 0, get_register_number(result_register), 
+                                       -1, variable->memory_location, output);
+                }
             }
             break;
         
         case UNARY_NODE:
             {
-                if (strcmp(node->token_info.text, "+") == 0 || strcmp(node->token_info.text, "-") == 0) {
-                    generate_expression_code(node->left_child, output, result_register);
+                if (node->token_info.type == PLUS || node->token_info.type == MINUS) {
+                    const char* operand_register = resident_operand(ctx, node->left_child, NULL, output);
+                    if (!operand_register) {
+                        generate_expression_code(ctx, node->left_child, output, result_register);
+                        operand_register = result_register;
+                    }
                     
-                    if (strcmp(node->token_info.text, "-") == 0) {
-                        fprintf(output, "    dsubu %s, r0, %s\n", result_register, result_register);
-                        produce_machine_code("dsubu", 0, get_register_number(result_register), 
+                    if (node->token_info.type == MINUS) {
+                        emit_code(output, "    dsubu %s, r0, %s\n", result_register, operand_register);
+                        produce_machine_code(ctx, OP_DSUBU, 0, get_register_number(operand_register), 
+                                           get_register_number(result_register), -1, output);
+                    } else if (operand_register != result_register) {
+                        emit_code(output, "    daddu %s, %s, r0\n", result_register, operand_register);
+                        produce_machine_code(ctx, OP_DADDU, get_register_number(operand_register), 0,
                                            get_register_number(result_register), -1, output);
                     }
                 }
                 else if (node->left_child && node->left_child->node_type == VARIABLE_NODE) {
-                    const char* var_name = node->left_child->token_info.text;
-                    Symbol* variable = find_variable(var_name);
-                    if (variable) {
-                        const char* temp_reg = get_register();
+                    Symbol* variable = find_variable(ctx, node->left_child->token_info);
+                    if (variable && variable->home_register) {
+                        // The old value is the result, the register takes the new one
+                        const char* home = variable_register(ctx, variable, output);
+                        int step = node->token_info.type == INCREMENT ? 1 : -1;
+                        emit_code(output, "    daddu %s, %s, r0\n", result_register, home);
+                        produce_machine_code(ctx, OP_DADDU, variable->home_register, 0,
+                                           get_register_number(result_register), -1, output);
+                        emit_code(output, "    daddiu %s, %s, %d\n", home, home, step);
+                        produce_machine_code(ctx, OP_DADDIU, variable->home_register,
+                                           variable->home_register, -1, step, output);
+                        variable->is_dirty = true;
+                        variable->is_normalized = false;
+                    } else if (variable) {
+                        const char* temp_reg = get_register(ctx);
                         
-                        fprintf(output, "    lb %s, %d(r0)\n", result_register, variable->memory_location);
-                        produce_machine_code("lb", 0, get_register_number(result_register), 
+                        emit_code(output, "    lb %s, %d(r0)\n", result_register, variable->memory_location);
+                        produce_machine_code(ctx, OP_LB, 0, get_register_number(result_register), 
                                            -1, variable->memory_location, output);
                         
-                        fprintf(output, "    lb %s, %d(r0)\n", temp_reg, variable->memory_location);
-                        produce_machine_code("lb", 0, get_register_number(temp_reg), 
+                        emit_code(output, "    lb %s, %d(r0)\n", temp_reg, variable->memory_location);
+                        produce_machine_code(ctx, OP_LB, 0, get_register_number(temp_reg), 
                                            -1, variable->memory_location, output);
                         
-                        if (strcmp(node->token_info.text, "++") == 0) {
-                            fprintf(output, "    daddiu %s, %s, 1\n", temp_reg, temp_reg);
-                            produce_machine_code("daddiu", get_register_number(temp_reg), 
+                        if (node->token_info.type == INCREMENT) {
+                            emit_code(output, "    daddiu %s, %s, 1\n", temp_reg, temp_reg);
+                            produce_machine_code(ctx, OP_DADDIU, get_register_number(temp_reg), 
                                                get_register_number(temp_reg), -1, 1, output);
-                        } else if (strcmp(node->token_info.text, "--") == 0) {
-                            fprintf(output, "    daddiu %s, %s, -1\n", temp_reg, temp_reg);
-                            produce_machine_code("daddiu", get_register_number(temp_reg), 
+                        } else if (node->token_info.type == DECREMENT) {
+                            emit_code(output, "    daddiu %s, %s, -1\n", temp_reg, temp_reg);
+                            produce_machine_code(ctx, OP_DADDIU, get_register_number(temp_reg), 
                                                get_register_number(temp_reg), -1, -1, output);
                         }
                         
-                        fprintf(output, "    sb %s, %d(r0)\n", temp_reg, variable->memory_location);
-                        produce_machine_code("sb", 0, get_register_number(temp_reg), 
+                        emit_code(output, "    sb %s, %d(r0)\n", temp_reg, variable->memory_location);
+                        produce_machine_code(ctx, OP_SB, 0, get_register_number(temp_reg), 
                                            -1, variable->memory_location, output);
                         
-                        release_register_by_name(temp_reg);
+                        release_register_by_name(ctx, temp_reg);
                     }
                 }
             }
             break;
             
+        case SHIFT_NODE:
+            {
+                Opcode opcode = node->token_info.type == MULTIPLY ? OP_DSLL : OP_DSRL;
+                int shift_amount = atoi(node->right_child->token_info.text);
+                bool saved_full_width = ctx->register_allocation.full_width_reads;
+                if (opcode == OP_DSRL) ctx->register_allocation.full_width_reads = true;
+                
+                const char* operand_register = resident_operand(ctx, node->left_child, NULL, output);
+                if (!operand_register) {
+                    generate_expression_code(ctx, node->left_child, output, result_register);
+                    operand_register = result_register;
+                }
+                ctx->register_allocation.full_width_reads = saved_full_width;
+                
+                emit_code(output, "    %s %s, %s, %d\n", supported_instructions[opcode].instruction_name,
+                          result_register, operand_register, shift_amount);
+                produce_machine_code(ctx, opcode, get_register_number(operand_register), -1,
+                                   get_register_number(result_register), shift_amount, output);
+            }
+            break;
+            
         case OPERATION_NODE: 
             {
-                const char* left_register = get_register();
-                const char* right_register = get_register();
+                bool saved_full_width = ctx->register_allocation.full_width_reads;
+                if (node->token_info.type == DIVIDE) ctx->register_allocation.full_width_reads = true;
                 
-                generate_expression_code(node->left_child, output, left_register);
-                generate_expression_code(node->right_child, output, right_register);
+                // One operand is built in result_register itself, so at most
+                // the right one needs a scratch register
+                const char* left_register = resident_operand(ctx, node->left_child, node->right_child, output);
+                const char* right_scratch = NULL;
+                const char* right_register = NULL;
+                if (left_register) {
+                    right_register = resident_operand(ctx, node->right_child, NULL, output);
+                    if (!right_register) {
+                        generate_expression_code(ctx, node->right_child, output, result_register);
+                        right_register = result_register;
+                    }
+                } else {
+                    generate_expression_code(ctx, node->left_child, output, result_register);
+                    left_register = result_register;
+                    right_register = resident_operand(ctx, node->right_child, NULL, output);
+                }
+                if (!right_register) {
+                    right_scratch = get_register(ctx);
+                    generate_expression_code(ctx, node->right_child, output, right_scratch);
+                    right_register = right_scratch;
+                }
+                ctx->register_allocation.full_width_reads = saved_full_width;
                 
-                if (strcmp(node->token_info.text, "+") == 0) {
-                    fprintf(output, "    daddu %s, %s, %s\n", result_register, left_register, right_register);
-                    produce_machine_code("daddu", get_register_number(left_register), 
+                if (node->token_info.type == PLUS) {
+                    emit_code(output, "    daddu %s, %s, %s\n", result_register, left_register, right_register);
+                    produce_machine_code(ctx, OP_DADDU, get_register_number(left_register), 
                                        get_register_number(right_register), 
                                        get_register_number(result_register), -1, output);
-                } else if (strcmp(node->token_info.text, "-") == 0) {
-                    fprintf(output, "    dsubu %s, %s, %s\n", result_register, left_register, right_register);
-                    produce_machine_code("dsubu", get_register_number(left_register), 
+                } else if (node->token_info.type == MINUS) {
+                    emit_code(output, "    dsubu %s, %s, %s\n", result_register, left_register, right_register);
+                    produce_machine_code(ctx, OP_DSUBU, get_register_number(left_register), 
                                        get_register_number(right_register), 
                                        get_register_number(result_register), -1, output);
-                } else if (strcmp(node->token_info.text, "*") == 0) {
-                    fprintf(output, "    dmulu %s, %s\n", left_register, right_register);
-                    produce_machine_code("dmulu", get_register_number(left_register), 
+                } else if (node->token_info.type == MULTIPLY) {
+                    emit_code(output, "    dmulu %s, %s\n", left_register, right_register);
+                    produce_machine_code(ctx, OP_DMULU, get_register_number(left_register), 
                                        get_register_number(right_register), -1, -1, output);
-                    fprintf(output, "    mflo %s\n", result_register);
-                    produce_machine_code("mflo", -1, -1, get_register_number(result_register), -1, output);
-                } else if (strcmp(node->token_info.text, "/") == 0) {
-                    fprintf(output, "    ddivu %s, %s\n", left_register, right_register);
-                    produce_machine_code("ddivu", get_register_number(left_register), 
+                    emit_code(output, "    mflo %s\n", result_register);
+                    produce_machine_code(ctx, OP_MFLO, -1, -1, get_register_number(result_register), -1, output);
+                } else if (node->token_info.type == DIVIDE) {
+                    emit_code(output, "    ddivu %s, %s\n", left_register, right_register);
+                    produce_machine_code(ctx, OP_DDIVU, get_register_number(left_register), 
                                        get_register_number(right_register), -1, -1, output);
-                    fprintf(output, "    mflo %s\n", result_register);
-                    produce_machine_code("mflo", -1, -1, get_register_number(result_register), -1, output);
+                    emit_code(output, "    mflo %s\n", result_register);
+                    produce_machine_code(ctx, OP_MFLO, -1, -1, get_register_number(result_register), -1, output);
                 }
                 
-                release_register_by_name(left_register);
-                release_register_by_name(right_register);
+                if (right_scratch) release_register_by_name(ctx, right_scratch);
             }
             break;
         
@@ -1145,123 +2281,217 @@ void generate_expression_code(ASTNode* node, FILE* output, const char* result_re
     }
 }
 
-void generate_unary_operation_code(ASTNode* node, FILE* output) {
+void generate_unary_operation_code(CompilerContext* ctx, ASTNode* node, CodeBuffer* output) {
     if (!node || !node->left_child) return;
     
     if (node->left_child->node_type == VARIABLE_NODE) {
-        const char* variable_name = node->left_child->token_info.text;
-        Symbol* variable = find_variable(variable_name);
+        Symbol* variable = find_variable(ctx, node->left_child->token_info);
         if (!variable) return;
         
-        const char* temp_reg = get_register();
+        if (variable->home_register) {
+            const char* home = ctx->register_pool.available_registers[variable->home_register];
+            if (node->token_info.type == INCREMENT || node->token_info.type == DECREMENT) {
+                int step = node->token_info.type == INCREMENT ? 1 : -1;
+                emit_code(output, "    daddiu %s, %s, %d\n", home, home, step);
+                produce_machine_code(ctx, OP_DADDIU, variable->home_register,
+                                   variable->home_register, -1, step, output);
+            } else if (node->token_info.type == MINUS) {
+                emit_code(output, "    dsubu %s, r0, %s\n", home, home);
+                produce_machine_code(ctx, OP_DSUBU, 0, variable->home_register,
+                                   variable->home_register, -1, output);
+            } else {
+                return;
+            }
+            variable->is_dirty = true;
+            variable->is_normalized = false;
+            return;
+        }
+        
+        const char* temp_reg = get_register(ctx);
         
-        fprintf(output, "    lb %s, %d(r0)\n", temp_reg, variable->memory_location);
-        produce_machine_code("lb", 0, get_register_number(temp_reg), 
+        emit_code(output, "    lb %s, %d(r0)\n", temp_reg, variable->memory_location);
+        produce_machine_code(ctx, OP_LB, 0, get_register_number(temp_reg), 
                            -1, variable->memory_location, output);
         
-        if (strcmp(node->token_info.text, "++") == 0) {
-            fprintf(output, "    daddiu %s, %s, 1\n", temp_reg, temp_reg);
-            produce_machine_code("daddiu", get_register_number(temp_reg), 
+        if (node->token_info.type == INCREMENT) {
+            emit_code(output, "    daddiu %s, %s, 1\n", temp_reg, temp_reg);
+            produce_machine_code(ctx, OP_DADDIU, get_register_number(temp_reg), 
                                get_register_number(temp_reg), -1, 1, output);
-        } else if (strcmp(node->token_info.text, "--") == 0) {
-            fprintf(output, "    daddiu %s, %s, -1\n", temp_reg, temp_reg);
-            produce_machine_code("daddiu", get_register_number(temp_reg), 
+        } else if (node->token_info.type == DECREMENT) {
+            emit_code(output, "    daddiu %s, %s, -1\n", temp_reg, temp_reg);
+            produce_machine_code(ctx, OP_DADDIU, get_register_number(temp_reg), 
                                get_register_number(temp_reg), -1, -1, output);
-        } else if (strcmp(node->token_info.text, "+") == 0) {
-        } else if (strcmp(node->token_info.text, "-") == 0) {
-            fprintf(output, "    dsubu %s, r0, %s\n", temp_reg, temp_reg);
-            produce_machine_code("dsubu", 0, get_register_number(temp_reg), 
+        } else if (node->token_info.type == PLUS) {
+        } else if (node->token_info.type == MINUS) {
+            emit_code(output, "    dsubu %s, r0, %s\n", temp_reg, temp_reg);
+            produce_machine_code(ctx, OP_DSUBU, 0, get_register_number(temp_reg), 
                                get_register_number(temp_reg), -1, output);
         }
         
-        fprintf(output, "    sb %s, %d(r0)\n", temp_reg, variable->memory_location);
-        produce_machine_code("sb", 0, get_register_number(temp_reg), 
+        emit_code(output, "    sb %s, %d(r0)\n", temp_reg, variable->memory_location);
+        produce_machine_code(ctx, OP_SB, 0, get_register_number(temp_reg), 
                            -1, variable->memory_location, output);
         
-        release_register_by_name(temp_reg);
+        release_register_by_name(ctx, temp_reg);
+    }
+}
+
+// Compound assignment to a variable that lives in a register: the operation
+// writes the register directly
+void generate_register_compound_assignment(CompilerContext* ctx, Symbol* variable, ASTNode* expression,
+                                           TokenType operator, CodeBuffer* output) {
+    bool saved_full_width = ctx->register_allocation.full_width_reads;
+    if (operator == DIVIDE_ASSIGN) ctx->register_allocation.full_width_reads = true;
+    
+    const char* home = variable_register(ctx, variable, output);
+    const char* old_value = home;
+    const char* snapshot = NULL;
+    if (expression_uses_variable(ctx, expression, variable, true)) {
+        // The expression changes the variable, but the old value is the operand
+        snapshot = get_register(ctx);
+        emit_code(output, "    daddu %s, %s, r0\n", snapshot, home);
+        produce_machine_code(ctx, OP_DADDU, variable->home_register, 0,
+                           get_register_number(snapshot), -1, output);
+        old_value = snapshot;
+    }
+    
+    const char* value_scratch = NULL;
+    const char* value_register = resident_operand(ctx, expression, NULL, output);
+    if (!value_register) {
+        value_scratch = get_register(ctx);
+        generate_expression_code(ctx, expression, output, value_scratch);
+        value_register = value_scratch;
+    }
+    ctx->register_allocation.full_width_reads = saved_full_width;
+    
+    if (operator == PLUS_ASSIGN) {
+        emit_code(output, "    daddu %s, %s, %s\n", home, old_value, value_register);
+        produce_machine_code(ctx, OP_DADDU, get_register_number(old_value), 
+                           get_register_number(value_register), variable->home_register, -1, output);
+    } else if (operator == MINUS_ASSIGN) {
+        emit_code(output, "    dsubu %s, %s, %s\n", home, old_value, value_register);
+        produce_machine_code(ctx, OP_DSUBU, get_register_number(old_value), 
+                           get_register_number(value_register), variable->home_register, -1, output);
+    } else if (operator == MULTIPLY_ASSIGN || operator == DIVIDE_ASSIGN) {
+        Opcode opcode = operator == MULTIPLY_ASSIGN ? OP_DMULU : OP_DDIVU;
+        emit_code(output, "    %s %s, %s\n", supported_instructions[opcode].instruction_name,
+                  old_value, value_register);
+        produce_machine_code(ctx, opcode, get_register_number(old_value), 
+                           get_register_number(value_register), -1, -1, output);
+        emit_code(output, "    mflo %s\n", home);
+        produce_machine_code(ctx, OP_MFLO, -1, -1, variable->home_register, -1, output);
     }
+    variable->is_dirty = true;
+    variable->is_normalized = false;
+    
+    if (snapshot) release_register_by_name(ctx, snapshot);
+    if (value_scratch) release_register_by_name(ctx, value_scratch);
 }
 
-void generate_compound_assignment_code(const char* variable_name, ASTNode* expression, 
-                                      const char* operator, FILE* output) {
-    Symbol* variable = find_variable(variable_name);
+void generate_compound_assignment_code(CompilerContext* ctx, Token variable_name, ASTNode* expression, 
+                                      TokenType operator, CodeBuffer* output) {
+    Symbol* variable = find_variable(ctx, variable_name);
     if (!variable) return;
     
-    const char* result_reg = get_register();
-    const char* temp_reg = get_register();
-    const char* mflo_temp_reg = get_register();
+    if (variable->home_register) {
+        generate_register_compound_assignment(ctx, variable, expression, operator, output);
+        return;
+    }
+    
+    const char* result_reg = get_register(ctx);
+    const char* temp_reg = get_register(ctx);
+    const char* mflo_temp_reg = get_register(ctx);
     
-    fprintf(output, "    lb %s, %d(r0)\n", temp_reg, variable->memory_location);
-    produce_machine_code("lb", 0, get_register_number(temp_reg), 
+    emit_code(output, "    lb %s, %d(r0)\n", temp_reg, variable->memory_location);
+    produce_machine_code(ctx, OP_LB, 0, get_register_number(temp_reg), 
                        -1, variable->memory_location, output);
     
-    generate_expression_code(expression, output, result_reg);
+    bool saved_full_width = ctx->register_allocation.full_width_reads;
+    if (operator == DIVIDE_ASSIGN) ctx->register_allocation.full_width_reads = true;
+    generate_expression_code(ctx, expression, output, result_reg);
+    ctx->register_allocation.full_width_reads = saved_full_width;
     
-    if (strcmp(operator, "+=") == 0) {
-        fprintf(output, "    daddu %s, %s, %s\n", temp_reg, temp_reg, result_reg);
-        produce_machine_code("daddu", get_register_number(temp_reg), 
+    if (operator == PLUS_ASSIGN) {
+        emit_code(output, "    daddu %s, %s, %s\n", temp_reg, temp_reg, result_reg);
+        produce_machine_code(ctx, OP_DADDU, get_register_number(temp_reg), 
                            get_register_number(result_reg), 
                            get_register_number(temp_reg), -1, output);
-    } else if (strcmp(operator, "-=") == 0) {
-        fprintf(output, "    dsubu %s, %s, %s\n", temp_reg, temp_reg, result_reg);
-        produce_machine_code("dsubu", get_register_number(temp_reg), 
+    } else if (operator == MINUS_ASSIGN) {
+        emit_code(output, "    dsubu %s, %s, %s\n", temp_reg, temp_reg, result_reg);
+        produce_machine_code(ctx, OP_DSUBU, get_register_number(temp_reg), 
                            get_register_number(result_reg), 
                            get_register_number(temp_reg), -1, output);
-    } else if (strcmp(operator, "*=") == 0) {
-        fprintf(output, "    dmulu %s, %s\n", temp_reg, result_reg);
-        produce_machine_code("dmulu", get_register_number(temp_reg), 
+    } else if (operator == MULTIPLY_ASSIGN) {
+        emit_code(output, "    dmulu %s, %s\n", temp_reg, result_reg);
+        produce_machine_code(ctx, OP_DMULU, get_register_number(temp_reg), 
                            get_register_number(result_reg), -1, -1, output);
-        fprintf(output, "    mflo %s\n", mflo_temp_reg);
-        produce_machine_code("mflo", -1, -1, get_register_number(mflo_temp_reg), -1, output);
-        fprintf(output, "    daddu %s, %s, r0\n", temp_reg, mflo_temp_reg);
-        produce_machine_code("daddu", get_register_number(mflo_temp_reg), 0, 
+        emit_code(output, "    mflo %s\n", mflo_temp_reg);
+        produce_machine_code(ctx, OP_MFLO, -1, -1, get_register_number(mflo_temp_reg), -1, output);
+        emit_code(output, "    daddu %s, %s, r0\n", temp_reg, mflo_temp_reg);
+        produce_machine_code(ctx, OP_DADDU, get_register_number(mflo_temp_reg), 0, 
                            get_register_number(temp_reg), -1, output);
-        release_register_by_name(mflo_temp_reg);
-    } else if (strcmp(operator, "/=") == 0) {
-        fprintf(output, "    ddivu %s, %s\n", temp_reg, result_reg);
-        produce_machine_code("ddivu", get_register_number(temp_reg), 
+    } else if (operator == DIVIDE_ASSIGN) {
+        emit_code(output, "    ddivu %s, %s\n", temp_reg, result_reg);
+        produce_machine_code(ctx, OP_DDIVU, get_register_number(temp_reg), 
                            get_register_number(result_reg), -1, -1, output);
-        fprintf(output, "    mflo %s\n", mflo_temp_reg);
-        produce_machine_code("mflo", -1, -1, get_register_number(mflo_temp_reg), -1, output);
-        fprintf(output, "    daddu %s, %s, r0\n", temp_reg, mflo_temp_reg);
-        produce_machine_code("daddu", get_register_number(mflo_temp_reg), 0, 
+        emit_code(output, "    mflo %s\n", mflo_temp_reg);
+        produce_machine_code(ctx, OP_MFLO, -1, -1, get_register_number(mflo_temp_reg), -1, output);
+        emit_code(output, "    daddu %s, %s, r0\n", temp_reg, mflo_temp_reg);
+        produce_machine_code(ctx, OP_DADDU, get_register_number(mflo_temp_reg), 0, 
                            get_register_number(temp_reg), -1, output);
-        release_register_by_name(mflo_temp_reg);
     }
     
-    fprintf(output, "    sb %s, %d(r0)\n", temp_reg, variable->memory_location);
-    produce_machine_code("sb", 0, get_register_number(temp_reg), 
+    emit_code(output, "    sb %s, %d(r0)\n", temp_reg, variable->memory_location);
+    produce_machine_code(ctx, OP_SB, 0, get_register_number(temp_reg), 
                        -1, variable->memory_location, output);
     
-    release_register_by_name(result_reg);
-    release_register_by_name(temp_reg);
+    release_register_by_name(ctx, result_reg);
+    release_register_by_name(ctx, temp_reg);
+    release_register_by_name(ctx, mflo_temp_reg);
 }
 
-void generate_assignment_code(const char* variable_name, ASTNode* expression, FILE* output) {
-    Symbol* variable = find_variable(variable_name);
+void generate_assignment_code(CompilerContext* ctx, Token variable_name, ASTNode* expression, CodeBuffer* output) {
+    Symbol* variable = find_variable(ctx, variable_name);
     if (!variable) {
-        fprintf(output, "    # error: variable %s not found\n", variable_name);
+        emit_code(output, "    # error: variable %.*s not found\n", variable_name.length, variable_name.text);
+        return;
+    }
+    
+    if (variable->home_register) {
+        const char* home = ctx->register_pool.available_registers[variable->home_register];
+        if (expression_uses_variable(ctx, expression, variable, false)) {
+            // Computing into home would clobber a value the expression still reads
+            const char* scratch = get_register(ctx);
+            generate_expression_code(ctx, expression, output, scratch);
+            emit_code(output, "    daddu %s, %s, r0\n", home, scratch);
+            produce_machine_code(ctx, OP_DADDU, get_register_number(scratch), 0,
+                               variable->home_register, -1, output);
+            release_register_by_name(ctx, scratch);
+        } else {
+            generate_expression_code(ctx, expression, output, home);
+        }
+        variable->is_normalized = holds_byte_value(ctx, expression);
+        variable->is_dirty = true;
         return;
     }
     
-    const char* result_register = get_register();
+    const char* result_register = get_register(ctx);
     
-    generate_expression_code(expression, output, result_register);
+    generate_expression_code(ctx, expression, output, result_register);
     
-    fprintf(output, "    sb %s, %d(r0)\n", result_register, variable->memory_location);
-    produce_machine_code("sb", 0, get_register_number(result_register), 
+    emit_code(output, "    sb %s, %d(r0)\n", result_register, variable->memory_location);
+    produce_machine_code(ctx, OP_SB, 0, get_register_number(result_register), 
                         -1, variable->memory_location, output);
     
-    release_register_by_name(result_register);
+    release_register_by_name(ctx, result_register);
 }
 
-void generate_assembly_code(ASTNode* node, FILE* output) {
+void generate_assembly_code(CompilerContext* ctx, ASTNode* node, CodeBuffer* output) {
     if (!node) return;
     
-    static int code_section_emitted = 0;
-    if (!code_section_emitted) {
-        fprintf(output, ".code\n");
-        code_section_emitted = 1;
+    if (!ctx->code_section_emitted) {
+        emit_code(output, ".code\n");
+        ctx->code_section_emitted = 1;
     }
     
     ASTNode* current = node;
@@ -1269,10 +2499,10 @@ void generate_assembly_code(ASTNode* node, FILE* output) {
         if (current->node_type == DECLARATION_NODE) {
             if (current->left_child) {
                 if (current->left_child->node_type == VARIABLE_NODE) {
-                    Symbol* variable = find_variable(current->left_child->token_info.text);
+                    Symbol* variable = find_variable(ctx, current->left_child->token_info);
                     if (variable) {
-                        fprintf(output, "    sb r0, %d(r0)\n", variable->memory_location);
-                        produce_machine_code("sb", 0, 0, -1, variable->memory_location, output);
+                        emit_code(output, "    sb r0, %d(r0)\n", variable->memory_location);
+                        produce_machine_code(ctx, OP_SB, 0, 0, -1, variable->memory_location, output);
                     }
                 }
             }
@@ -1281,53 +2511,223 @@ void generate_assembly_code(ASTNode* node, FILE* output) {
     }
     
     current = node;
+    int statement_index = 0;
     while (current) {
+        begin_live_ranges(ctx, current, statement_index, output);
         switch (current->node_type) {
             case DECLARATION_NODE:
                 if (current->left_child) {
                     if (current->left_child->node_type == ASSIGNMENT_NODE) {
-                        generate_assignment_code(current->left_child->token_info.text, 
+                        generate_assignment_code(ctx, current->left_child->token_info, 
                                                 current->left_child->left_child, output);
                     }
                 }
                 break;
                 
             case ASSIGNMENT_NODE:
-                generate_assignment_code(current->token_info.text, current->left_child, output);
+                generate_assignment_code(ctx, current->token_info, current->left_child, output);
                 break;
                 
             case COMPOUND_ASSIGN_NODE:
                 if (current->left_child && current->left_child->node_type == VARIABLE_NODE) {
-                    generate_compound_assignment_code(current->left_child->token_info.text, 
-                                                    current->right_child, current->token_info.text, output);
+                    generate_compound_assignment_code(ctx, current->left_child->token_info, 
+                                                    current->right_child, current->token_info.type, output);
                 }
                 break;
                 
             case UNARY_NODE:
-                generate_unary_operation_code(current, output);
+                generate_unary_operation_code(ctx, current, output);
                 break;
                 
             default:
                 break;
         }
+        end_live_ranges(ctx, statement_index, output);
         
         current = current->next;
+        statement_index++;
     }
 }
 
-void show_generated_code(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("could not open the generated file\n");
-        return;
+// --- Peephole Optimization ---
+//
+// The program is straight-line code and every variable access is an lb or
+// sb at a fixed offset from r0, so a forward pass can follow which register
+// still holds each variable's byte and a backward pass can see which stores
+// are overwritten before anything reads them:
+//   - an lb of a byte that a register still holds becomes a move, or is
+//     dropped when it would reload the register the byte came from;
+//   - a move whose target the next instruction increments in place is folded
+//     into that daddiu;
+//   - an sb that a later sb to the same byte overwrites is dropped.
+// Only registers known to hold a sign-extended byte, which is what lb would
+// have given, are forwarded, so no full-width value changes.
+
+// Register the instruction writes, -1 for none
+int instruction_destination(const PendingInstruction* instruction) {
+    switch (supported_instructions[instruction->opcode].instruction_format) {
+        case FORMAT_I: return instruction->opcode == OP_SB ? -1 : instruction->target_reg;
+        case FORMAT_MUL_DIV: return -1;
+        default: return instruction->dest_reg;
     }
-    
-    char line[256];
-    // printf("\ngenerated assembly and machine code:\n");
-    while (fgets(line, sizeof(line), file)) {
-        printf("%s", line);
+}
+
+// Whether the register the instruction writes ends up holding what lb would give
+bool produces_byte_value(const PendingInstruction* instruction, const bool* normalized) {
+    switch (instruction->opcode) {
+        case OP_LB:
+            return true;
+        case OP_DADDIU:
+            return instruction->source_reg == 0 &&
+                   instruction->immediate_value >= -128 && instruction->immediate_value <= 127;
+        case OP_DADDU:
+            return instruction->target_reg == 0 && normalized[instruction->source_reg];
+        case OP_DSRA32:
+            return instruction->immediate_value >= 24;
+        default:
+            return false;
+    }
+}
+
+// Variable slot an lb or sb accesses, -1 for any other instruction
+int accessed_slot(const PendingInstruction* instruction, int slot_count) {
+    if (instruction->opcode != OP_LB && instruction->opcode != OP_SB) return -1;
+    if (instruction->source_reg != 0 || instruction->immediate_value < 0 ||
+        instruction->immediate_value % 8 != 0 || instruction->immediate_value / 8 >= slot_count) return -1;
+    return instruction->immediate_value / 8;
+}
+
+void rewrite_instruction(CompilerContext* ctx, PendingInstruction* instruction, Opcode opcode,
+                         int source_reg, int target_reg, int dest_reg, int immediate_value) {
+    CodeBuffer* text = &ctx->instructions.rewritten_text;
+    size_t start = text->length;
+    if (opcode == OP_DADDU) {
+        emit_code(text, "    daddu r%d, r%d, r%d\n", dest_reg, source_reg, target_reg);
+    } else {
+        emit_code(text, "    daddiu r%d, r%d, %d\n", target_reg, source_reg, immediate_value);
+    }
+    instruction->opcode = opcode;
+    instruction->source_reg = source_reg;
+    instruction->target_reg = target_reg;
+    instruction->dest_reg = dest_reg;
+    instruction->immediate_value = immediate_value;
+    instruction->rewritten_start = (long)start;
+    instruction->rewritten_length = (int)(text->length - start);
+}
+
+void forward_stored_values(CompilerContext* ctx, int slot_count, int* slot_register, unsigned int* slot_version) {
+    InstructionList* list = &ctx->instructions;
+    unsigned int register_version[32] = {0};
+    bool normalized[32] = {true};  // r0
+    PendingInstruction* previous = NULL;
+    for (int i = 0; i < slot_count; i++) slot_register[i] = -1;
+
+    for (int i = 0; i < list->count; i++) {
+        PendingInstruction* instruction = &list->items[i];
+        int slot = accessed_slot(instruction, slot_count);
+
+        if (instruction->opcode == OP_SB) {
+            if (slot >= 0) {
+                bool forwardable = normalized[instruction->target_reg];
+                slot_register[slot] = forwardable ? instruction->target_reg : -1;
+                slot_version[slot] = register_version[instruction->target_reg];
+            }
+            previous = instruction;
+            continue;
+        }
+
+        if (slot >= 0) {
+            int holder = slot_register[slot];
+            if (holder >= 0 && slot_version[slot] == register_version[holder]) {
+                if (holder == instruction->target_reg) {
+                    instruction->removed = true;
+                    continue;
+                }
+                rewrite_instruction(ctx, instruction, OP_DADDU, holder, 0, instruction->target_reg, -1);
+                slot = -1;
+            }
+        }
+
+        if (instruction->opcode == OP_DADDIU && previous && previous->opcode == OP_DADDU &&
+            previous->target_reg == 0 && previous->dest_reg == instruction->target_reg &&
+            instruction->source_reg == instruction->target_reg) {
+            previous->removed = true;
+            rewrite_instruction(ctx, instruction, OP_DADDIU, previous->source_reg, instruction->target_reg,
+                                -1, instruction->immediate_value);
+        }
+
+        int destination = instruction_destination(instruction);
+        if (destination > 0) {
+            bool byte_value = produces_byte_value(instruction, normalized);
+            register_version[destination]++;
+            normalized[destination] = byte_value;
+            if (slot >= 0) {
+                slot_register[slot] = destination;
+                slot_version[slot] = register_version[destination];
+            }
+        }
+        previous = instruction;
+    }
+}
+
+void remove_dead_stores(CompilerContext* ctx, int slot_count, int* overwritten) {
+    InstructionList* list = &ctx->instructions;
+    memset(overwritten, 0, slot_count * sizeof(int));
+    for (int i = list->count - 1; i >= 0; i--) {
+        PendingInstruction* instruction = &list->items[i];
+        int slot = accessed_slot(instruction, slot_count);
+        if (instruction->removed || slot < 0) continue;
+        if (instruction->opcode == OP_LB) {
+            overwritten[slot] = 0;
+        } else if (overwritten[slot]) {
+            instruction->removed = true;
+        } else {
+            overwritten[slot] = 1;
+        }
+    }
+}
+
+// The pass only removes work, so when its scratch arrays cannot be had the
+// instructions are simply rendered as generated
+void optimize_instruction_stream(CompilerContext* ctx) {
+    int slot_count = ctx->next_memory_location / 8 + 1;
+    int* slot_register = malloc(slot_count * sizeof(int));
+    unsigned int* slot_version = malloc(slot_count * sizeof(unsigned int));
+    if (slot_register && slot_version) {
+        forward_stored_values(ctx, slot_count, slot_register, slot_version);
+        remove_dead_stores(ctx, slot_count, slot_register);
+    }
+    free(slot_register);
+    free(slot_version);
+}
+
+// Writes each surviving instruction followed by its machine code, keeping
+// the other lines of assembly_text (the section header) where they were
+void render_listing(CompilerContext* ctx, CodeBuffer* listing) {
+    InstructionList* list = &ctx->instructions;
+    const CodeBuffer* text = &list->assembly_text;
+    if (text->out_of_memory || list->rewritten_text.out_of_memory) listing->out_of_memory = true;
+
+    size_t copied = 0;
+    for (int i = 0; i < list->count; i++) {
+        const PendingInstruction* instruction = &list->items[i];
+        emit_bytes(listing, text->data + copied, instruction->line_start - copied);
+        copied = instruction->line_start + instruction->line_length;
+        if (instruction->removed) continue;
+        if (instruction->rewritten_start >= 0) {
+            emit_bytes(listing, list->rewritten_text.data + instruction->rewritten_start,
+                       instruction->rewritten_length);
+        } else {
+            emit_bytes(listing, text->data + instruction->line_start, instruction->line_length);
+        }
+        render_machine_code(ctx, instruction, listing);
     }
-    fclose(file);
+    emit_bytes(listing, text->data + copied, text->length - copied);
+}
+
+void show_generated_code(const CodeBuffer* listing) {
+    // printf("\ngenerated assembly and machine code:\n");
+    write_code_buffer(listing, stdout);
 }
 
 const char* get_token_type_name(TokenType type) {
@@ -1369,6 +2769,7 @@ const char* get_node_type_name(ASTNodeType type) {
         case COMPOUND_ASSIGN_NODE: return "COMPOUND_ASSIGN";
         case CHAR_NODE: return "CHAR";
         case DECLARATION_NODE: return "DECLARATION";
+        case SHIFT_NODE: return "SHIFT";
         default: return "UNKNOWN";
     }
 }
@@ -1378,10 +2779,10 @@ void display_program_structure(ASTNode *node, int depth) {
 
     for (int i = 0; i < depth; i++) printf("  ");
 
-    printf("node type: %-12s | token: %-12s | value: %-8s | line: %d\n",
+    printf("node type: %-12s | token: %-12s | value: %-8.*s | line: %d\n",
            get_node_type_name(node->node_type),
            get_token_type_name(node->token_info.type),
-           node->token_info.text,
+           node->token_info.length, node->token_info.text,
            node->token_info.line_number);
 
     display_program_structure(node->left_child, depth + 1);
@@ -1394,106 +2795,603 @@ void display_program_structure(ASTNode *node, int depth) {
     }
 }
 
-void compile_program(const char* source_code, const char* output_filename) {
-    current_token_count = 0;
-    current_token_position = 0;
-    symbols_found = 0;
-    next_memory_location = 0;
-    error_log.error_count = 0;
-    clear_registers();
+// --- Compile Statistics ---
+
+double elapsed_seconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+void start_phase(CompilerContext* ctx) {
+    if (ctx->stats.enabled) timespec_get(&ctx->stats.phase_start, TIME_UTC);
+}
+
+// Charges the time since the previous start_phase or end_phase to phase
+void end_phase(CompilerContext* ctx, CompilePhase phase) {
+    if (!ctx->stats.enabled) return;
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    ctx->stats.phase_milliseconds[phase] += 1000 * elapsed_seconds(ctx->stats.phase_start, now);
+    ctx->stats.phase_start = now;
+}
+
+int count_emitted_instructions(CompilerContext* ctx) {
+    int emitted = 0;
+    for (int i = 0; i < ctx->instructions.count; i++) {
+        if (!ctx->instructions.items[i].removed) emitted++;
+    }
+    return emitted;
+}
+
+// Appends the JSON string for text, escaping what JSON requires
+void emit_json_string(CodeBuffer* output, const char* text) {
+    emit_bytes(output, "\"", 1);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            emit_code(output, "\\%c", *c);
+        } else if ((unsigned char)*c < 0x20) {
+            emit_code(output, "\\u%04x", (unsigned char)*c);
+        } else {
+            emit_bytes(output, c, 1);
+        }
+    }
+    emit_bytes(output, "\"", 1);
+}
+
+// One JSON object on one line, so a log collector can take it as it is.
+// source names the input and is left out when NULL.
+void format_stats_line(CompilerContext* ctx, const char* source, bool compiled, CodeBuffer* line) {
+    static const char* phase_names[PHASE_COUNT] = {
+        "lex", "parse", "semantic", "optimize", "codegen", "output"
+    };
+    emit_code(line, "{");
+    if (source) {
+        emit_code(line, "\"source\":");
+        emit_json_string(line, source);
+        emit_code(line, ",");
+    }
+    emit_code(line, "\"compiled\":%s", compiled ? "true" : "false");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        emit_code(line, ",\"%s_ms\":%.3f", phase_names[i], ctx->stats.phase_milliseconds[i]);
+    }
+    emit_code(line, ",\"tokens\":%d,\"ast_nodes\":%d,\"symbols\":%d,\"instructions\":%d,"
+              "\"spilled_registers\":%d,\"bytes_written\":%lu}\n",
+              ctx->current_token_count, ctx->stats.ast_nodes, ctx->symbols_found,
+              count_emitted_instructions(ctx), ctx->stats.spilled_registers,
+              (unsigned long)ctx->stats.bytes_written);
+}
+
+void report_stats(CompilerContext* ctx, const char* source, bool compiled, FILE* output) {
+    CodeBuffer line = {0};
+    format_stats_line(ctx, source, compiled, &line);
+    write_code_buffer(&line, output);
+    free(line.data);
+}
+
+// Parses the value of --emit
+bool parse_emit_target(const char* name, EmitTarget* target) {
+    if (strcmp(name, "file") == 0) *target = EMIT_FILE;
+    else if (strcmp(name, "stdout") == 0) *target = EMIT_STDOUT;
+    else if (strcmp(name, "both") == 0) *target = EMIT_BOTH;
+    else return false;
+    return true;
+}
+
+// Parses the value of --unused
+bool parse_unused_variables(const char* name, bool* drop) {
+    if (strcmp(name, "keep") == 0) *drop = false;
+    else if (strcmp(name, "drop") == 0) *drop = true;
+    else return false;
+    return true;
+}
+
+// Parses the value of --stats
+bool parse_stats_mode(const char* name, bool* enabled) {
+    if (strcmp(name, "off") == 0) *enabled = false;
+    else if (strcmp(name, "json") == 0) *enabled = true;
+    else return false;
+    return true;
+}
+
+// Parses the value of --format
+bool parse_machine_code_format(const char* name, MachineCodeFormat* format) {
+    if (strcmp(name, "binary") == 0) *format = MACHINE_CODE_BINARY;
+    else if (strcmp(name, "hex") == 0) *format = MACHINE_CODE_HEX;
+    else if (strcmp(name, "raw-le") == 0) *format = MACHINE_CODE_RAW_LE;
+    else if (strcmp(name, "raw-be") == 0) *format = MACHINE_CODE_RAW_BE;
+    else return false;
+    return true;
+}
+
+CompilerContext* create_compiler_context() {
+    CompilerContext* ctx = calloc(1, sizeof(CompilerContext));
+    if (!ctx) {
+        fprintf(stderr, "cannot allocate compiler context\n");
+        return NULL;
+    }
+    ctx->report_output = stdout;
+    return ctx;
+}
+
+void reset_compiler_context(CompilerContext* ctx) {
+    ctx->current_token_count = 0;
+    ctx->current_token_position = 0;
+    ctx->symbols_found = 0;
+    if (ctx->symbol_slots) memset(ctx->symbol_slots, 0, ctx->slot_capacity * sizeof(int));
+    ctx->next_memory_location = 0;
+    ctx->error_log.error_count = 0;
+    ctx->code_section_emitted = 0;
+    ctx->error_heading = NULL;
+    ctx->stats = (CompileStats){.enabled = ctx->stats.enabled};
+    clear_code_buffer(&ctx->code_output);
+    clear_code_buffer(&ctx->object_output);
+    ctx->instructions.count = 0;
+    clear_code_buffer(&ctx->instructions.assembly_text);
+    clear_code_buffer(&ctx->instructions.rewritten_text);
+    arena_reset(&ctx->node_arena);
+    clear_registers(ctx);
+}
+
+void destroy_compiler_context(CompilerContext* ctx) {
+    arena_release(&ctx->node_arena);
+    free(ctx->code_output.data);
+    free(ctx->object_output.data);
+    free(ctx->instructions.items);
+    free(ctx->instructions.assembly_text.data);
+    free(ctx->instructions.rewritten_text.data);
+    free(ctx->all_tokens);
+    free(ctx->symbol_table);
+    free(ctx->symbol_slots);
+    free(ctx->register_allocation.ranges);
+    free(ctx->register_allocation.ended);
+    free(ctx);
+}
+
+// Drops every AST node of the current compile at once; the blocks stay
+// with the context for the next compile
+void release_program_tree(CompilerContext* ctx) {
+    arena_reset(&ctx->node_arena);
+}
+
+ASTNode* analyze_program(CompilerContext* ctx, const char* source_code) {
+    reset_compiler_context(ctx);
+    start_phase(ctx);
     
-    break_into_tokens(source_code);
-    if (error_log.error_count) {
-        printf("\nlexical errors found:\n");
-        display_errors();
-        return;
+    break_into_tokens(ctx, source_code);
+    end_phase(ctx, PHASE_LEX);
+    if (ctx->error_log.error_count) {
+        report_errors(ctx, "\nlexical errors found:\n");
+        return NULL;
     }
     
-    ASTNode* program_structure = parse_program();
-    if (error_log.error_count || !program_structure) {
-        printf("syntax errors found:\n");
-        display_errors();
-        free_program_tree(program_structure);
-        return;
+    ASTNode* program_structure = parse_program(ctx);
+    end_phase(ctx, PHASE_PARSE);
+    if (ctx->error_log.error_count || !program_structure) {
+        report_errors(ctx, "syntax errors found:\n");
+        release_program_tree(ctx);
+        return NULL;
     }
     
-    check_program_semantics(program_structure);
-    check_for_unused_variables();
-    if (error_log.error_count) {
-        printf("semantic errors found:\n");
-        display_errors();
-        free_program_tree(program_structure);
-        return;
+    check_program_semantics(ctx, program_structure);
+    check_for_unused_variables(ctx);
+    end_phase(ctx, PHASE_SEMANTIC);
+    if (ctx->error_log.error_count) {
+        report_errors(ctx, "semantic errors found:\n");
+        release_program_tree(ctx);
+        return NULL;
     }
 
-    FILE* output_file = fopen(output_filename, "w");
-    if (!output_file) {
-        fprintf(stderr, "cannot create output file: %s\n", output_filename);
-        free_program_tree(program_structure);
-        return;
+    optimize_program(ctx, program_structure);
+    if (ctx->drop_unused_variables) program_structure = eliminate_dead_code(ctx, program_structure);
+    end_phase(ctx, PHASE_OPTIMIZE);
+    return program_structure;
+}
+
+// Allocates registers, generates the instructions and runs the peephole pass
+// over them, then renders the listing into ctx->code_output and drops the
+// tree. Fails, with the errors reported, when an expression needs more
+// registers than are free.
+bool generate_program(CompilerContext* ctx, ASTNode* program_structure) {
+    start_phase(ctx);
+    setup_registers(ctx);
+    allocate_variable_registers(ctx, program_structure);
+    generate_assembly_code(ctx, program_structure, &ctx->instructions.assembly_text);
+    release_program_tree(ctx);
+    if (ctx->error_log.error_count) {
+        end_phase(ctx, PHASE_CODEGEN);
+        clear_code_buffer(&ctx->code_output);
+        clear_code_buffer(&ctx->object_output);
+        report_errors(ctx, "code generation errors found:\n");
+        return false;
     }
-    
-    setup_registers();
-    generate_assembly_code(program_structure, output_file);
-    fclose(output_file);
-    
+    optimize_instruction_stream(ctx);
+    render_listing(ctx, &ctx->code_output);
+    end_phase(ctx, PHASE_CODEGEN);
+    return true;
+}
+
+// The object file sits next to the listing: "output.s" -> "output.bin"
+void object_filename_for(const char* listing_filename, char* buffer, size_t size) {
+    size_t length = strlen(listing_filename);
+    if (length > 2 && strcmp(listing_filename + length - 2, ".s") == 0) length -= 2;
+    snprintf(buffer, size, "%.*s.bin", (int)length, listing_filename);
+}
+
+bool write_object_file(const CodeBuffer* object, const char* filename) {
+    FILE* object_file = fopen(filename, "wb");
+    if (!object_file) {
+        fprintf(stderr, "cannot create object file: %s\n", filename);
+        return false;
+    }
+    bool written = write_code_buffer(object, object_file);
+    fclose(object_file);
+    return written;
+}
+
+// Generates the listing into ctx->code_output, then writes it to
+// output_filename and/or stdout as target asks. The RAW machine code formats
+// always write their object file as well.
+bool compile_program(CompilerContext* ctx, const char* source_code, const char* output_filename,
+                     EmitTarget target) {
+    ASTNode* program_structure = analyze_program(ctx, source_code);
+    if (!program_structure || !generate_program(ctx, program_structure)) return false;
+
+    if (ctx->code_output.out_of_memory || ctx->object_output.out_of_memory) {
+        fprintf(stderr, "not enough memory for the generated code\n");
+        return false;
+    }
+
+    start_phase(ctx);
+    if (ctx->machine_format == MACHINE_CODE_RAW_LE || ctx->machine_format == MACHINE_CODE_RAW_BE) {
+        char object_filename[4096];
+        object_filename_for(output_filename, object_filename, sizeof(object_filename));
+        if (write_object_file(&ctx->object_output, object_filename)) {
+            ctx->stats.bytes_written += ctx->object_output.length;
+        }
+    }
+
+    if (target & EMIT_FILE) {
+        FILE* output_file = fopen(output_filename, "w");
+        if (!output_file) {
+            fprintf(stderr, "cannot create output file: %s\n", output_filename);
+            end_phase(ctx, PHASE_OUTPUT);
+            return false;
+        }
+        if (write_code_buffer(&ctx->code_output, output_file)) ctx->stats.bytes_written += ctx->code_output.length;
+        fclose(output_file);
+    }
+
     // printf("compilation successful! output file: %s\n", output_filename);
-    show_generated_code(output_filename);
-    free_program_tree(program_structure);
+    if (target & EMIT_STDOUT) {
+        show_generated_code(&ctx->code_output);
+        ctx->stats.bytes_written += ctx->code_output.length;
+    }
+    end_phase(ctx, PHASE_OUTPUT);
+    return true;
+}
+
+char* read_source_file(const char* path) {
+    FILE* source_file = fopen(path, "rb");
+    if (!source_file) return NULL;
+
+    fseek(source_file, 0, SEEK_END);
+    long length = ftell(source_file);
+    rewind(source_file);
+
+    char* code = length >= 0 ? malloc(length + 1) : NULL;
+    if (!code) {
+        fclose(source_file);
+        return NULL;
+    }
+    size_t bytes_read = fread(code, 1, length, source_file);
+    code[bytes_read] = '\0';
+    fclose(source_file);
+    return code;
 }
 
 char* read_source_code() {
-    // 1. Allocate memory first
-    char* code = malloc(50000);
+    // 1. If "code.b" exists, load it in a single read
+    char* code = read_source_file("code.b");
+    if (code) return code;
+
+    // 2. Otherwise use Custom Input (stdin), growing the buffer geometrically
+    size_t capacity = 64 * 1024;
+    size_t length = 0;
+    code = malloc(capacity);
     if (!code) {
         printf("Error: Not enough memory to read source code.\n");
         return NULL;
     }
-    code[0] = '\0'; // Initialize empty string
 
-    // 2. Try to open the file "code.b"
-    FILE* source_file = fopen("code.b", "r");
+    size_t count;
+    while ((count = fread(code + length, 1, capacity - length - 1, stdin)) > 0) {
+        length += count;
+        if (length + 1 == capacity) {
+            char* larger = realloc(code, capacity * 2);
+            if (!larger) {
+                printf("Error: Not enough memory to read source code.\n");
+                free(code);
+                return NULL;
+            }
+            code = larger;
+            capacity *= 2;
+        }
+    }
+    code[length] = '\0';
+    return code;
+}
+
+// --- Batch Mode ---
 
-    // 3. Logic: If file exists, use it. If not, use Custom Input (stdin).
-    if (source_file) {
-        // printf("File 'code.b' found. Reading from file...\n");
+typedef struct {
+    char** paths;
+    int path_count;
+    int next_path;
+    int compiled;
+    int failed;
+    MachineCodeFormat machine_format;
+    bool drop_unused_variables;
+    bool collect_stats;
+    pthread_mutex_t lock;
+} BatchQueue;
+
+bool has_source_extension(const char* name) {
+    size_t length = strlen(name);
+    return length > 2 && strcmp(name + length - 2, ".b") == 0;
+}
+
+void add_batch_path(BatchQueue* queue, int* capacity, const char* path) {
+    if (queue->path_count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        queue->paths = realloc(queue->paths, *capacity * sizeof(char*));
+    }
+    queue->paths[queue->path_count] = malloc(strlen(path) + 1);
+    strcpy(queue->paths[queue->path_count], path);
+    queue->path_count++;
+}
+
+// A directory contributes every *.b file inside it; any other path is read
+// as a manifest with one source path per line
+bool collect_batch_paths(BatchQueue* queue, const char* input_path) {
+    int capacity = 0;
+    struct stat info;
+    if (stat(input_path, &info) != 0) {
+        fprintf(stderr, "cannot open batch input: %s\n", input_path);
+        return false;
+    }
+
+    if (S_ISDIR(info.st_mode)) {
+        DIR* directory = opendir(input_path);
+        if (!directory) {
+            fprintf(stderr, "cannot open directory: %s\n", input_path);
+            return false;
+        }
+        struct dirent* entry;
+        char path[4096];
+        while ((entry = readdir(directory)) != NULL) {
+            if (!has_source_extension(entry->d_name)) continue;
+            snprintf(path, sizeof(path), "%s/%s", input_path, entry->d_name);
+            add_batch_path(queue, &capacity, path);
+        }
+        closedir(directory);
     } else {
-        // printf("File 'code.b' not found.\n");
-        // printf(">> Reading from Custom Input (Standard Input).\n");
-        // printf(">> Type your code below. Press Ctrl+D (Linux/Mac) or Ctrl+Z (Windows) on a new line to finish.\n");
-        // printf("------------------------------------------------------------\n");
-        source_file = stdin; // Switch to standard input
-    }
-
-    // 4. Read line by line until End of File (EOF)
-    char line[256];
-    while (fgets(line, sizeof(line), source_file)) {
-        // Safety check to prevent buffer overflow
-        if (strlen(code) + strlen(line) >= 50000) {
-            printf("Error: Source code exceeds maximum size (50,000 characters).\n");
-            break;
+        FILE* manifest = fopen(input_path, "r");
+        if (!manifest) {
+            fprintf(stderr, "cannot open manifest: %s\n", input_path);
+            return false;
+        }
+        char line[4096];
+        while (fgets(line, sizeof(line), manifest)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] == '\0') continue;
+            add_batch_path(queue, &capacity, line);
         }
-        strcat(code, line);
+        fclose(manifest);
     }
+    return true;
+}
 
-    // 5. Clean up
-    // Only close the file if it wasn't stdin (closing stdin can cause issues)
-    if (source_file != stdin) {
-        fclose(source_file);
+bool compile_batch_file(CompilerContext* ctx, const char* path, pthread_mutex_t* lock) {
+    char* source_code = read_source_file(path);
+    if (!source_code) {
+        fprintf(stderr, "%s: cannot read source file\n", path);
+        return false;
     }
 
-    return code;
+    // Tokens and symbols point into source_code, so it has to outlive codegen
+    ASTNode* program_structure = analyze_program(ctx, source_code);
+    bool generated = program_structure && generate_program(ctx, program_structure);
+    free(source_code);
+    if (!generated) {
+        pthread_mutex_lock(lock);
+        for (int i = 0; i < ctx->error_log.error_count; i++) {
+            fprintf(stderr, "%s: Error: %s\n", path, ctx->error_log.error_messages[i]);
+        }
+        if (ctx->stats.enabled) report_stats(ctx, path, false, stderr);
+        pthread_mutex_unlock(lock);
+        return false;
+    }
+
+    size_t length = strlen(path);
+    char* output_filename = malloc(length + 3);
+    strcpy(output_filename, path);
+    if (has_source_extension(output_filename)) output_filename[length - 2] = '\0';
+    strcat(output_filename, ".s");
+
+    start_phase(ctx);
+    FILE* output_file = fopen(output_filename, "w");
+    bool compiled = output_file != NULL && !ctx->code_output.out_of_memory &&
+                    !ctx->object_output.out_of_memory;
+    if (output_file) {
+        if (compiled && write_code_buffer(&ctx->code_output, output_file)) {
+            ctx->stats.bytes_written += ctx->code_output.length;
+        }
+        fclose(output_file);
+    } else {
+        fprintf(stderr, "cannot create output file: %s\n", output_filename);
+    }
+
+    if (compiled && (ctx->machine_format == MACHINE_CODE_RAW_LE || ctx->machine_format == MACHINE_CODE_RAW_BE)) {
+        char object_filename[4096];
+        object_filename_for(output_filename, object_filename, sizeof(object_filename));
+        compiled = write_object_file(&ctx->object_output, object_filename);
+        if (compiled) ctx->stats.bytes_written += ctx->object_output.length;
+    }
+    end_phase(ctx, PHASE_OUTPUT);
+
+    if (ctx->stats.enabled) {
+        pthread_mutex_lock(lock);
+        report_stats(ctx, path, compiled, stderr);
+        pthread_mutex_unlock(lock);
+    }
+
+    free(output_filename);
+    return compiled;
+}
+
+void* run_batch_worker(void* argument) {
+    BatchQueue* queue = argument;
+    CompilerContext* ctx = create_compiler_context();
+    if (!ctx) return NULL;
+    ctx->report_output = NULL;
+    ctx->machine_format = queue->machine_format;
+    ctx->drop_unused_variables = queue->drop_unused_variables;
+    ctx->stats.enabled = queue->collect_stats;
+
+    int compiled = 0, failed = 0;
+    while (1) {
+        pthread_mutex_lock(&queue->lock);
+        int index = queue->next_path++;
+        pthread_mutex_unlock(&queue->lock);
+        if (index >= queue->path_count) break;
+
+        if (compile_batch_file(ctx, queue->paths[index], &queue->lock)) compiled++;
+        else failed++;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    queue->compiled += compiled;
+    queue->failed += failed;
+    pthread_mutex_unlock(&queue->lock);
+
+    destroy_compiler_context(ctx);
+    return NULL;
+}
+
+int default_thread_count() {
+#ifdef _SC_NPROCESSORS_ONLN
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 0) return (int)cores;
+#endif
+    return 4;
+}
+
+int run_batch(const char* input_path, int thread_count, MachineCodeFormat machine_format,
+              bool drop_unused_variables, bool collect_stats) {
+    BatchQueue queue = {0};
+    queue.machine_format = machine_format;
+    queue.drop_unused_variables = drop_unused_variables;
+    queue.collect_stats = collect_stats;
+    pthread_mutex_init(&queue.lock, NULL);
+    if (!collect_batch_paths(&queue, input_path)) return 1;
+
+    if (thread_count < 1) thread_count = default_thread_count();
+    if (thread_count > queue.path_count && queue.path_count > 0) thread_count = queue.path_count;
+
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+
+    pthread_t* threads = malloc(thread_count * sizeof(pthread_t));
+    int started = 0;
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&threads[i], NULL, run_batch_worker, &queue) != 0) break;
+        started++;
+    }
+    if (started == 0) run_batch_worker(&queue);
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+
+    timespec_get(&end, TIME_UTC);
+    double seconds = elapsed_seconds(start, end);
+    int total = queue.compiled + queue.failed;
+
+    printf("batch: %d programs (%d compiled, %d failed) on %d threads in %.3f s, %.1f programs/sec\n",
+           total, queue.compiled, queue.failed, started ? started : 1, seconds,
+           seconds > 0 ? total / seconds : 0.0);
+
+    for (int i = 0; i < queue.path_count; i++) free(queue.paths[i]);
+    free(queue.paths);
+    free(threads);
+    pthread_mutex_destroy(&queue.lock);
+    return queue.failed ? 1 : 0;
 }
 
-int main() {
+void print_usage(const char* program) {
+    printf("Usage: %s [--emit file|stdout|both] [--format binary|hex|raw-le|raw-be] [--unused keep|drop]\n"
+           "          [--stats off|json]\n", program);
+    printf("       %s --batch <directory|manifest> [--jobs N] [--format ...] [--unused ...] [--stats ...]\n",
+           program);
+    printf("The raw formats also write the instruction words to output.bin (<name>.bin in batch mode)\n");
+    printf("--unused drop removes stores to variables that are never read and packs the rest\n");
+    printf("--stats json writes phase times and counters of each compile to stderr as a JSON line\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char* batch_input = NULL;
+    int thread_count = 0;
+    EmitTarget target = EMIT_BOTH;
+    MachineCodeFormat machine_format = MACHINE_CODE_BINARY;
+    bool drop_unused_variables = false;
+    bool collect_stats = false;
+
+    for (int i = 1; i < argc; i += 2) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool valid = value != NULL;
+        if (!valid) {
+            // every option takes a value
+        } else if (strcmp(option, "--batch") == 0) {
+            batch_input = value;
+        } else if (strcmp(option, "--jobs") == 0) {
+            thread_count = atoi(value);
+        } else if (strcmp(option, "--emit") == 0) {
+            valid = parse_emit_target(value, &target);
+        } else if (strcmp(option, "--format") == 0) {
+            valid = parse_machine_code_format(value, &machine_format);
+        } else if (strcmp(option, "--unused") == 0) {
+            valid = parse_unused_variables(value, &drop_unused_variables);
+        } else if (strcmp(option, "--stats") == 0) {
+            valid = parse_stats_mode(value, &collect_stats);
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (batch_input) {
+        return run_batch(batch_input, thread_count, machine_format, drop_unused_variables, collect_stats);
+    }
+
     // printf("submitted by kian and charls\n");
     
     char* source_code = read_source_code();
     if (!source_code) return 1;
+
+    CompilerContext* ctx = create_compiler_context();
+    if (!ctx) {
+        free(source_code);
+        return 1;
+    }
     
+    ctx->machine_format = machine_format;
+    ctx->drop_unused_variables = drop_unused_variables;
+    ctx->stats.enabled = collect_stats;
     // printf("source code:\n%s\n\n", source_code);
-    compile_program(source_code, "output.s");
+    bool compiled = compile_program(ctx, source_code, "output.s", target);
+    if (collect_stats) report_stats(ctx, NULL, compiled, stderr);
     
+    destroy_compiler_context(ctx);
     free(source_code);
     return 0;
 }
\ No newline at end of file
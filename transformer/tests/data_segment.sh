@@ -0,0 +1,60 @@
+#!/bin/sh
+# Variables are addressed as offset(r0), so their slots have to end within
+# the 32 KB a signed 16-bit offset reaches. Compiles the largest program that
+# fits, 4096 ints, and checks its last slot is at 32760; then checks that one
+# more int is reported instead of getting an offset that wraps around.
+#   sh tests/data_segment.sh   (from transformer/)
+set -e
+here=$(cd "$(dirname "$0")/.." && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+${CC:-gcc} -O2 -o "$work/transformer" "$here/transformer.c" -lm
+${CC:-gcc} -O2 -o "$work/csc112" "$here/csc112.c"
+
+# count ints, each assigned and read
+program() {
+    i=1
+    while [ "$i" -le "$1" ]; do
+        echo "int v$i;"
+        i=$((i + 1))
+    done
+    i=1
+    while [ "$i" -le "$1" ]; do
+        echo "v$i = $i;"
+        echo "v1 = v1 + v$i;"
+        i=$((i + 1))
+    done
+}
+program 4096 > "$work/fits.b"
+program 4097 > "$work/too_many.b"
+
+check() {
+    name=$1
+    fits=$2
+    too_many=$3
+    if grep -q "Error" "$fits"; then
+        grep "Error" "$fits" | head -5
+        echo "FAIL: $name: 4096 variables did not compile"
+        exit 1
+    fi
+    last=$(grep -o "[0-9]*(r0)" "$fits" | sort -n -u | tail -1)
+    if [ "$last" != "32760(r0)" ]; then
+        echo "FAIL: $name: last slot is $last, expected 32760(r0)"
+        exit 1
+    fi
+    if ! grep -q "Too many variables for r0-relative addressing at line 4097" "$too_many"; then
+        echo "FAIL: $name: the 4097th variable was not reported"
+        exit 1
+    fi
+    echo "ok: $name: 4096 variables fit, the 4097th is reported"
+}
+
+"$work/transformer" --emit stdout "$work/fits.b" > "$work/transformer_fits" 2>&1
+"$work/transformer" --emit stdout "$work/too_many.b" > "$work/transformer_too_many" 2>&1
+check transformer "$work/transformer_fits" "$work/transformer_too_many"
+
+# csc112 reads code.b from the current directory, or else stdin
+(cd "$work" && ./csc112 --emit stdout < fits.b > csc112_fits 2>&1)
+(cd "$work" && ./csc112 --emit stdout < too_many.b > csc112_too_many 2>&1)
+check csc112 "$work/csc112_fits" "$work/csc112_too_many"
@@ -0,0 +1,63 @@
+#!/bin/sh
+# Compiles a program with more distinct float literals than the constant
+# pool's initial capacity, each used twice, and checks that it compiles and
+# that .data holds every literal exactly once. The pool is addressed as
+# offset(r0) after the one float variable's slot, so 4095 literals are the
+# most that fit: checks that they compile with the last at 32760, and that
+# one more is reported instead of getting an offset that wraps around.
+#   sh tests/float_constants.sh [literal count]   (from transformer/)
+set -e
+count=${1:-1500}
+here=$(cd "$(dirname "$0")/.." && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+${CC:-gcc} -O2 -o "$work/transformer" "$here/transformer.c" -lm
+
+# 0.5 and n more distinct literals, listing in $work/listing
+compile_floats() {
+    i=1
+    {
+        echo "float f = 0.5;"
+        while [ "$i" -le "$1" ]; do
+            echo "f = f + $i.25;"
+            echo "f = f - $i.25;"
+            i=$((i + 1))
+        done
+    } > "$work/floats.b"
+    "$work/transformer" --emit stdout "$work/floats.b" > "$work/listing" 2>&1
+}
+
+compile_floats "$count"
+if grep -q "Error" "$work/listing"; then
+    grep "Error" "$work/listing" | head -5
+    echo "FAIL: program with $count distinct float literals did not compile"
+    exit 1
+fi
+
+words=$(grep -c "^    \.word " "$work/listing")
+expected=$((count + 1))
+if [ "$words" -ne "$expected" ]; then
+    echo "FAIL: expected $expected pool words, got $words"
+    exit 1
+fi
+echo "ok: $count distinct float literals, $words pool words"
+
+compile_floats 4094
+if grep -q "Error" "$work/listing"; then
+    grep "Error" "$work/listing" | head -5
+    echo "FAIL: 4095 float literals did not compile"
+    exit 1
+fi
+last=$(grep -o "[0-9]*(r0)" "$work/listing" | sort -n -u | tail -1)
+if [ "$last" != "32760(r0)" ]; then
+    echo "FAIL: last pool word is at $last, expected 32760(r0)"
+    exit 1
+fi
+
+compile_floats 4095
+if ! grep -q "Too many float constants for r0-relative addressing" "$work/listing"; then
+    echo "FAIL: the 4096th float literal was not reported"
+    exit 1
+fi
+echo "ok: 4095 float literals fit, the 4096th is reported"
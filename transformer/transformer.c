@@ -5,11 +5,33 @@
 #include <stdbool.h>
 #include <stdarg.h>
 #include <math.h>
-
-#define MAX_NAME_LENGTH 32
-#define MAX_TOKENS 1000
-#define MAX_SYMBOLS 100
+#include <time.h>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define INITIAL_TOKEN_CAPACITY 1024
+#define INITIAL_SYMBOL_CAPACITY 64
 #define MAX_ERRORS 100
+#define INITIAL_CODE_CAPACITY (16 * 1024)
+#define INITIAL_FLOAT_CONSTANT_CAPACITY 64
+#define INITIAL_INSTRUCTION_CAPACITY 1024
+#define DATA_SEGMENT_LIMIT 32768  // .data is addressed as offset(r0), a signed 16-bit offset
 
 // --- Enumerations ---
 
@@ -27,24 +49,49 @@ typedef enum {
     PROGRAM_NODE, ASSIGNMENT_NODE, VARIABLE_NODE,
     NUMBER_NODE, OPERATION_NODE, UNARY_NODE,
     COMPOUND_ASSIGN_NODE, CHAR_NODE, DECLARATION_NODE,
-    FLOAT_NODE
+    FLOAT_NODE,
+    SHIFT_NODE  // left_child shifted by the constant right_child; '*' left, '/' right
 } ASTNodeType;
 
+// Instructions are named by opcode at codegen time; the encoding rules
+// below are looked up by index, so no mnemonic is ever compared
+typedef enum {
+    OP_DADDIU, OP_LB, OP_SB, OP_LD, OP_SD,
+    OP_DADDU, OP_DSUBU, OP_DMULU, OP_DDIVU, OP_MFLO,
+    OP_OR, OP_DSLL, OP_DSRL, OP_DSLL32, OP_DSRA32,
+    OP_L_D, OP_S_D,
+    OP_ADD_D, OP_SUB_D, OP_MUL_D, OP_DIV_D, OP_MOV_D,
+    OP_MFC1, OP_MTC1, OP_DMTC1, OP_DMFC1,
+    OP_CVT_D_W, OP_CVT_D_L, OP_TRUNC_L_D,
+    OP_LUI, OP_ORI,
+    INSTRUCTION_COUNT
+} Opcode;
+
 // --- Structures ---
 
+// Token text is a slice (pointer + length) into the source code, which may be
+// a read-only file mapping, so it is never NUL-terminated on its own
 typedef struct {
     TokenType type;
-    char text[MAX_NAME_LENGTH];
+    const char* text;
+    int length;
     int line_number;
 } Token;
 
 typedef struct {
-    char name[MAX_NAME_LENGTH];
+    const char* name;
+    int name_length;
+    unsigned int name_hash;
     int is_initialized;
     int is_used;
-    int memory_location;
-    int size;
+    int memory_location;  // given by lay_out_variables, -1 = no slot
+    int size;             // slot bytes: 1 for char, 8 for int and float
     char type;  // 'i' for int, 'c' for char, 'f' for float (treated as double)
+    int line_number;      // of the declaration
+    int live_range;       // index into register_allocation.ranges, -1 = not in a register
+    int home_register;    // register given by the allocator, 0 = lives in memory
+    bool is_dirty;        // register is newer than memory
+    bool is_normalized;   // register holds what loading the slot would give
 } Symbol;
 
 typedef struct ASTNode {
@@ -60,6 +107,79 @@ typedef struct {
     char error_messages[MAX_ERRORS][256];
 } ErrorList;
 
+// Source text either mapped straight from the input file or read into a heap
+// buffer. Both forms end in a '\0' the lexer can stop on.
+typedef struct {
+    const char* text;
+    size_t length;
+    void* mapping;  // start of the mapped view, NULL when text was malloc'd
+    size_t mapping_length;
+} SourceBuffer;
+
+// Generated listing, built in memory and written out in one piece once the
+// program has compiled
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    bool out_of_memory;
+} CodeBuffer;
+
+// One instruction as code generation produced it. Its machine code is only
+// rendered once the peephole pass has looked at the whole program.
+typedef struct {
+    Opcode opcode;
+    int source_reg;
+    int target_reg;
+    int dest_reg;
+    int immediate_value;
+    size_t line_start;      // its assembly line in assembly_text
+    size_t line_length;
+    long rewritten_start;   // replacement line in rewritten_text, -1 = none
+    int rewritten_length;
+    bool removed;
+} PendingInstruction;
+
+typedef struct {
+    PendingInstruction* items;
+    int count;
+    int capacity;
+    CodeBuffer assembly_text;   // everything code generation emitted, in order
+    CodeBuffer rewritten_text;  // lines for instructions the peephole pass changed
+} InstructionList;
+
+// How render_machine_code renders each instruction word
+typedef enum {
+    MACHINE_CODE_BINARY,  // ";0110 0100 ..." after each instruction (default)
+    MACHINE_CODE_HEX,     // ";0x64010005" after each instruction
+    MACHINE_CODE_RAW_LE,  // words collected into a little-endian object file
+    MACHINE_CODE_RAW_BE   // words collected into a big-endian object file
+} MachineCodeFormat;
+
+
+typedef enum {
+    EMIT_FILE = 1,
+    EMIT_STDOUT = 2,
+    EMIT_BOTH = EMIT_FILE | EMIT_STDOUT
+} EmitTarget;
+
+// Phases --stats json times, in the order a compile runs them
+typedef enum {
+    PHASE_LEX, PHASE_PARSE, PHASE_SEMANTIC, PHASE_OPTIMIZE, PHASE_CODEGEN, PHASE_OUTPUT,
+    PHASE_COUNT
+} CompilePhase;
+
+// Wall time per phase and the counters that only exist while compiling;
+// the others are read from the globals when the stats line is written
+typedef struct {
+    bool enabled;
+    struct timespec phase_start;
+    double phase_milliseconds[PHASE_COUNT];
+    int ast_nodes;
+    int spilled_registers;  // live ranges the allocator left in memory
+    size_t bytes_written;
+} CompileStats;
+
 typedef struct {
     const char* available_registers[32];
     int next_register_index;
@@ -67,16 +187,61 @@ typedef struct {
     int register_count;
 } RegisterPool;
 
+// Statements from first to last access of one variable, and its register
+typedef struct {
+    int start;
+    int end;
+    int symbol;           // index into symbol_table
+    int home_register;    // 0 = spilled
+} LiveRange;
+
+typedef struct {
+    LiveRange* ranges;              // every accessed variable, ordered by start
+    int range_count;
+    int range_capacity;
+    LiveRange* ended;               // the ranges that got a register, ordered by end
+    int ended_count;
+    int ended_capacity;
+    int next_start;                 // cursors into ranges and ended during codegen
+    int next_end;
+    int statement_line;             // for errors raised during codegen
+    bool out_of_registers;          // reported once per compile
+} RegisterAllocation;
+
+// Distinct float literals, stored as 64-bit words in .data right after the
+// variable slots
+typedef struct {
+    unsigned long long* bits;
+    int count;
+    int capacity;
+    int* slots;                     // open-addressing index: bits index + 1, 0 = empty
+    int slot_capacity;              // always a power of two, twice capacity
+    bool overflowed;                // reported once per compile
+} FloatConstantPool;
+
 // --- Global Variables ---
 
-Token all_tokens[MAX_TOKENS];
+Token* all_tokens = NULL;
 int current_token_count = 0;
+int token_capacity = 0;
 int current_token_position = 0;
-Symbol symbol_table[MAX_SYMBOLS];
+Symbol* symbol_table = NULL;
 int symbols_found = 0;
+int symbol_capacity = 0;
+int* symbol_slots = NULL;   // open-addressing index: symbol_table index + 1, 0 = empty
+int slot_capacity = 0;      // always a power of two, at least twice symbol_capacity
 int next_memory_location = 0;
 ErrorList error_log = {0};
 RegisterPool register_pool = {0};
+RegisterPool float_register_pool = {0};
+RegisterAllocation register_allocation = {0};
+FloatConstantPool float_constant_pool = {0};
+CodeBuffer code_output = {0};
+CodeBuffer object_output = {0};  // raw instruction words for the RAW formats
+InstructionList instruction_list = {0};
+MachineCodeFormat machine_format = MACHINE_CODE_BINARY;
+bool drop_unused_variables = false;  // --unused drop
+CompileStats compile_stats = {0};    // --stats json
 
 // --- Function Prototypes ---
 
@@ -84,140 +249,247 @@ char* get_register(void);
 void release_register_by_name(const char* reg_name);
 const char* get_float_register(void);
 void release_float_register(const char* reg_name);
+void generate_float_expression_code(ASTNode* node, CodeBuffer* output, const char* float_register);
+void record_error(int line_number, const char* message_format, ...);
+unsigned int hash_name(const char* name, int length);
 
 // --- Instruction Table Definitions ---
 
+// How the operand fields are packed into the 32-bit word
+typedef enum {
+    FORMAT_R,              // opcode | rs | rt | rd | 0 | function
+    FORMAT_I,              // opcode | rs | rt | immediate
+    FORMAT_MUL_DIV,        // opcode | rs | rt | 0 | subcode | function
+    FORMAT_MOVE_LO,        // opcode | 0 | 0 | rd | 0 | function
+    FORMAT_SHIFT,          // opcode | 0 | rt | rd | shift | function
+    FORMAT_COP1_MOVE,      // COP1 | subcode | rt | fs | 0
+    FORMAT_COP1_CONVERT,   // COP1 | fmt | 0 | fs | fd | function
+    FORMAT_COP1_ARITH      // COP1 | fmt | ft | fs | fd | function
+} InstructionFormat;
+
 typedef struct {
     const char* instruction_name;
     unsigned int opcode_value;
-    unsigned int instruction_format;
+    InstructionFormat instruction_format;
     unsigned int sub_code;
     unsigned int function_code;
 } Instruction;
 
-Instruction supported_instructions[] = {
+const Instruction supported_instructions[INSTRUCTION_COUNT] = {
     // Integer instructions (I-type / R-type)
-    {"daddiu", 0b011001, 1, 0, 0},
-    {"lb",     0b100000, 1, 0, 0},
-    {"sb",     0b101000, 1, 0, 0},
-    {"daddu",  0b000000, 0, 0, 0b101101},
-    {"dsubu",  0b000000, 0, 0, 0b101111},
-    {"dmulu",  0b000000, 0, 0b00010, 0b011101},
-    {"ddivu",  0b000000, 0, 0b00010, 0b011111},
-    {"mflo",   0b000000, 0, 0, 0b010010},
+    [OP_DADDIU]  = {"daddiu", 0b011001, FORMAT_I, 0, 0},
+    [OP_LB]      = {"lb",     0b100000, FORMAT_I, 0, 0},
+    [OP_SB]      = {"sb",     0b101000, FORMAT_I, 0, 0},
+    [OP_LD]      = {"ld",     0b110111, FORMAT_I, 0, 0},
+    [OP_SD]      = {"sd",     0b111111, FORMAT_I, 0, 0},
+    [OP_DADDU]   = {"daddu",  0b000000, FORMAT_R, 0, 0b101101},
+    [OP_DSUBU]   = {"dsubu",  0b000000, FORMAT_R, 0, 0b101111},
+    [OP_DMULU]   = {"dmulu",  0b000000, FORMAT_MUL_DIV, 0b00010, 0b011101},
+    [OP_DDIVU]   = {"ddivu",  0b000000, FORMAT_MUL_DIV, 0b00010, 0b011111},
+    [OP_MFLO]    = {"mflo",   0b000000, FORMAT_MOVE_LO, 0, 0b010010},
 
     // Logical & Shift
-    {"or",     0b000000, 0, 0, 0b100101}, // R-Type OR
-    {"dsll",   0b000000, 3, 0, 0b111000}, // R-Type Shift Left
+    [OP_OR]      = {"or",     0b000000, FORMAT_R, 0, 0b100101},     // R-Type OR
+    [OP_DSLL]    = {"dsll",   0b000000, FORMAT_SHIFT, 0, 0b111000}, // R-Type Shift Left
+    [OP_DSRL]    = {"dsrl",   0b000000, FORMAT_SHIFT, 0, 0b111010}, // R-Type Shift Right Logical
+    [OP_DSLL32]  = {"dsll32", 0b000000, FORMAT_SHIFT, 0, 0b111100}, // Shift Left by 32 + amount
+    [OP_DSRA32]  = {"dsra32", 0b000000, FORMAT_SHIFT, 0, 0b111111}, // Arithmetic Shift Right by 32 + amount
 
     // Floating point load/store (Double Precision)
-    {"l.d",    0b110101, 1, 0, 0},
-    {"s.d",    0b111101, 1, 0, 0},
+    [OP_L_D]     = {"l.d",    0b110101, FORMAT_I, 0, 0},
+    [OP_S_D]     = {"s.d",    0b111101, FORMAT_I, 0, 0},
 
     // Floating point arithmetic (Double Precision)
-    {"add.d",  0b010001, 2, 0b10001, 0b000000},
-    {"sub.d",  0b010001, 2, 0b10001, 0b000001},
-    {"mul.d",  0b010001, 2, 0b10001, 0b000010},
-    {"div.d",  0b010001, 2, 0b10001, 0b000011},
+    [OP_ADD_D]   = {"add.d",  0b010001, FORMAT_COP1_ARITH, 0b10001, 0b000000},
+    [OP_SUB_D]   = {"sub.d",  0b010001, FORMAT_COP1_ARITH, 0b10001, 0b000001},
+    [OP_MUL_D]   = {"mul.d",  0b010001, FORMAT_COP1_ARITH, 0b10001, 0b000010},
+    [OP_DIV_D]   = {"div.d",  0b010001, FORMAT_COP1_ARITH, 0b10001, 0b000011},
+    [OP_MOV_D]   = {"mov.d",  0b010001, FORMAT_COP1_CONVERT, 0b10001, 0b000110},
 
     // Move instructions
-    {"mfc1",   0b010001, 2, 0b00000, 0b000000}, // Move 32-bit
-    {"mtc1",   0b010001, 2, 0b00100, 0b000000}, // Move 32-bit
-    {"dmtc1",  0b010001, 2, 0b00101, 0b000000}, // Move 64-bit (Double)
+    [OP_MFC1]    = {"mfc1",   0b010001, FORMAT_COP1_MOVE, 0b00000, 0b000000}, // Move 32-bit
+    [OP_MTC1]    = {"mtc1",   0b010001, FORMAT_COP1_MOVE, 0b00100, 0b000000}, // Move 32-bit
+    [OP_DMTC1]   = {"dmtc1",  0b010001, FORMAT_COP1_MOVE, 0b00101, 0b000000}, // Move 64-bit (Double)
+    [OP_DMFC1]   = {"dmfc1",  0b010001, FORMAT_COP1_MOVE, 0b00001, 0b000000}, // Move 64-bit back to an int register
 
     // Conversion instructions
-    {"cvt.d.w",0b010001, 2, 0b10100, 0b100001}, // Convert Word to Double
-    {"cvt.d.l",0b010001, 2, 0b10101, 0b100001}, // Convert Long to Double
+    [OP_CVT_D_W] = {"cvt.d.w", 0b010001, FORMAT_COP1_CONVERT, 0b10100, 0b100001}, // Convert Word to Double
+    [OP_CVT_D_L] = {"cvt.d.l", 0b010001, FORMAT_COP1_CONVERT, 0b10101, 0b100001}, // Convert Long to Double
+    [OP_TRUNC_L_D] = {"trunc.l.d", 0b010001, FORMAT_COP1_CONVERT, 0b10001, 0b001001}, // Double to Long, toward zero
 
     // Immediate instructions
-    {"lui",    0b001111, 1, 0, 0},
-    {"ori",    0b001101, 1, 0, 0}
+    [OP_LUI]     = {"lui",    0b001111, FORMAT_I, 0, 0},
+    [OP_ORI]     = {"ori",    0b001101, FORMAT_I, 0, 0}
 };
 
 // --- Machine Code Generation Functions ---
 
-int find_instruction(const char* instruction_name) {
-    int total_instructions = sizeof(supported_instructions) / sizeof(supported_instructions[0]);
-    for (int i = 0; i < total_instructions; i++) {
-        if (strcmp(supported_instructions[i].instruction_name, instruction_name) == 0) {
-            return i;
-        }
+unsigned int create_instruction_code(Opcode opcode, int source_reg,
+                                     int target_reg, int dest_reg, int immediate_value) {
+    const Instruction* inst = &supported_instructions[opcode];
+
+    switch (inst->instruction_format) {
+        case FORMAT_I:
+            // opcode(6) | rs(5) | rt(5) | immediate(16)
+            return (inst->opcode_value << 26) | (source_reg << 21) | (target_reg << 16) |
+                   (immediate_value & 0xFFFF);
+        case FORMAT_COP1_MOVE:
+            return (inst->opcode_value << 26) | (inst->sub_code << 21) | (target_reg << 16) |
+                   (source_reg << 11) | inst->function_code;
+        case FORMAT_COP1_CONVERT:
+            return (inst->opcode_value << 26) | (inst->sub_code << 21) | (source_reg << 11) |
+                   (dest_reg << 6) | inst->function_code;
+        case FORMAT_COP1_ARITH:
+            return (inst->opcode_value << 26) | (inst->sub_code << 21) | (target_reg << 16) |
+                   (source_reg << 11) | (dest_reg << 6) | inst->function_code;
+        case FORMAT_SHIFT:
+            // source_reg is 'rt', dest_reg is 'rd' and the immediate is the shift amount
+            return (inst->opcode_value << 26) | (source_reg << 16) | (dest_reg << 11) |
+                   ((immediate_value & 0x1F) << 6) | inst->function_code;
+        case FORMAT_MOVE_LO:
+            return (inst->opcode_value << 26) | (dest_reg << 11) | inst->function_code;
+        case FORMAT_MUL_DIV:
+            return (inst->opcode_value << 26) | (source_reg << 21) | (target_reg << 16) |
+                   (inst->sub_code << 6) | inst->function_code;
+        default:
+            return (inst->opcode_value << 26) | (source_reg << 21) | (target_reg << 16) |
+                   (dest_reg << 11) | inst->function_code;
     }
-    return -1;
 }
 
-unsigned int create_instruction_code(const char* instruction_name, int source_reg,
-                                     int target_reg, int dest_reg, int immediate_value) {
-    int instruction_index = find_instruction(instruction_name);
-    if (instruction_index == -1) {
-        printf("Error: Instruction '%s' not found\n", instruction_name);
-        return 0;
-    }
-
-    Instruction inst = supported_instructions[instruction_index];
-
-    if (inst.instruction_format == 1) {
-        // I-type: opcode(6) | rs(5) | rt(5) | immediate(16)
-        unsigned int immediate_16bit = immediate_value & 0xFFFF;
-        unsigned int instruction = (inst.opcode_value << 26) |
-                                   (source_reg << 21) |
-                                   (target_reg << 16) |
-                                   immediate_16bit;
-        return instruction;
-
-    } else if (inst.instruction_format == 2) {
-        // COP1 Format
-        if (strcmp(instruction_name, "mfc1") == 0) {
-            return (inst.opcode_value << 26) | (inst.sub_code << 21) | (target_reg << 16) | (source_reg << 11) | inst.function_code;
-        } else if (strcmp(instruction_name, "mtc1") == 0) {
-            return (inst.opcode_value << 26) | (inst.sub_code << 21) | (target_reg << 16) | (source_reg << 11) | inst.function_code;
-        } else if (strcmp(instruction_name, "dmtc1") == 0) {
-            // dmtc1 rt, fs -> 010001 00101 rt fs 00000000000
-            return (inst.opcode_value << 26) | (inst.sub_code << 21) | (target_reg << 16) | (source_reg << 11) | inst.function_code;
-        } else if (strncmp(instruction_name, "cvt.", 4) == 0) {
-            return (inst.opcode_value << 26) | (inst.sub_code << 21) | (0 << 16) | (source_reg << 11) | (dest_reg << 6) | inst.function_code;
-        } else {
-            // Arithmetic (add.d etc)
-            return (inst.opcode_value << 26) | (inst.sub_code << 21) | (target_reg << 16) | (source_reg << 11) | (dest_reg << 6) | inst.function_code;
-        }
-    } else if (inst.instruction_format == 3) {
-        // Shift Format (dsll): opcode(0) | rs(0) | rt(src) | rd(dest) | sa(shift) | func
-        // Using args: source_reg as 'rt', dest_reg as 'rd', immediate as 'sa'
-        return (inst.opcode_value << 26) | (0 << 21) | (source_reg << 16) | (dest_reg << 11) | ((immediate_value & 0x1F) << 6) | inst.function_code;
-    } else {
-        // R-type: opcode | rs | rt | rd | sa | func
-        if (strcmp(instruction_name, "mflo") == 0) {
-            return (inst.opcode_value << 26) | (0 << 21) | (0 << 16) | (dest_reg << 11) | (0 << 6) | inst.function_code;
-        } else if (strcmp(instruction_name, "or") == 0) {
-            return (inst.opcode_value << 26) | (source_reg << 21) | (target_reg << 16) | (dest_reg << 11) | (0 << 6) | inst.function_code;
-        } else if (strcmp(instruction_name, "dmulu") == 0 || strcmp(instruction_name, "ddivu") == 0) {
-            return (inst.opcode_value << 26) | (source_reg << 21) | (target_reg << 16) | (0 << 11) | (inst.sub_code << 6) | inst.function_code;
-        } else {
-            return (inst.opcode_value << 26) | (source_reg << 21) | (target_reg << 16) | (dest_reg << 11) | (0 << 6) | inst.function_code;
+bool reserve_code_space(CodeBuffer* buffer, size_t extra) {
+    if (buffer->length + extra <= buffer->capacity) return true;
+    if (buffer->out_of_memory) return false;
+
+    size_t capacity = buffer->capacity ? buffer->capacity : INITIAL_CODE_CAPACITY;
+    while (capacity < buffer->length + extra) capacity *= 2;
+    char* data = realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->out_of_memory = true;
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+void emit_bytes(CodeBuffer* buffer, const char* bytes, size_t length) {
+    if (!length || !reserve_code_space(buffer, length)) return;
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+void emit_code(CodeBuffer* buffer, const char* format, ...) {
+    if (!reserve_code_space(buffer, 64)) return;
+    for (;;) {
+        size_t room = buffer->capacity - buffer->length;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer->data + buffer->length, room, format, args);
+        va_end(args);
+        if (written < 0) return;
+        if ((size_t)written < room) {
+            buffer->length += written;
+            return;
         }
+        if (!reserve_code_space(buffer, (size_t)written + 1)) return;
     }
-    return 0;
 }
 
-void display_binary_code(unsigned int value, FILE* output) {
-    fprintf(output, ";");
-    for (int i = 31; i >= 0; i--) {
-        fprintf(output, "%d", (value >> i) & 1);
-        if (i % 4 == 0 && i != 0) fprintf(output, " ");
+void clear_code_buffer(CodeBuffer* buffer) {
+    buffer->length = 0;
+    buffer->out_of_memory = false;
+}
+
+bool write_code_buffer(const CodeBuffer* buffer, FILE* file) {
+    return fwrite(buffer->data, 1, buffer->length, file) == buffer->length;
+}
+
+// Four digits per nibble, so a word is rendered with eight table copies
+static const char nibble_digits[16][4] = {
+    {'0','0','0','0'}, {'0','0','0','1'}, {'0','0','1','0'}, {'0','0','1','1'},
+    {'0','1','0','0'}, {'0','1','0','1'}, {'0','1','1','0'}, {'0','1','1','1'},
+    {'1','0','0','0'}, {'1','0','0','1'}, {'1','0','1','0'}, {'1','0','1','1'},
+    {'1','1','0','0'}, {'1','1','0','1'}, {'1','1','1','0'}, {'1','1','1','1'}
+};
+
+// Emits the whole machine code line (leading space, digits, newline) at once
+void display_binary_code(unsigned int value, CodeBuffer* output) {
+    char line[48] = " ;";
+    int length = sizeof(" ;") - 1;
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        memcpy(line + length, nibble_digits[(value >> shift) & 0xF], 4);
+        length += 4;
+        if (shift) line[length++] = ' ';
     }
+    line[length++] = '\n';
+    emit_bytes(output, line, length);
 }
 
-void produce_machine_code(const char* instruction_name, int source_reg, int target_reg,
-                          int dest_reg, int immediate_value, FILE* output) {
-    unsigned int machine_instruction = create_instruction_code(instruction_name, source_reg,
-                                       target_reg, dest_reg, immediate_value);
-    if (machine_instruction != 0) {
-        fprintf(output, " ");
-        display_binary_code(machine_instruction, output);
-        fprintf(output, "\n");
-    } else {
-        fprintf(output, " ; ERROR: Could not encode instruction '%s'\n", instruction_name);
+void display_hex_code(unsigned int value, CodeBuffer* output) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    char line[24] = " ;" "0x";
+    int length = sizeof(" ;" "0x") - 1;
+    for (int shift = 28; shift >= 0; shift -= 4) line[length++] = hex_digits[(value >> shift) & 0xF];
+    line[length++] = '\n';
+    emit_bytes(output, line, length);
+}
+
+void append_object_word(CodeBuffer* object, unsigned int value, bool big_endian) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) {
+        int shift = big_endian ? 24 - 8 * i : 8 * i;
+        bytes[i] = (unsigned char)(value >> shift);
+    }
+    emit_bytes(object, (const char*)bytes, sizeof(bytes));
+}
+
+void render_machine_code(const PendingInstruction* instruction, CodeBuffer* output) {
+    unsigned int machine_instruction = create_instruction_code(instruction->opcode, instruction->source_reg,
+                                       instruction->target_reg, instruction->dest_reg,
+                                       instruction->immediate_value);
+    if (machine_instruction == 0) {
+        emit_code(output, " ; ERROR: Could not encode instruction '%s'\n",
+                  supported_instructions[instruction->opcode].instruction_name);
+        return;
+    }
+
+    switch (machine_format) {
+        case MACHINE_CODE_BINARY:
+            display_binary_code(machine_instruction, output);
+            break;
+        case MACHINE_CODE_HEX:
+            display_hex_code(machine_instruction, output);
+            break;
+        case MACHINE_CODE_RAW_LE:
+        case MACHINE_CODE_RAW_BE:
+            append_object_word(&object_output, machine_instruction, machine_format == MACHINE_CODE_RAW_BE);
+            break;
+    }
+}
+
+// Records the instruction whose assembly line was just emitted into output
+// (instruction_list.assembly_text); rendering waits for the peephole pass
+void produce_machine_code(Opcode opcode, int source_reg, int target_reg,
+                          int dest_reg, int immediate_value, CodeBuffer* output) {
+    if (instruction_list.count == instruction_list.capacity) {
+        int capacity = instruction_list.capacity ? instruction_list.capacity * 2 : INITIAL_INSTRUCTION_CAPACITY;
+        PendingInstruction* items = realloc(instruction_list.items, capacity * sizeof(PendingInstruction));
+        if (!items) {
+            output->out_of_memory = true;
+            return;
+        }
+        instruction_list.items = items;
+        instruction_list.capacity = capacity;
     }
+
+    size_t line_end = output->length;
+    size_t line_start = line_end ? line_end - 1 : 0;
+    while (line_start > 0 && output->data[line_start - 1] != '\n') line_start--;
+    instruction_list.items[instruction_list.count++] = (PendingInstruction){
+        opcode, source_reg, target_reg, dest_reg, immediate_value,
+        line_start, line_end - line_start, -1, 0, false
+    };
 }
 
 // --- Register Management ---
@@ -237,78 +509,115 @@ int get_register_number(const char* register_name) {
     return 0;
 }
 
+// f1-f31 are handed out from their own pool, so float temporaries never take
+// an integer register away from the expression that needs it
 const char* get_float_register() {
-    static char float_reg[8];
-    for (int i = 1; i < 32; i++) {
-        if (!register_pool.used_registers[i]) {
-            register_pool.used_registers[i] = 1;
-            snprintf(float_reg, sizeof(float_reg), "f%d", i);
-            return float_reg;
+    for (int i = 1; i < float_register_pool.register_count; i++) {
+        if (!float_register_pool.used_registers[i]) {
+            float_register_pool.used_registers[i] = 1;
+            return float_register_pool.available_registers[i];
         }
     }
+    if (!register_allocation.out_of_registers) {
+        record_error(register_allocation.statement_line, "Expression needs more registers than are free");
+        register_allocation.out_of_registers = true;
+    }
     return "f31";
 }
 
 void release_float_register(const char* reg_name) {
-    if (reg_name[0] == 'f' || reg_name[0] == 'F') {
-        int reg_num = atoi(reg_name + 1);
-        if (reg_num >= 1 && reg_num < 32) {
-            register_pool.used_registers[reg_num] = 0;
-        }
+    int reg_num = get_register_number(reg_name);
+    if ((reg_name[0] == 'f' || reg_name[0] == 'F') && reg_num >= 1) {
+        float_register_pool.used_registers[reg_num] = 0;
     }
 }
 
-// Helper to construct 64-bit float constants
-void load_float_constant(double value, const char* float_reg, FILE* output) {
-    unsigned long long bits;
-    memcpy(&bits, &value, sizeof(double));
-
-    // Split into high and low 32-bit chunks
-    unsigned int high_32 = (bits >> 32) & 0xFFFFFFFF;
-    unsigned int low_32 = bits & 0xFFFFFFFF;
-
-    char* r_high = get_register();
-    char* r_low = get_register();
-
-    // 1. Construct High 32-bit part in r_high
-    fprintf(output, "    lui %s, 0x%X\n", r_high, (high_32 >> 16) & 0xFFFF);
-    produce_machine_code("lui", 0, get_register_number(r_high), -1, (high_32 >> 16) & 0xFFFF, output);
-
-    fprintf(output, "    ori %s, %s, 0x%X\n", r_high, r_high, high_32 & 0xFFFF);
-    produce_machine_code("ori", get_register_number(r_high), get_register_number(r_high), -1, high_32 & 0xFFFF, output);
-
-    // 2. Shift r_high left by 32 bits (Two 16-bit shifts because dsll only accepts 0-31)
-    fprintf(output, "    dsll %s, %s, 16\n", r_high, r_high);
-    produce_machine_code("dsll", 0, get_register_number(r_high), get_register_number(r_high), 16, output);
+void free_program_tree(ASTNode* node) {
+    if (!node) return;
+    free_program_tree(node->left_child);
+    free_program_tree(node->right_child);
+    free_program_tree(node->next);
+    free(node);
+}
 
-    fprintf(output, "    dsll %s, %s, 16\n", r_high, r_high);
-    produce_machine_code("dsll", 0, get_register_number(r_high), get_register_number(r_high), 16, output);
+// --- Float Constant Pool ---
 
-    // 3. Construct Low 32-bit part in r_low
-    fprintf(output, "    lui %s, 0x%X\n", r_low, (low_32 >> 16) & 0xFFFF);
-    produce_machine_code("lui", 0, get_register_number(r_low), -1, (low_32 >> 16) & 0xFFFF, output);
+unsigned int hash_float_bits(unsigned long long bits) {
+    return hash_name((const char*)&bits, sizeof(bits));
+}
 
-    fprintf(output, "    ori %s, %s, 0x%X\n", r_low, r_low, low_32 & 0xFFFF);
-    produce_machine_code("ori", get_register_number(r_low), get_register_number(r_low), -1, low_32 & 0xFFFF, output);
+bool grow_float_constant_pool(void) {
+    FloatConstantPool* pool = &float_constant_pool;
+    int capacity = pool->capacity ? pool->capacity * 2 : INITIAL_FLOAT_CONSTANT_CAPACITY;
+    unsigned long long* bits = realloc(pool->bits, capacity * sizeof(unsigned long long));
+    if (!bits) return false;
+    pool->bits = bits;
+    pool->capacity = capacity;
+
+    int* slots = calloc(capacity * 2, sizeof(int));
+    if (!slots) return false;
+    free(pool->slots);
+    pool->slots = slots;
+    pool->slot_capacity = capacity * 2;
+
+    unsigned int mask = pool->slot_capacity - 1;
+    for (int i = 0; i < pool->count; i++) {
+        unsigned int slot = hash_float_bits(pool->bits[i]) & mask;
+        while (pool->slots[slot]) slot = (slot + 1) & mask;
+        pool->slots[slot] = i + 1;
+    }
+    return true;
+}
 
-    // 4. Combine: r_high = r_high | r_low
-    fprintf(output, "    or %s, %s, %s\n", r_high, r_high, r_low);
-    produce_machine_code("or", get_register_number(r_high), get_register_number(r_low), get_register_number(r_high), 0, output);
+// Constants are matched by bit pattern, so 0.0 and -0.0 get their own words
+int float_constant_location(double value) {
+    FloatConstantPool* pool = &float_constant_pool;
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(double));
+    if (pool->slot_capacity) {
+        unsigned int mask = pool->slot_capacity - 1;
+        for (unsigned int slot = hash_float_bits(bits) & mask; pool->slots[slot]; slot = (slot + 1) & mask) {
+            int index = pool->slots[slot] - 1;
+            if (pool->bits[index] == bits) return next_memory_location + 8 * index;
+        }
+    }
 
-    // 5. Move 64-bit value to FPU (dmtc1) - NO CONVERSION NEEDED, IT IS ALREADY A DOUBLE
-    fprintf(output, "    dmtc1 %s, %s\n", r_high, float_reg);
-    produce_machine_code("dmtc1", get_register_number(r_high), get_register_number(float_reg), -1, 0, output);
+    // The pool follows the variables, so it shares their DATA_SEGMENT_LIMIT
+    bool fits = next_memory_location + 8 * (pool->count + 1) <= DATA_SEGMENT_LIMIT;
+    if (!fits || (pool->count == pool->capacity && !grow_float_constant_pool())) {
+        if (!pool->overflowed) {
+            record_error(register_allocation.statement_line, fits ? "Too many different float constants in program"
+                                                                  : "Too many float constants for r0-relative addressing");
+            pool->overflowed = true;
+        }
+        return next_memory_location;
+    }
+    unsigned int mask = pool->slot_capacity - 1;
+    unsigned int slot = hash_float_bits(bits) & mask;
+    while (pool->slots[slot]) slot = (slot + 1) & mask;
+    pool->slots[slot] = pool->count + 1;
+    pool->bits[pool->count] = bits;
+    return next_memory_location + 8 * pool->count++;
+}
 
-    release_register_by_name(r_high);
-    release_register_by_name(r_low);
+// One l.d from the pool, instead of assembling the bits in integer registers
+void load_float_constant(double value, const char* float_reg, CodeBuffer* output) {
+    int location = float_constant_location(value);
+    emit_code(output, "    l.d %s, %d(r0)\n", float_reg, location);
+    produce_machine_code(OP_L_D, 0, get_register_number(float_reg), -1, location, output);
 }
 
-void free_program_tree(ASTNode* node) {
-    if (!node) return;
-    free_program_tree(node->left_child);
-    free_program_tree(node->right_child);
-    free_program_tree(node->next);
-    free(node);
+// The pool is only complete once the code is generated, so the .data section
+// is written when the listing is rendered, ahead of .code
+void emit_data_section(CodeBuffer* output) {
+    if (!float_constant_pool.count) return;
+    emit_code(output, ".data\n");
+    if (next_memory_location) emit_code(output, "    .space %d\n", next_memory_location);
+    for (int i = 0; i < float_constant_pool.count; i++) {
+        double value;
+        memcpy(&value, &float_constant_pool.bits[i], sizeof(double));
+        emit_code(output, "    .word 0x%016llX ; %.15g\n", float_constant_pool.bits[i], value);
+    }
 }
 
 // --- Error Handling ---
@@ -343,15 +652,27 @@ void setup_registers() {
         "r16", "r17", "r18", "r19", "r20", "r21", "r22", "r23",
         "r24", "r25", "r26", "r27", "r28", "r29", "r30", "r31"
     };
+    const char* float_register_names[] = {
+        "f0", "f1", "f2", "f3", "f4", "f5", "f6", "f7",
+        "f8", "f9", "f10", "f11", "f12", "f13", "f14", "f15",
+        "f16", "f17", "f18", "f19", "f20", "f21", "f22", "f23",
+        "f24", "f25", "f26", "f27", "f28", "f29", "f30", "f31"
+    };
 
     for (int i = 0; i < 32; i++) {
         register_pool.available_registers[i] = register_names[i];
+        float_register_pool.available_registers[i] = float_register_names[i];
     }
 
     register_pool.next_register_index = 1;
     register_pool.register_count = 32;
     memset(register_pool.used_registers, 0, sizeof(register_pool.used_registers));
     register_pool.used_registers[0] = 1;
+
+    float_register_pool.next_register_index = 1;
+    float_register_pool.register_count = 32;
+    memset(float_register_pool.used_registers, 0, sizeof(float_register_pool.used_registers));
+    float_register_pool.used_registers[0] = 1;
 }
 
 char* get_register() {
@@ -361,6 +682,10 @@ char* get_register() {
             return (char*)register_pool.available_registers[i];
         }
     }
+    if (!register_allocation.out_of_registers) {
+        record_error(register_allocation.statement_line, "Expression needs more registers than are free");
+        register_allocation.out_of_registers = true;
+    }
     return (char*)"r31";
 }
 
@@ -376,259 +701,556 @@ void release_register_by_name(const char* reg_name) {
 void clear_registers() {
     memset(register_pool.used_registers, 0, sizeof(register_pool.used_registers));
     register_pool.used_registers[0] = 1;
+    memset(float_register_pool.used_registers, 0, sizeof(float_register_pool.used_registers));
+    float_register_pool.used_registers[0] = 1;
+}
+
+// Every source byte is classified with one table lookup. Bytes 128-255 are
+// left zero, which is CHAR_OTHER.
+typedef enum {
+    CHAR_OTHER, CHAR_END, CHAR_SPACE, CHAR_NEWLINE,
+    CHAR_LETTER, CHAR_DIGIT, CHAR_QUOTE, CHAR_OPERATOR
+} CharClass;
+
+#define OT CHAR_OTHER
+#define EN CHAR_END
+#define SP CHAR_SPACE
+#define NL CHAR_NEWLINE
+#define LT CHAR_LETTER
+#define DG CHAR_DIGIT
+#define QT CHAR_QUOTE
+#define OP CHAR_OPERATOR
+static const unsigned char char_classes[256] = {
+    EN, OT, OT, OT, OT, OT, OT, OT, OT, SP, NL, OT, OT, SP, OT, OT,
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,
+    SP, OT, OT, OT, OT, OT, OT, QT, OP, OP, OP, OP, OP, OP, OT, OP,
+    DG, DG, DG, DG, DG, DG, DG, DG, DG, DG, OT, OP, OT, OP, OT, OT,
+    OT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT,
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, OT, OT, OT, OT, LT,
+    OT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT,
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, OT, OT, OT, OT, OT,
+};
+#undef OT
+#undef EN
+#undef SP
+#undef NL
+#undef LT
+#undef DG
+#undef QT
+#undef OP
+
+#define CHAR_CLASS(c) ((CharClass)char_classes[(unsigned char)(c)])
+
+// Operator DFA: the first byte selects a row, and the second byte either
+// doubles it ("++"), adds '=' ("+=") or ends the token. END_OF_FILE (0)
+// marks a missing transition.
+typedef struct {
+    TokenType single;
+    TokenType doubled;
+    TokenType with_assign;
+} OperatorTransition;
+
+static const OperatorTransition operator_transitions[256] = {
+    ['+'] = {PLUS, INCREMENT, PLUS_ASSIGN},
+    ['-'] = {MINUS, DECREMENT, MINUS_ASSIGN},
+    ['*'] = {MULTIPLY, END_OF_FILE, MULTIPLY_ASSIGN},
+    ['/'] = {DIVIDE, END_OF_FILE, DIVIDE_ASSIGN},
+    ['='] = {ASSIGN, END_OF_FILE, END_OF_FILE},
+    [';'] = {SEMICOLON, END_OF_FILE, END_OF_FILE},
+    ['('] = {LEFT_PAREN, END_OF_FILE, END_OF_FILE},
+    [')'] = {RIGHT_PAREN, END_OF_FILE, END_OF_FILE},
+    [','] = {COMMA, END_OF_FILE, END_OF_FILE},
+};
+
+// Block scanners for the whitespace/comment skipper. A block is loaded and
+// compared against a byte, giving one mask bit per matching byte. Loads
+// never go past source_length, so the remaining tail is always finished
+// by the scalar loops below (which are also the whole implementation when
+// no vector unit is available).
+#if defined(__AVX2__)
+#define SCAN_WIDTH 32
+#define SCAN_FULL_MASK 0xFFFFFFFFu
+typedef __m256i ScanBlock;
+
+static inline ScanBlock load_scan_block(const char* bytes) {
+    return _mm256_loadu_si256((const __m256i*)bytes);
+}
+
+static inline unsigned int match_scan_byte(ScanBlock block, char byte) {
+    return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(byte)));
+}
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCAN_WIDTH 16
+#define SCAN_FULL_MASK 0xFFFFu
+typedef __m128i ScanBlock;
+
+static inline ScanBlock load_scan_block(const char* bytes) {
+    return _mm_loadu_si128((const __m128i*)bytes);
+}
+
+static inline unsigned int match_scan_byte(ScanBlock block, char byte) {
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(byte)));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define SCAN_WIDTH 16
+#define SCAN_FULL_MASK 0xFFFFu
+typedef uint8x16_t ScanBlock;
+
+static inline ScanBlock load_scan_block(const char* bytes) {
+    return vld1q_u8((const uint8_t*)bytes);
+}
+
+// NEON has no movemask, so weight each lane by its bit and add up each half
+static inline unsigned int match_scan_byte(ScanBlock block, char byte) {
+    static const uint8_t lane_bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t bits = vandq_u8(vceqq_u8(block, vdupq_n_u8((uint8_t)byte)), vld1q_u8(lane_bits));
+    return vaddv_u8(vget_low_u8(bits)) | ((unsigned int)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+#else
+#define SCAN_WIDTH 0
+#endif
+
+#if SCAN_WIDTH
+#if defined(_MSC_VER) && !defined(__clang__)
+static inline int lowest_set_bit(unsigned int mask) {
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+}
+
+static inline int count_set_bits(unsigned int mask) {
+    return (int)__popcnt(mask);
+}
+#else
+static inline int lowest_set_bit(unsigned int mask) {
+    return __builtin_ctz(mask);
+}
+
+static inline int count_set_bits(unsigned int mask) {
+    return __builtin_popcount(mask);
+}
+#endif
+#endif
+
+// Returns the first position at or after pos that is not ' ', '\t', '\r' or
+// '\n', adding the newlines passed over to *line
+int skip_blank_bytes(const char* source_code, int pos, int source_length, int* line) {
+#if SCAN_WIDTH
+    while (pos + SCAN_WIDTH <= source_length) {
+        ScanBlock block = load_scan_block(source_code + pos);
+        unsigned int newlines = match_scan_byte(block, '\n');
+        unsigned int blanks = newlines | match_scan_byte(block, ' ') |
+                              match_scan_byte(block, '\t') | match_scan_byte(block, '\r');
+        unsigned int stops = ~blanks & SCAN_FULL_MASK;
+        if (stops) {
+            int offset = lowest_set_bit(stops);
+            *line += count_set_bits(newlines & ((1u << offset) - 1));
+            return pos + offset;
+        }
+        *line += count_set_bits(newlines);
+        pos += SCAN_WIDTH;
+    }
+#endif
+    for (;;) {
+        CharClass char_class = CHAR_CLASS(source_code[pos]);
+        if (char_class == CHAR_NEWLINE) (*line)++;
+        else if (char_class != CHAR_SPACE) return pos;
+        pos++;
+    }
+}
+
+// Returns the position of the newline ending a '//' comment, or of the
+// terminating '\0'
+int find_line_end(const char* source_code, int pos, int source_length) {
+#if SCAN_WIDTH
+    while (pos + SCAN_WIDTH <= source_length) {
+        unsigned int newlines = match_scan_byte(load_scan_block(source_code + pos), '\n');
+        if (newlines) return pos + lowest_set_bit(newlines);
+        pos += SCAN_WIDTH;
+    }
+#endif
+    while (source_code[pos] != '\0' && source_code[pos] != '\n') pos++;
+    return pos;
+}
+
+// Inside a block comment only '*' and '/' can change the nesting depth.
+// Returns the next one of those (or the '\0'), counting newlines on the way.
+int find_comment_marker(const char* source_code, int pos, int source_length, int* line) {
+#if SCAN_WIDTH
+    while (pos + SCAN_WIDTH <= source_length) {
+        ScanBlock block = load_scan_block(source_code + pos);
+        unsigned int newlines = match_scan_byte(block, '\n');
+        unsigned int markers = match_scan_byte(block, '*') | match_scan_byte(block, '/');
+        if (markers) {
+            int offset = lowest_set_bit(markers);
+            *line += count_set_bits(newlines & ((1u << offset) - 1));
+            return pos + offset;
+        }
+        *line += count_set_bits(newlines);
+        pos += SCAN_WIDTH;
+    }
+#endif
+    while (source_code[pos] != '\0' && source_code[pos] != '*' && source_code[pos] != '/') {
+        if (source_code[pos] == '\n') (*line)++;
+        pos++;
+    }
+    return pos;
 }
 
 bool IS_WHITESPACE(char c) {
-    return ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r');
+    return CHAR_CLASS(c) == CHAR_SPACE || CHAR_CLASS(c) == CHAR_NEWLINE;
 }
 
 bool IS_LETTER(char c) {
-    return (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || (c) == '_');
+    return CHAR_CLASS(c) == CHAR_LETTER;
 }
 
 bool IS_DIGIT(char c) {
-    return ((c) >= '0' && (c) <= '9');
+    return CHAR_CLASS(c) == CHAR_DIGIT;
 }
 
 bool IS_ALPHANUMERIC(char c) {
-    return (IS_LETTER(c) || IS_DIGIT(c));
+    return CHAR_CLASS(c) == CHAR_LETTER || CHAR_CLASS(c) == CHAR_DIGIT;
 }
 
-TokenType identify_keyword(const char* word) {
-    if (strcmp(word, "int") == 0) return INT_KEYWORD;
-    if (strcmp(word, "char") == 0) return CHAR_KEYWORD;
-    if (strcmp(word, "float") == 0) return FLOAT_KEYWORD;
+// The keywords all have different lengths, so the length is a perfect hash
+// and one memcmp settles it
+typedef struct {
+    const char* text;
+    TokenType type;
+} Keyword;
+
+static const Keyword keywords_by_length[] = {
+    [3] = {"int", INT_KEYWORD},
+    [4] = {"char", CHAR_KEYWORD},
+    [5] = {"float", FLOAT_KEYWORD},
+};
+
+TokenType identify_keyword(const char* word, int length) {
+    if (length >= (int)(sizeof(keywords_by_length) / sizeof(keywords_by_length[0]))) return IDENTIFIER;
+    const Keyword* keyword = &keywords_by_length[length];
+    if (keyword->text && memcmp(word, keyword->text, length) == 0) return keyword->type;
     return IDENTIFIER;
 }
 
 // --- Lexer (Tokenizer) ---
 
-void save_token(TokenType type, const char* text_value, int line_number) {
-    if (current_token_count < MAX_TOKENS) {
-        all_tokens[current_token_count].type = type;
-        all_tokens[current_token_count].line_number = line_number;
-        strncpy(all_tokens[current_token_count].text, text_value, MAX_NAME_LENGTH - 1);
-        all_tokens[current_token_count].text[MAX_NAME_LENGTH - 1] = '\0';
-        current_token_count++;
-    } else {
-        record_error(line_number, "Too many tokens in program");
+void save_token(TokenType type, const char* text, int length, int line_number) {
+    if (current_token_count == token_capacity) {
+        int capacity = token_capacity ? token_capacity * 2 : INITIAL_TOKEN_CAPACITY;
+        Token* tokens = realloc(all_tokens, capacity * sizeof(Token));
+        if (!tokens) {
+            record_error(line_number, "Too many tokens in program");
+            return;
+        }
+        all_tokens = tokens;
+        token_capacity = capacity;
     }
+    all_tokens[current_token_count++] = (Token){type, text, length, line_number};
 }
 
-void skip_spaces_and_comments(const char* source_code, int* position, int* current_line) {
-    while (source_code[*position] != '\0') {
-        if (IS_WHITESPACE(source_code[*position])) {
-            if (source_code[*position] == '\n') (*current_line)++;
-            (*position)++;
-        } else if (source_code[*position] == '/' && source_code[*position + 1] == '/') {
-            *position += 2;
-            while (source_code[*position] != '\0' && source_code[*position] != '\n') {
-                (*position)++;
-            }
-            if (source_code[*position] == '\n') {
-                (*current_line)++;
-                (*position)++;
-            }
-        } else if (source_code[*position] == '/' && source_code[*position + 1] == '*') {
-            *position += 2;
+// Character literals are stored as their decimal value, which is not spelled
+// anywhere in the source, so the text comes from a table built on first use
+const char* char_literal_text(int value, int* length) {
+    static char value_texts[384][5];
+    char* text = value_texts[value + 128];
+    if (!text[0]) snprintf(text, sizeof(value_texts[0]), "%d", value);
+    *length = (int)strlen(text);
+    return text;
+}
+
+void skip_spaces_and_comments(const char* source_code, int source_length, int* position, int* current_line) {
+    int pos = *position;
+    int line = *current_line;
+
+    for (;;) {
+        pos = skip_blank_bytes(source_code, pos, source_length, &line);
+        if (source_code[pos] == '/' && source_code[pos + 1] == '/') {
+            pos = find_line_end(source_code, pos + 2, source_length);
+        } else if (source_code[pos] == '/' && source_code[pos + 1] == '*') {
+            pos += 2;
             int comment_depth = 1;
-            while (source_code[*position] != '\0' && comment_depth > 0) {
-                if (source_code[*position] == '\n') (*current_line)++;
-                else if (source_code[*position] == '/' && source_code[*position + 1] == '*') {
+
+            while (comment_depth > 0) {
+                pos = find_comment_marker(source_code, pos, source_length, &line);
+                if (source_code[pos] == '\0') break;
+                if (source_code[pos] == '/' && source_code[pos + 1] == '*') {
                     comment_depth++;
-                    *position += 2;
-                    continue;
-                } else if (source_code[*position] == '*' && source_code[*position + 1] == '/') {
+                    pos += 2;
+                } else if (source_code[pos] == '*' && source_code[pos + 1] == '/') {
                     comment_depth--;
-                    *position += 2;
-                    continue;
+                    pos += 2;
+                } else {
+                    pos++;
                 }
-                (*position)++;
             }
         } else {
             break;
         }
     }
+
+    *position = pos;
+    *current_line = line;
+}
+
+// Consumes an optional ".digits" tail after the integer part of a number
+TokenType scan_fraction(const char* source_code, int* position) {
+    if (source_code[*position] != '.') return NUMBER;
+    (*position)++;
+    while (IS_DIGIT(source_code[*position])) (*position)++;
+    return FLOAT_LITERAL;
 }
 
 void break_into_tokens(const char* source_code) {
+    int source_length = (int)strlen(source_code);
     int position = 0;
     int current_line = 1;
 
-    while (source_code[position] != '\0') {
-        skip_spaces_and_comments(source_code, &position, &current_line);
-        if (source_code[position] == '\0') break;
+    for (;;) {
+        skip_spaces_and_comments(source_code, source_length, &position, &current_line);
+        char current = source_code[position];
 
-        // Handle Characters
-        if (source_code[position] == '\'') {
-            position++;
-            char char_buffer[4] = {0};
-            int char_value = 0;
-            if (source_code[position] == '\\') {
-                position++;
-                switch (source_code[position]) {
-                    case 'n': char_value = '\n'; break;
-                    case 't': char_value = '\t'; break;
-                    case 'r': char_value = '\r'; break;
-                    case '0': char_value = '\0'; break;
-                    case '\\': char_value = '\\'; break;
-                    case '\'': char_value = '\''; break;
-                    default: char_value = source_code[position]; break;
-                }
-                position++;
-            } else {
-                char_value = (unsigned char)source_code[position];
-                position++;
-            }
-            if (source_code[position] == '\'') {
-                position++;
-                char num_str[16];
-                snprintf(num_str, sizeof(num_str), "%d", char_value);
-                save_token(CHAR_LITERAL, num_str, current_line);
-            }
-            continue;
-        }
+        switch (CHAR_CLASS(current)) {
+            case CHAR_END:
+                save_token(END_OF_FILE, "", 0, current_line);
+                return;
 
-        // Handle Negative Numbers
-        if (source_code[position] == '-' && IS_DIGIT(source_code[position + 1])) {
-            bool is_unary_minus = false;
-            if (position > 0) {
-                char prev_char = source_code[position - 1];
-                is_unary_minus = IS_LETTER(prev_char) || IS_DIGIT(prev_char) || prev_char == ')' || prev_char == ']';
-            }
-            if (!is_unary_minus) {
-                char number_buffer[MAX_NAME_LENGTH] = {0};
-                int buffer_index = 0;
-                number_buffer[buffer_index++] = source_code[position++];
-                while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                    number_buffer[buffer_index++] = source_code[position++];
-                }
-                if (source_code[position] == '.') {
-                    number_buffer[buffer_index++] = source_code[position++];
-                    while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                        number_buffer[buffer_index++] = source_code[position++];
-                    }
-                    save_token(FLOAT_LITERAL, number_buffer, current_line);
-                } else {
-                    save_token(NUMBER, number_buffer, current_line);
-                }
-                continue;
+            case CHAR_LETTER: {
+                int start = position;
+                while (IS_ALPHANUMERIC(source_code[position])) position++;
+                int length = position - start;
+                save_token(identify_keyword(source_code + start, length), source_code + start, length, current_line);
+                break;
             }
-        }
 
-        // Handle Positive Numbers with explicit +
-        if (source_code[position] == '+' && IS_DIGIT(source_code[position + 1])) {
-            bool is_unary_plus = false;
-            if (position > 0) {
-                char prev_char = source_code[position - 1];
-                is_unary_plus = IS_LETTER(prev_char) || IS_DIGIT(prev_char) || prev_char == ')' || prev_char == ']';
+            case CHAR_DIGIT: {
+                int start = position;
+                while (IS_DIGIT(source_code[position])) position++;
+                TokenType type = scan_fraction(source_code, &position);
+                save_token(type, source_code + start, position - start, current_line);
+                break;
             }
-            if (!is_unary_plus) {
-                char number_buffer[MAX_NAME_LENGTH] = {0};
-                int buffer_index = 0;
+
+            case CHAR_QUOTE: {
                 position++;
-                while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                    number_buffer[buffer_index++] = source_code[position++];
-                }
-                if (source_code[position] == '.') {
-                    number_buffer[buffer_index++] = source_code[position++];
-                    while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                        number_buffer[buffer_index++] = source_code[position++];
+                int char_value = 0;
+                if (source_code[position] == '\\') {
+                    position++;
+                    switch (source_code[position]) {
+                        case 'n': char_value = '\n'; break;
+                        case 't': char_value = '\t'; break;
+                        case 'r': char_value = '\r'; break;
+                        case '0': char_value = '\0'; break;
+                        case '\\': char_value = '\\'; break;
+                        case '\'': char_value = '\''; break;
+                        default: char_value = source_code[position]; break;
                     }
-                    save_token(FLOAT_LITERAL, number_buffer, current_line);
+                    position++;
                 } else {
-                    save_token(NUMBER, number_buffer, current_line);
+                    char_value = (unsigned char)source_code[position];
+                    position++;
                 }
-                continue;
+                if (source_code[position] == '\'') {
+                    position++;
+                    int value_length;
+                    const char* value_text = char_literal_text(char_value, &value_length);
+                    save_token(CHAR_LITERAL, value_text, value_length, current_line);
+                }
+                break;
             }
-        }
 
-        // Handle Digits and Floats
-        if (IS_DIGIT(source_code[position])) {
-            char number_buffer[MAX_NAME_LENGTH] = {0};
-            int buffer_index = 0;
-            bool is_float = false;
-            while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                number_buffer[buffer_index++] = source_code[position++];
-            }
-            if (source_code[position] == '.') {
-                is_float = true;
-                number_buffer[buffer_index++] = source_code[position++];
-                while (IS_DIGIT(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                    number_buffer[buffer_index++] = source_code[position++];
+            case CHAR_OPERATOR: {
+                // A sign directly in front of a digit is part of the number,
+                // unless it follows an operand and is really a binary operator
+                if ((current == '-' || current == '+') && IS_DIGIT(source_code[position + 1])) {
+                    bool follows_operand = false;
+                    if (position > 0) {
+                        char prev_char = source_code[position - 1];
+                        follows_operand = IS_ALPHANUMERIC(prev_char) || prev_char == ')' || prev_char == ']';
+                    }
+
+                    if (!follows_operand) {
+                        // '+5' is stored as '5', '-5' keeps its sign
+                        int start = current == '+' ? ++position : position++;
+                        while (IS_DIGIT(source_code[position])) position++;
+                        TokenType type = scan_fraction(source_code, &position);
+                        save_token(type, source_code + start, position - start, current_line);
+                        break;
+                    }
                 }
-            }
-            if (is_float) save_token(FLOAT_LITERAL, number_buffer, current_line);
-            else save_token(NUMBER, number_buffer, current_line);
-            continue;
-        }
 
-        // Handle Identifiers and Keywords
-        if (IS_LETTER(source_code[position])) {
-            char word_buffer[MAX_NAME_LENGTH] = {0};
-            int buffer_index = 0;
-            while (IS_ALPHANUMERIC(source_code[position]) && buffer_index < MAX_NAME_LENGTH - 1) {
-                word_buffer[buffer_index++] = source_code[position++];
+                const OperatorTransition* transition = &operator_transitions[(unsigned char)current];
+                char next = source_code[position + 1];
+                TokenType type = transition->single;
+                int length = 1;
+                if (next == current && transition->doubled != END_OF_FILE) {
+                    type = transition->doubled;
+                    length = 2;
+                } else if (next == '=' && transition->with_assign != END_OF_FILE) {
+                    type = transition->with_assign;
+                    length = 2;
+                }
+                save_token(type, source_code + position, length, current_line);
+                position += length;
+                break;
             }
-            save_token(identify_keyword(word_buffer), word_buffer, current_line);
-            continue;
-        }
 
-        // Handle Operators
-        if (source_code[position] == '+' && source_code[position + 1] == '+') { save_token(INCREMENT, "++", current_line); position += 2; continue; }
-        if (source_code[position] == '-' && source_code[position + 1] == '-') { save_token(DECREMENT, "--", current_line); position += 2; continue; }
-        if (source_code[position] == '+' && source_code[position + 1] == '=') { save_token(PLUS_ASSIGN, "+=", current_line); position += 2; continue; }
-        if (source_code[position] == '-' && source_code[position + 1] == '=') { save_token(MINUS_ASSIGN, "-=", current_line); position += 2; continue; }
-        if (source_code[position] == '*' && source_code[position + 1] == '=') { save_token(MULTIPLY_ASSIGN, "*=", current_line); position += 2; continue; }
-        if (source_code[position] == '/' && source_code[position + 1] == '=') { save_token(DIVIDE_ASSIGN, "/=", current_line); position += 2; continue; }
-
-        switch (source_code[position]) {
-            case '+': save_token(PLUS, "+", current_line); position++; break;
-            case '-': save_token(MINUS, "-", current_line); position++; break;
-            case '*': save_token(MULTIPLY, "*", current_line); position++; break;
-            case '/': save_token(DIVIDE, "/", current_line); position++; break;
-            case '=': save_token(ASSIGN, "=", current_line); position++; break;
-            case ';': save_token(SEMICOLON, ";", current_line); position++; break;
-            case '(': save_token(LEFT_PAREN, "(", current_line); position++; break;
-            case ')': save_token(RIGHT_PAREN, ")", current_line); position++; break;
-            case ',': save_token(COMMA, ",", current_line); position++; break;
-            default: position++; break;
+            default:
+                position++;
+                break;
         }
     }
-    save_token(END_OF_FILE, "", current_line);
 }
 
 // --- Symbol Table ---
 
-Symbol* find_variable(const char* variable_name) {
-    for (int i = 0; i < symbols_found; i++) {
-        if (strcmp(symbol_table[i].name, variable_name) == 0) {
-            return &symbol_table[i];
+unsigned int hash_name(const char* name, int length) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+Symbol* find_variable(Token variable_name) {
+    if (!slot_capacity) return NULL;
+
+    unsigned int hash = hash_name(variable_name.text, variable_name.length);
+    unsigned int mask = slot_capacity - 1;
+    for (unsigned int slot = hash & mask; symbol_slots[slot]; slot = (slot + 1) & mask) {
+        Symbol* symbol = &symbol_table[symbol_slots[slot] - 1];
+        if (symbol->name_hash == hash && symbol->name_length == variable_name.length &&
+            memcmp(symbol->name, variable_name.text, variable_name.length) == 0) {
+            return symbol;
         }
     }
     return NULL;
 }
 
-bool add_variable(const char* variable_name, int line_number, char type) {
-    if (symbols_found >= MAX_SYMBOLS) return false;
+bool grow_symbol_table() {
+    int capacity = symbol_capacity ? symbol_capacity * 2 : INITIAL_SYMBOL_CAPACITY;
+    Symbol* symbols = realloc(symbol_table, capacity * sizeof(Symbol));
+    if (!symbols) return false;
+    symbol_table = symbols;
+    symbol_capacity = capacity;
+
+    int* slots = calloc(capacity * 2, sizeof(int));
+    if (!slots) return false;
+    free(symbol_slots);
+    symbol_slots = slots;
+    slot_capacity = capacity * 2;
+
+    unsigned int mask = slot_capacity - 1;
+    for (int i = 0; i < symbols_found; i++) {
+        unsigned int slot = symbol_table[i].name_hash & mask;
+        while (symbol_slots[slot]) slot = (slot + 1) & mask;
+        symbol_slots[slot] = i + 1;
+    }
+    return true;
+}
+
+// A char keeps its byte; ints are 64-bit like the registers they are
+// computed in, and floats are doubles
+int slot_size(char type) {
+    return type == 'c' ? 1 : 8;
+}
+
+bool add_variable(Token variable_name, char type) {
     if (find_variable(variable_name) != NULL) return false;
-    symbol_table[symbols_found] = (Symbol){{0}, 0, 0, next_memory_location, 8, type};
-    strncpy(symbol_table[symbols_found].name, variable_name, MAX_NAME_LENGTH - 1);
+    if (symbols_found == symbol_capacity && !grow_symbol_table()) {
+        record_error(variable_name.line_number, "Too many variables declared");
+        return false;
+    }
+
+    Symbol* symbol = &symbol_table[symbols_found];
+    *symbol = (Symbol){
+        .name = variable_name.text,
+        .name_length = variable_name.length,
+        .name_hash = hash_name(variable_name.text, variable_name.length),
+        .memory_location = -1,
+        .size = slot_size(type),
+        .type = type,
+        .line_number = variable_name.line_number,
+        .live_range = -1,
+        .home_register = 0,
+    };
+
+    unsigned int mask = slot_capacity - 1;
+    unsigned int slot = symbol->name_hash & mask;
+    while (symbol_slots[slot]) slot = (slot + 1) & mask;
+    symbol_slots[slot] = symbols_found + 1;
+
     symbols_found++;
-    next_memory_location += 8;
     return true;
 }
 
-void mark_variable_initialized(const char* variable_name) {
+// Gives every variable with has_slot set (all of them when it is NULL) its
+// offset once the program is parsed. Slots go in decreasing size, so each one
+// is naturally aligned without padding, and the end is rounded up to 8 for
+// the float constant pool that follows. Every slot has to lie within
+// DATA_SEGMENT_LIMIT; the first one that does not is reported.
+void lay_out_variables(const bool* has_slot) {
+    next_memory_location = 0;
+    for (int size = 8; size >= 1; size /= 2) {
+        for (int i = 0; i < symbols_found; i++) {
+            if (symbol_table[i].size != size) continue;
+            if (has_slot && !has_slot[i]) {
+                symbol_table[i].memory_location = -1;
+                continue;
+            }
+            if (next_memory_location + size > DATA_SEGMENT_LIMIT) {
+                record_error(symbol_table[i].line_number, "Too many variables for r0-relative addressing");
+                return;
+            }
+            symbol_table[i].memory_location = next_memory_location;
+            next_memory_location += size;
+        }
+    }
+    next_memory_location = (next_memory_location + 7) & ~7;
+}
+
+// The load and store that move a variable's whole slot
+Opcode load_opcode(const Symbol* variable) {
+    if (variable->type == 'f') return OP_L_D;
+    return variable->size == 1 ? OP_LB : OP_LD;
+}
+
+Opcode store_opcode(const Symbol* variable) {
+    if (variable->type == 'f') return OP_S_D;
+    return variable->size == 1 ? OP_SB : OP_SD;
+}
+
+void mark_variable_initialized(Token variable_name) {
     Symbol* variable = find_variable(variable_name);
     if (variable) variable->is_initialized = 1;
 }
 
-void mark_variable_used(const char* variable_name) {
+void mark_variable_used(Token variable_name) {
     Symbol* variable = find_variable(variable_name);
     if (variable) variable->is_used = 1;
 }
 
+// Numeric token values. The slice is copied out first because the character
+// after it in the source may still be something atoi/atof would consume.
+void copy_token_text(Token token, char* buffer, int buffer_size) {
+    int length = token.length < buffer_size - 1 ? token.length : buffer_size - 1;
+    memcpy(buffer, token.text, length);
+    buffer[length] = '\0';
+}
+
+int token_int_value(Token token) {
+    char number[64];
+    copy_token_text(token, number, sizeof(number));
+    return atoi(number);
+}
+
+double token_float_value(Token token) {
+    char number[64];
+    copy_token_text(token, number, sizeof(number));
+    return atof(number);
+}
+
 // --- Parsing Utilities ---
 
 Token get_next_token() {
@@ -652,6 +1274,7 @@ ASTNode* create_tree_node(ASTNodeType node_type, Token token_data,
                           ASTNode* left_child, ASTNode* right_child) {
     ASTNode* new_node = malloc(sizeof(ASTNode));
     *new_node = (ASTNode){node_type, token_data, left_child, right_child, NULL};
+    compile_stats.ast_nodes++;
     return new_node;
 }
 
@@ -688,7 +1311,7 @@ ASTNode* parse_primary_expression() {
     if (current_token.type == CHAR_LITERAL) return create_tree_node(CHAR_NODE, get_next_token(), NULL, NULL);
     if (current_token.type == IDENTIFIER) {
         Token token = get_next_token();
-        mark_variable_used(token.text);
+        mark_variable_used(token);
         return create_tree_node(VARIABLE_NODE, token, NULL, NULL);
     }
     if (current_token.type == LEFT_PAREN) {
@@ -742,7 +1365,7 @@ ASTNode* parse_assignment() {
             operator_token.type == MULTIPLY_ASSIGN || operator_token.type == DIVIDE_ASSIGN) {
         get_next_token();
         ASTNode* expression = parse_expression();
-        mark_variable_initialized(variable_token.text);
+        mark_variable_initialized(variable_token);
         return create_tree_node(COMPOUND_ASSIGN_NODE, operator_token,
                                 create_tree_node(VARIABLE_NODE, variable_token, NULL, NULL), expression);
     }
@@ -753,12 +1376,12 @@ ASTNode* parse_assignment() {
                           all_tokens[current_token_position + 1] : all_tokens[current_token_count - 1];
         if (lookahead.type == ASSIGN) {
             ASTNode* nested_assignment = parse_assignment();
-            mark_variable_initialized(variable_token.text);
+            mark_variable_initialized(variable_token);
             return create_tree_node(ASSIGNMENT_NODE, variable_token, nested_assignment, NULL);
         }
     }
     ASTNode* expression = parse_expression();
-    mark_variable_initialized(variable_token.text);
+    mark_variable_initialized(variable_token);
     return create_tree_node(ASSIGNMENT_NODE, variable_token, expression, NULL);
 }
 
@@ -770,7 +1393,7 @@ ASTNode* parse_declaration() {
 
     while (1) {
         Token variable_token = get_next_token();
-        add_variable(variable_token.text, variable_token.line_number, var_type);
+        add_variable(variable_token, var_type);
         ASTNode* assignment_node = NULL;
         Token next_token = peek_next_token();
 
@@ -778,7 +1401,7 @@ ASTNode* parse_declaration() {
                 next_token.type == MULTIPLY_ASSIGN || next_token.type == DIVIDE_ASSIGN) {
             get_next_token();
             ASTNode* expression = parse_expression();
-            mark_variable_initialized(variable_token.text);
+            mark_variable_initialized(variable_token);
             assignment_node = create_tree_node(ASSIGNMENT_NODE, variable_token, expression, NULL);
         } else {
             assignment_node = create_tree_node(VARIABLE_NODE, variable_token, NULL, NULL);
@@ -804,8 +1427,8 @@ ASTNode* parse_statement() {
     if (peek_next_token().type == INCREMENT || peek_next_token().type == DECREMENT) {
         Token op_token = get_next_token();
         Token var_token = get_next_token();
-        mark_variable_used(var_token.text);
-        mark_variable_initialized(var_token.text);
+        mark_variable_used(var_token);
+        mark_variable_initialized(var_token);
         ASTNode* node = create_tree_node(UNARY_NODE, op_token, create_tree_node(VARIABLE_NODE, var_token, NULL, NULL), NULL);
         expect_token(SEMICOLON, ";");
         return node;
@@ -817,7 +1440,7 @@ ASTNode* parse_statement() {
         if (lookahead.type == PLUS_ASSIGN || lookahead.type == MINUS_ASSIGN || lookahead.type == MULTIPLY_ASSIGN || lookahead.type == DIVIDE_ASSIGN) {
             Token var_token = get_next_token();
             Token op_token = get_next_token();
-            mark_variable_used(var_token.text);
+            mark_variable_used(var_token);
             ASTNode* expression = parse_expression();
             ASTNode* compound_assign = create_tree_node(COMPOUND_ASSIGN_NODE, op_token, create_tree_node(VARIABLE_NODE, var_token, NULL, NULL), expression);
             expect_token(SEMICOLON, ";");
@@ -829,8 +1452,8 @@ ASTNode* parse_statement() {
         } else if (lookahead.type == INCREMENT || lookahead.type == DECREMENT) {
             Token var_token = get_next_token();
             Token op_token = get_next_token();
-            mark_variable_used(var_token.text);
-            mark_variable_initialized(var_token.text);
+            mark_variable_used(var_token);
+            mark_variable_initialized(var_token);
             ASTNode* node = create_tree_node(UNARY_NODE, op_token, create_tree_node(VARIABLE_NODE, var_token, NULL, NULL), NULL);
             expect_token(SEMICOLON, ";");
             return node;
@@ -860,7 +1483,7 @@ char get_expression_type(ASTNode* node) {
         case NUMBER_NODE: return 'i';
         case FLOAT_NODE: return 'f';
         case CHAR_NODE: return 'c';
-        case VARIABLE_NODE: { Symbol* var = find_variable(node->token_info.text); return var ? var->type : 'i'; }
+        case VARIABLE_NODE: { Symbol* var = find_variable(node->token_info); return var ? var->type : 'i'; }
         case OPERATION_NODE: {
             char left_type = get_expression_type(node->left_child);
             char right_type = get_expression_type(node->right_child);
@@ -875,7 +1498,7 @@ char get_expression_type(ASTNode* node) {
 
 void check_type_compatibility(ASTNode* assignment_node) {
     if (!assignment_node || assignment_node->node_type != ASSIGNMENT_NODE) return;
-    Symbol* var = find_variable(assignment_node->token_info.text);
+    Symbol* var = find_variable(assignment_node->token_info);
     if (!var || !assignment_node->left_child) return;
     char expr_type = get_expression_type(assignment_node->left_child);
     if (var->type != expr_type) {
@@ -887,29 +1510,33 @@ void check_program_semantics(ASTNode* node) {
     if (!node) return;
     switch (node->node_type) {
         case VARIABLE_NODE: {
-            Symbol* variable = find_variable(node->token_info.text);
-            if (!variable) record_error(node->token_info.line_number, "Variable '%s' was not declared", node->token_info.text);
+            Symbol* variable = find_variable(node->token_info);
+            if (!variable) record_error(node->token_info.line_number, "Variable '%.*s' was not declared",
+                                       node->token_info.length, node->token_info.text);
             break;
         }
         case UNARY_NODE:
             if (node->left_child && node->left_child->node_type == VARIABLE_NODE) {
-                Symbol* variable = find_variable(node->left_child->token_info.text);
-                if (!variable) record_error(node->token_info.line_number, "Variable '%s' was not declared", node->left_child->token_info.text);
-                mark_variable_used(node->left_child->token_info.text);
+                Symbol* variable = find_variable(node->left_child->token_info);
+                if (!variable) record_error(node->token_info.line_number, "Variable '%.*s' was not declared",
+                                           node->left_child->token_info.length, node->left_child->token_info.text);
+                mark_variable_used(node->left_child->token_info);
             }
             break;
         case ASSIGNMENT_NODE: {
-            Symbol* variable = find_variable(node->token_info.text);
-            if (!variable) record_error(node->token_info.line_number, "Variable '%s' was not declared", node->token_info.text);
+            Symbol* variable = find_variable(node->token_info);
+            if (!variable) record_error(node->token_info.line_number, "Variable '%.*s' was not declared",
+                                       node->token_info.length, node->token_info.text);
             check_type_compatibility(node);
             check_program_semantics(node->left_child);
             break;
         }
         case COMPOUND_ASSIGN_NODE:
             if (node->left_child && node->left_child->node_type == VARIABLE_NODE) {
-                Symbol* variable = find_variable(node->left_child->token_info.text);
-                if (!variable) record_error(node->token_info.line_number, "Variable '%s' was not declared", node->left_child->token_info.text);
-                mark_variable_used(node->left_child->token_info.text);
+                Symbol* variable = find_variable(node->left_child->token_info);
+                if (!variable) record_error(node->token_info.line_number, "Variable '%.*s' was not declared",
+                                           node->left_child->token_info.length, node->left_child->token_info.text);
+                mark_variable_used(node->left_child->token_info);
             }
             check_program_semantics(node->right_child);
             break;
@@ -933,130 +1560,666 @@ void check_for_unused_variables() {
     }
 }
 
-// --- Code Generation (MIPS64) ---
+// --- Optimization ---
+//
+// Runs between semantic analysis and codegen. Integer expressions are
+// rewritten in place: constant subtrees are folded, identity operations
+// dropped and multiply/divide by a power of two turned into a shift. Float
+// arithmetic is left exactly as written.
+
+// Constants end up as daddiu immediates, which are sign-extended from 16 bits
+#define FOLD_MIN -32768
+#define FOLD_MAX 32767
+
+bool constant_value(ASTNode* node, long long* value) {
+    if (!node || (node->node_type != NUMBER_NODE && node->node_type != CHAR_NODE)) return false;
+    char number[64];
+    copy_token_text(node->token_info, number, sizeof(number));
+    long long parsed = strtoll(number, NULL, 10);
+    if (parsed < FOLD_MIN || parsed > FOLD_MAX) return false;
+    *value = parsed;
+    return true;
+}
 
-void generate_expression_code(ASTNode* node, FILE* output, const char* result_register) {
-    if (!node) return;
-    char expr_type = get_expression_type(node);
-    bool is_float = (expr_type == 'f');
+// Evaluates with the semantics of the generated code: 64-bit wraparound and
+// unsigned division. Division by zero is left for the machine.
+bool evaluate_operation(TokenType operator, long long left, long long right, long long* result) {
+    unsigned long long a = (unsigned long long)left, b = (unsigned long long)right;
+    switch (operator) {
+        case PLUS: *result = (long long)(a + b); return true;
+        case MINUS: *result = (long long)(a - b); return true;
+        case MULTIPLY: *result = (long long)(a * b); return true;
+        case DIVIDE:
+            if (b == 0) return false;
+            *result = (long long)(a / b);
+            return true;
+        default: return false;
+    }
+}
 
-    if (is_float) {
-        const char* float_reg = get_float_register();
-        switch (node->node_type) {
-            case NUMBER_NODE:
-                fprintf(output, "    daddiu r1, r0, %s\n", node->token_info.text);
-                produce_machine_code("daddiu", 0, 1, -1, atoi(node->token_info.text), output);
-                fprintf(output, "    dmtc1 r1, %s\n", float_reg);
-                produce_machine_code("dmtc1", 1, get_register_number(float_reg), -1, 0, output);
-                fprintf(output, "    cvt.d.l %s, %s\n", float_reg, float_reg);
-                produce_machine_code("cvt.d.l", get_register_number(float_reg), get_register_number(float_reg), get_register_number(float_reg), 0, output);
-                break;
-            case FLOAT_NODE: {
-                float float_val = atof(node->token_info.text);
-                load_float_constant(float_val, float_reg, output);
-                break;
-            }
-            case CHAR_NODE:
-                fprintf(output, "    daddiu r1, r0, %s\n", node->token_info.text);
-                produce_machine_code("daddiu", 0, 1, -1, atoi(node->token_info.text), output);
-                fprintf(output, "    dmtc1 r1, %s\n", float_reg);
-                produce_machine_code("dmtc1", 1, get_register_number(float_reg), -1, 0, output);
-                fprintf(output, "    cvt.d.l %s, %s\n", float_reg, float_reg);
-                produce_machine_code("cvt.d.l", get_register_number(float_reg), get_register_number(float_reg), get_register_number(float_reg), 0, output);
-                break;
-            case VARIABLE_NODE: {
-                Symbol* variable = find_variable(node->token_info.text);
-                if (variable) {
-                    if (variable->type == 'f') {
-                        fprintf(output, "    l.d %s, %d(r0)\n", float_reg, variable->memory_location);
-                        produce_machine_code("l.d", 0, get_register_number(float_reg), -1, variable->memory_location, output);
-                    } else {
-                        char* int_reg = get_register();
-                        fprintf(output, "    lb %s, %d(r0)\n", int_reg, variable->memory_location);
-                        produce_machine_code("lb", 0, get_register_number(int_reg), -1, variable->memory_location, output);
-                        fprintf(output, "    dmtc1 %s, %s\n", int_reg, float_reg);
-                        produce_machine_code("dmtc1", get_register_number(int_reg), get_register_number(float_reg), -1, 0, output);
-                        fprintf(output, "    cvt.d.l %s, %s\n", float_reg, float_reg);
-                        produce_machine_code("cvt.d.l", get_register_number(float_reg), get_register_number(float_reg), get_register_number(float_reg), 0, output);
-                        release_register_by_name(int_reg);
-                    }
-                }
-                break;
-            }
-            case OPERATION_NODE: {
-                const char* left_float_reg = get_float_register();
-                const char* right_float_reg = get_float_register();
-                generate_expression_code(node->left_child, output, left_float_reg);
-                generate_expression_code(node->right_child, output, right_float_reg);
-                if (strcmp(node->token_info.text, "+") == 0) {
-                    fprintf(output, "    add.d %s, %s, %s\n", float_reg, left_float_reg, right_float_reg);
-                    produce_machine_code("add.d", get_register_number(left_float_reg), get_register_number(right_float_reg), get_register_number(float_reg), 0, output);
-                } else if (strcmp(node->token_info.text, "-") == 0) {
-                    fprintf(output, "    sub.d %s, %s, %s\n", float_reg, left_float_reg, right_float_reg);
-                    produce_machine_code("sub.d", get_register_number(left_float_reg), get_register_number(right_float_reg), get_register_number(float_reg), 0, output);
-                } else if (strcmp(node->token_info.text, "*") == 0) {
-                    fprintf(output, "    mul.d %s, %s, %s\n", float_reg, left_float_reg, right_float_reg);
-                    produce_machine_code("mul.d", get_register_number(left_float_reg), get_register_number(right_float_reg), get_register_number(float_reg), 0, output);
-                } else if (strcmp(node->token_info.text, "/") == 0) {
-                    fprintf(output, "    div.d %s, %s, %s\n", float_reg, left_float_reg, right_float_reg);
-                    produce_machine_code("div.d", get_register_number(left_float_reg), get_register_number(right_float_reg), get_register_number(float_reg), 0, output);
-                }
-                release_float_register(left_float_reg);
-                release_float_register(right_float_reg);
-                break;
-            }
-            default: break;
+// Returns k when value == 2^k for k >= 1, otherwise 0
+int power_of_two_exponent(long long value) {
+    if (value < 2 || (value & (value - 1)) != 0) return 0;
+    int exponent = 0;
+    while (value > 1) {
+        value >>= 1;
+        exponent++;
+    }
+    return exponent;
+}
+
+// The digits live in the same block as the node, so free_program_tree
+// releases both
+ASTNode* create_constant_node(long long value, int line_number) {
+    ASTNode* constant = malloc(sizeof(ASTNode) + 8);
+    if (!constant) return NULL;
+    char* value_text = (char*)(constant + 1);
+    int value_length = snprintf(value_text, 8, "%lld", value);
+    Token token = {NUMBER, value_text, value_length, line_number};
+    *constant = (ASTNode){NUMBER_NODE, token, NULL, NULL, NULL};
+    return constant;
+}
+
+// Frees node except for the subtree that replaces it
+ASTNode* replace_node(ASTNode* node, ASTNode* replacement) {
+    if (node->left_child == replacement) node->left_child = NULL;
+    if (node->right_child == replacement) node->right_child = NULL;
+    free_program_tree(node);
+    return replacement;
+}
+
+// Replaces node by a constant when the value fits an immediate
+ASTNode* fold_to_constant(ASTNode* node, long long value) {
+    if (value < FOLD_MIN || value > FOLD_MAX) return node;
+    ASTNode* constant = create_constant_node(value, node->token_info.line_number);
+    return constant ? replace_node(node, constant) : node;
+}
+
+// operand * 2^k becomes dsll, operand / 2^k becomes dsrl; ddivu is unsigned,
+// so the logical shift gives exactly the same quotient
+ASTNode* create_shift_node(ASTNode* node, ASTNode* operand, int exponent) {
+    ASTNode* amount = create_constant_node(exponent, node->token_info.line_number);
+    if (!amount) return node;
+    ASTNode* shift = create_tree_node(SHIFT_NODE, node->token_info, operand, amount);
+    replace_node(node, operand);
+    return shift;
+}
+
+ASTNode* optimize_expression(ASTNode* node) {
+    if (!node) return NULL;
+    long long left_value = 0, right_value = 0, result;
+
+    if (node->node_type == UNARY_NODE) {
+        // ++ and -- store to their variable and have to stay
+        if (node->token_info.type != PLUS && node->token_info.type != MINUS) return node;
+        node->left_child = optimize_expression(node->left_child);
+        ASTNode* operand = node->left_child;
+        if (!operand) return node;
+        if (node->token_info.type == PLUS) return replace_node(node, operand);
+        if (constant_value(operand, &left_value)) return fold_to_constant(node, -left_value);
+        if (operand->node_type == UNARY_NODE && operand->token_info.type == MINUS && operand->left_child) {
+            ASTNode* inner = operand->left_child;
+            operand->left_child = NULL;
+            return replace_node(node, inner);
+        }
+        return node;
+    }
+
+    if (node->node_type != OPERATION_NODE) return node;
+
+    node->left_child = optimize_expression(node->left_child);
+    node->right_child = optimize_expression(node->right_child);
+    if (!node->left_child || !node->right_child) return node;
+    if (get_expression_type(node) == 'f') return node;
+
+    bool left_constant = constant_value(node->left_child, &left_value);
+    bool right_constant = constant_value(node->right_child, &right_value);
+
+    if (left_constant && right_constant &&
+        evaluate_operation(node->token_info.type, left_value, right_value, &result)) {
+        ASTNode* folded = fold_to_constant(node, result);
+        if (folded != node) return folded;
+    }
+
+    switch (node->token_info.type) {
+        case PLUS:
+            if (right_constant && right_value == 0) return replace_node(node, node->left_child);
+            if (left_constant && left_value == 0) return replace_node(node, node->right_child);
+            break;
+        case MINUS:
+            if (right_constant && right_value == 0) return replace_node(node, node->left_child);
+            break;
+        case MULTIPLY:
+            if (right_constant && right_value == 1) return replace_node(node, node->left_child);
+            if (left_constant && left_value == 1) return replace_node(node, node->right_child);
+            if (right_constant && power_of_two_exponent(right_value)) {
+                return create_shift_node(node, node->left_child, power_of_two_exponent(right_value));
+            }
+            if (left_constant && power_of_two_exponent(left_value)) {
+                return create_shift_node(node, node->right_child, power_of_two_exponent(left_value));
+            }
+            break;
+        case DIVIDE:
+            if (right_constant && right_value == 1) return replace_node(node, node->left_child);
+            if (right_constant && power_of_two_exponent(right_value)) {
+                return create_shift_node(node, node->left_child, power_of_two_exponent(right_value));
+            }
+            break;
+        default:
+            break;
+    }
+    return node;
+}
+
+void optimize_program(ASTNode* program) {
+    for (ASTNode* statement = program; statement; statement = statement->next) {
+        switch (statement->node_type) {
+            case ASSIGNMENT_NODE:
+                statement->left_child = optimize_expression(statement->left_child);
+                break;
+            case DECLARATION_NODE:
+                if (statement->left_child && statement->left_child->node_type == ASSIGNMENT_NODE) {
+                    ASTNode* assignment = statement->left_child;
+                    assignment->left_child = optimize_expression(assignment->left_child);
+                }
+                break;
+            case COMPOUND_ASSIGN_NODE:
+                statement->right_child = optimize_expression(statement->right_child);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// --- Dead Code Elimination ---
+//
+// Only run with --unused drop. The program has no output, so the values that
+// matter are those of variables some statement reads; check_for_unused_variables
+// flags the ones nothing reads at all. This extends that to def-use chains: a
+// read only counts when it is made by a statement that stays, and a variable
+// reading itself ("a = a + 1;", "a++;") does not keep itself alive. A store to
+// a variable nobody reads is dropped, and so is an expression statement like
+// "6 - 3;", unless an ++, -- or nested assignment in it changes another
+// variable. The surviving variables are then packed into consecutive slots.
+
+int symbol_index(Token name) {
+    Symbol* variable = find_variable(name);
+    return variable ? (int)(variable - symbol_table) : -1;
+}
+
+// Whether an ++, -- or "b = ..." in node changes a variable other than target
+bool changes_other_variable(ASTNode* node, int target) {
+    if (!node) return false;
+    if (node->node_type == UNARY_NODE && (node->token_info.type == INCREMENT || node->token_info.type == DECREMENT) &&
+        node->left_child && node->left_child->node_type == VARIABLE_NODE &&
+        symbol_index(node->left_child->token_info) != target) return true;
+    if (node->node_type == ASSIGNMENT_NODE && symbol_index(node->token_info) != target) return true;
+    return changes_other_variable(node->left_child, target) || changes_other_variable(node->right_child, target);
+}
+
+// Index of the variable a statement stores to, or -1 for an expression statement
+int stored_variable_index(ASTNode* statement) {
+    switch (statement->node_type) {
+        case ASSIGNMENT_NODE:
+            return symbol_index(statement->token_info);
+        case DECLARATION_NODE:
+            return statement->left_child ? symbol_index(statement->left_child->token_info) : -1;
+        case COMPOUND_ASSIGN_NODE:
+        case UNARY_NODE:
+            if (!statement->left_child || statement->left_child->node_type != VARIABLE_NODE) return -1;
+            return symbol_index(statement->left_child->token_info);
+        default:
+            return -1;
+    }
+}
+
+// Adds delta to the read count of every variable the statement reads, other
+// than the one it stores to. Variables whose count drops to zero go on the
+// worklist.
+void count_variable_reads(ASTNode* node, int target, int delta, int* read_counts,
+                          int* worklist, int* worklist_count) {
+    if (!node) return;
+    if (node->node_type == VARIABLE_NODE) {
+        int index = symbol_index(node->token_info);
+        if (index >= 0 && index != target) {
+            read_counts[index] += delta;
+            if (read_counts[index] == 0) worklist[(*worklist_count)++] = index;
+        }
+    }
+    count_variable_reads(node->left_child, target, delta, read_counts, worklist, worklist_count);
+    count_variable_reads(node->right_child, target, delta, read_counts, worklist, worklist_count);
+}
+
+// Returns the remaining statements and frees the others. When none are left
+// the first one becomes an empty PROGRAM_NODE, so the listing still gets its
+// .code section. Without memory for the statement arrays the program is kept
+// as it is.
+ASTNode* eliminate_dead_code(ASTNode* program) {
+    int statement_count = 0;
+    for (ASTNode* statement = program; statement; statement = statement->next) statement_count++;
+
+    ASTNode** statements = malloc(statement_count * sizeof(ASTNode*));
+    int* targets = malloc(statement_count * sizeof(int));
+    int* next_store = malloc(statement_count * sizeof(int));
+    bool* removed = calloc(statement_count, sizeof(bool));
+    int* read_counts = calloc(symbols_found + 1, sizeof(int));
+    int* first_store = malloc((symbols_found + 1) * sizeof(int));
+    int* worklist = malloc((symbols_found + 1) * sizeof(int));
+    bool* has_slot = calloc(symbols_found + 1, sizeof(bool));
+    if (!statements || !targets || !next_store || !removed || !read_counts ||
+        !first_store || !worklist || !has_slot) {
+        free(statements); free(targets); free(next_store); free(removed);
+        free(read_counts); free(first_store); free(worklist); free(has_slot);
+        return program;
+    }
+
+    // A statement that changes another variable is kept, and so are the
+    // earlier values of the variable it stores to: its reads of itself count.
+    // Only the other stores hang off their variable's list.
+    for (int i = 0; i < symbols_found; i++) first_store[i] = -1;
+    int worklist_count = 0;
+    int index = 0;
+    for (ASTNode* statement = program; statement; statement = statement->next, index++) {
+        statements[index] = statement;
+        targets[index] = stored_variable_index(statement);
+        if (changes_other_variable(statement, targets[index])) {
+            count_variable_reads(statement, -1, 1, read_counts, worklist, &worklist_count);
+        } else if (targets[index] < 0) {
+            removed[index] = true;
+        } else {
+            next_store[index] = first_store[targets[index]];
+            first_store[targets[index]] = index;
+            count_variable_reads(statement, targets[index], 1, read_counts, worklist, &worklist_count);
+        }
+    }
+    for (int i = 0; i < symbols_found; i++) {
+        if (read_counts[i] == 0) worklist[worklist_count++] = i;
+    }
+
+    // Each variable enters the worklist once, when its count reaches zero
+    while (worklist_count) {
+        int variable = worklist[--worklist_count];
+        for (int store = first_store[variable]; store >= 0; store = next_store[store]) {
+            removed[store] = true;
+            count_variable_reads(statements[store], variable, -1, read_counts, worklist, &worklist_count);
+        }
+        first_store[variable] = -1;
+    }
+
+    ASTNode* remaining = NULL;
+    ASTNode* last = NULL;
+    for (int i = 0; i < statement_count; i++) {
+        statements[i]->next = NULL;
+        if (removed[i]) continue;
+        if (targets[i] >= 0) has_slot[targets[i]] = true;
+        if (last) last->next = statements[i];
+        else remaining = statements[i];
+        last = statements[i];
+    }
+    if (!remaining) {
+        free_program_tree(program->left_child);
+        free_program_tree(program->right_child);
+        *program = (ASTNode){PROGRAM_NODE, program->token_info, NULL, NULL, NULL};
+        removed[0] = false;
+        remaining = program;
+    }
+    for (int i = 0; i < statement_count; i++) {
+        if (removed[i]) free_program_tree(statements[i]);
+    }
+
+    for (int i = 0; i < symbols_found; i++) {
+        if (read_counts[i] > 0) has_slot[i] = true;
+    }
+    lay_out_variables(has_slot);
+
+    free(statements); free(targets); free(next_store); free(removed);
+    free(read_counts); free(first_store); free(worklist); free(has_slot);
+    return remaining;
+}
+
+// --- Register Allocation ---
+//
+// Int and char variables live in r8-r23, and float variables in f8-f23, from
+// the first statement that touches them to the last one, so straight-line
+// code works on them without going through memory. A variable is loaded when
+// its range starts if that statement reads it, and stored back when its range
+// ends if it was written. The two register files are scanned separately; when
+// more ranges overlap than one file has registers, linear scan spills the
+// range that ends last and that variable keeps its memory accesses.
+//
+// Ints are stored whole, but a char slot holds one byte, so a char's register
+// may carry high bits that lb would have replaced with copies of the sign
+// bit. Since its value can flow into a full-width int, the register is
+// sign-extended in place (dsll32/dsra32 by 24, i.e. 56 bits) before it is read.
+
+#define FIRST_VARIABLE_REGISTER 8
+#define VARIABLE_REGISTER_COUNT 16
+
+void note_live_variable(Token name, int statement_index) {
+    Symbol* variable = find_variable(name);
+    if (!variable) return;
+    if (variable->live_range >= 0) {
+        register_allocation.ranges[variable->live_range].end = statement_index;
+        return;
+    }
+    if (register_allocation.range_count == register_allocation.range_capacity) {
+        int capacity = register_allocation.range_capacity ? register_allocation.range_capacity * 2 : 64;
+        LiveRange* ranges = realloc(register_allocation.ranges, capacity * sizeof(LiveRange));
+        // Without a range the variable simply stays in memory
+        if (!ranges) return;
+        register_allocation.ranges = ranges;
+        register_allocation.range_capacity = capacity;
+    }
+    variable->live_range = register_allocation.range_count++;
+    register_allocation.ranges[variable->live_range] =
+        (LiveRange){statement_index, statement_index, (int)(variable - symbol_table), 0};
+}
+
+void note_live_variables(ASTNode* node, int statement_index) {
+    if (!node) return;
+    if (node->node_type == VARIABLE_NODE || node->node_type == ASSIGNMENT_NODE) {
+        note_live_variable(node->token_info, statement_index);
+    }
+    note_live_variables(node->left_child, statement_index);
+    note_live_variables(node->right_child, statement_index);
+}
+
+int compare_range_ends(const void* a, const void* b) {
+    return ((const LiveRange*)a)->end - ((const LiveRange*)b)->end;
+}
+
+// Keeps active ordered by increasing end
+void insert_active_range(const LiveRange* ranges, int* active, int* active_count, int range) {
+    int position = (*active_count)++;
+    while (position > 0 && ranges[active[position - 1]].end > ranges[range].end) {
+        active[position] = active[position - 1];
+        position--;
+    }
+    active[position] = range;
+}
+
+// Linear scan over the ranges whose variables live in one register file
+void scan_live_ranges(bool float_ranges) {
+    LiveRange* ranges = register_allocation.ranges;
+    int active[VARIABLE_REGISTER_COUNT];
+    int active_count = 0;
+    int free_registers[VARIABLE_REGISTER_COUNT];
+    int free_count = 0;
+    for (int i = VARIABLE_REGISTER_COUNT - 1; i >= 0; i--) {
+        free_registers[free_count++] = FIRST_VARIABLE_REGISTER + i;
+    }
+
+    for (int i = 0; i < register_allocation.range_count; i++) {
+        if ((symbol_table[ranges[i].symbol].type == 'f') != float_ranges) continue;
+        while (active_count && ranges[active[0]].end < ranges[i].start) {
+            free_registers[free_count++] = ranges[active[0]].home_register;
+            memmove(active, active + 1, --active_count * sizeof(int));
+        }
+        if (free_count) {
+            ranges[i].home_register = free_registers[--free_count];
+            insert_active_range(ranges, active, &active_count, i);
+            continue;
+        }
+        // Out of registers: whichever of the two ranges ends last is spilled
+        int last = active[active_count - 1];
+        if (ranges[last].end > ranges[i].end) {
+            ranges[i].home_register = ranges[last].home_register;
+            ranges[last].home_register = 0;
+            active_count--;
+            insert_active_range(ranges, active, &active_count, i);
         }
+    }
+}
+
+void allocate_variable_registers(ASTNode* program) {
+    register_allocation.range_count = 0;
+    register_allocation.ended_count = 0;
+    register_allocation.next_start = 0;
+    register_allocation.next_end = 0;
+    register_allocation.out_of_registers = false;
+    for (int i = 0; i < symbols_found; i++) {
+        symbol_table[i].live_range = -1;
+        symbol_table[i].home_register = 0;
+    }
+
+    // Statements are visited in order, so ranges come out sorted by start
+    int statement_index = 0;
+    for (ASTNode* statement = program; statement; statement = statement->next, statement_index++) {
+        // "int a;" only claims the slot, which generate_assembly_code zeroes
+        if (statement->node_type == DECLARATION_NODE && statement->left_child &&
+            statement->left_child->node_type == VARIABLE_NODE) continue;
+        note_live_variables(statement, statement_index);
+    }
+
+    scan_live_ranges(false);
+    scan_live_ranges(true);
+
+    if (register_allocation.range_count > register_allocation.ended_capacity) {
+        LiveRange* ended = realloc(register_allocation.ended, register_allocation.range_count * sizeof(LiveRange));
+        if (!ended) {
+            // Storing back needs the ranges ordered by end; keep everything in memory
+            compile_stats.spilled_registers += register_allocation.range_count;
+            for (int i = 0; i < symbols_found; i++) symbol_table[i].live_range = -1;
+            register_allocation.range_count = 0;
+            return;
+        }
+        register_allocation.ended = ended;
+        register_allocation.ended_capacity = register_allocation.range_count;
+    }
+    LiveRange* ranges = register_allocation.ranges;
+    for (int i = 0; i < register_allocation.range_count; i++) {
+        if (!ranges[i].home_register) {
+            compile_stats.spilled_registers++;
+            continue;
+        }
+        symbol_table[ranges[i].symbol].home_register = ranges[i].home_register;
+        register_allocation.ended[register_allocation.ended_count++] = ranges[i];
+    }
+    if (register_allocation.ended_count) {
+        qsort(register_allocation.ended, register_allocation.ended_count, sizeof(LiveRange), compare_range_ends);
+    }
+}
+
+// Whether node reads (or with writes_only, modifies) variable
+bool expression_uses_variable(ASTNode* node, Symbol* variable, bool writes_only) {
+    if (!node) return false;
+    if (node->node_type == UNARY_NODE && (node->token_info.type == INCREMENT || node->token_info.type == DECREMENT) &&
+        node->left_child && node->left_child->node_type == VARIABLE_NODE &&
+        find_variable(node->left_child->token_info) == variable) return true;
+    if (node->node_type == ASSIGNMENT_NODE && find_variable(node->token_info) == variable) return true;
+    if (!writes_only && node->node_type == VARIABLE_NODE && find_variable(node->token_info) == variable) return true;
+    return expression_uses_variable(node->left_child, variable, writes_only) ||
+           expression_uses_variable(node->right_child, variable, writes_only);
+}
+
+// Only "a = <expression without a>" can skip loading a first
+bool statement_reads_variable(ASTNode* statement, Symbol* variable) {
+    ASTNode* assignment = statement->node_type == DECLARATION_NODE ? statement->left_child : statement;
+    if (assignment && assignment->node_type == ASSIGNMENT_NODE &&
+        find_variable(assignment->token_info) == variable) {
+        return expression_uses_variable(assignment->left_child, variable, false);
+    }
+    return true;
+}
+
+RegisterPool* variable_register_file(Symbol* variable) {
+    return variable->type == 'f' ? &float_register_pool : &register_pool;
+}
+
+void begin_live_ranges(ASTNode* statement, int statement_index, CodeBuffer* output) {
+    register_allocation.statement_line = statement->token_info.line_number;
+    while (register_allocation.next_start < register_allocation.range_count &&
+           register_allocation.ranges[register_allocation.next_start].start == statement_index) {
+        LiveRange* range = &register_allocation.ranges[register_allocation.next_start++];
+        if (!range->home_register) continue;
+
+        Symbol* variable = &symbol_table[range->symbol];
+        RegisterPool* pool = variable_register_file(variable);
+        pool->used_registers[range->home_register] = 1;
+        variable->is_dirty = false;
+        variable->is_normalized = false;
+        if (statement_reads_variable(statement, variable)) {
+            Opcode load = load_opcode(variable);
+            emit_code(output, "    %s %s, %d(r0)\n", supported_instructions[load].instruction_name,
+                      pool->available_registers[range->home_register], variable->memory_location);
+            produce_machine_code(load, 0, range->home_register, -1, variable->memory_location, output);
+            variable->is_normalized = true;
+        }
+    }
+}
+
+void end_live_ranges(int statement_index, CodeBuffer* output) {
+    while (register_allocation.next_end < register_allocation.ended_count &&
+           register_allocation.ended[register_allocation.next_end].end == statement_index) {
+        LiveRange* range = &register_allocation.ended[register_allocation.next_end++];
+        Symbol* variable = &symbol_table[range->symbol];
+        RegisterPool* pool = variable_register_file(variable);
+        if (variable->is_dirty) {
+            Opcode store = store_opcode(variable);
+            emit_code(output, "    %s %s, %d(r0)\n", supported_instructions[store].instruction_name,
+                      pool->available_registers[range->home_register], variable->memory_location);
+            produce_machine_code(store, 0, range->home_register, -1, variable->memory_location, output);
+        }
+        pool->used_registers[range->home_register] = 0;
+    }
+}
+
+// The variable's register. A char is sign-extended first, as lb would give
+// it, since its value may go into a full-width int.
+const char* variable_register(Symbol* variable, CodeBuffer* output) {
+    const char* home = variable_register_file(variable)->available_registers[variable->home_register];
+    if (variable->size == 1 && !variable->is_normalized) {
+        emit_code(output, "    dsll32 %s, %s, 24\n", home, home);
+        produce_machine_code(OP_DSLL32, variable->home_register, -1, variable->home_register, 24, output);
+        emit_code(output, "    dsra32 %s, %s, 24\n", home, home);
+        produce_machine_code(OP_DSRA32, variable->home_register, -1, variable->home_register, 24, output);
+        variable->is_normalized = true;
+    }
+    return home;
+}
+
+// A variable operand that has a register is read from there directly, unless
+// evaluating sibling first could change it
+const char* resident_operand(ASTNode* operand, ASTNode* sibling, CodeBuffer* output) {
+    if (!operand || operand->node_type != VARIABLE_NODE) return NULL;
+    Symbol* variable = find_variable(operand->token_info);
+    if (!variable || !variable->home_register) return NULL;
+    if (sibling && expression_uses_variable(sibling, variable, true)) return NULL;
+    return variable_register(variable, output);
+}
+
+// Float operands resident in f8-f23 are used in place, like int ones
+const char* resident_float_operand(ASTNode* operand, ASTNode* sibling, CodeBuffer* output) {
+    if (get_expression_type(operand) != 'f') return NULL;
+    return resident_operand(operand, sibling, output);
+}
+
+// Whether a register loaded from expression already looks like an lb result
+bool holds_byte_value(ASTNode* expression) {
+    long long value;
+    if (constant_value(expression, &value)) return value >= -128 && value <= 127;
+    if (expression && expression->node_type == VARIABLE_NODE) {
+        Symbol* source = find_variable(expression->token_info);
+        return source && source->size == 1 && (!source->home_register || source->is_normalized);
+    }
+    return false;
+}
+
+// --- Code Generation (MIPS64) ---
+
+void generate_expression_code(ASTNode* node, CodeBuffer* output, const char* result_register) {
+    if (!node) return;
+    if (get_expression_type(node) == 'f') {
+        // A float value used as an int is truncated toward zero
+        const char* float_reg = get_float_register();
+        const char* source_register = resident_float_operand(node, NULL, output);
+        if (!source_register) {
+            generate_float_expression_code(node, output, float_reg);
+            source_register = float_reg;
+        }
+        emit_code(output, "    trunc.l.d %s, %s\n", float_reg, source_register);
+        produce_machine_code(OP_TRUNC_L_D, get_register_number(source_register), -1, get_register_number(float_reg), 0, output);
+        emit_code(output, "    dmfc1 %s, %s\n", result_register, float_reg);
+        produce_machine_code(OP_DMFC1, get_register_number(float_reg), get_register_number(result_register), -1, 0, output);
         release_float_register(float_reg);
     } else {
         switch (node->node_type) {
             case NUMBER_NODE:
-                fprintf(output, "    daddiu %s, r0, %s\n", result_register, node->token_info.text);
-                produce_machine_code("daddiu", 0, get_register_number(result_register), -1, atoi(node->token_info.text), output);
+                emit_code(output, "    daddiu %s, r0, %.*s\n", result_register, node->token_info.length, node->token_info.text);
+                produce_machine_code(OP_DADDIU, 0, get_register_number(result_register), -1, token_int_value(node->token_info), output);
                 break;
             case CHAR_NODE:
-                fprintf(output, "    daddiu %s, r0, %s\n", result_register, node->token_info.text);
-                produce_machine_code("daddiu", 0, get_register_number(result_register), -1, atoi(node->token_info.text), output);
+                emit_code(output, "    daddiu %s, r0, %.*s\n", result_register, node->token_info.length, node->token_info.text);
+                produce_machine_code(OP_DADDIU, 0, get_register_number(result_register), -1, token_int_value(node->token_info), output);
                 break;
-            case FLOAT_NODE: {
-                float float_val = atof(node->token_info.text);
-                int int_val = (int)float_val;
-                fprintf(output, "    daddiu %s, r0, %d\n", result_register, int_val);
-                produce_machine_code("daddiu", 0, get_register_number(result_register), -1, int_val, output);
+            case VARIABLE_NODE: {
+                Symbol* variable = find_variable(node->token_info);
+                if (variable && variable->home_register) {
+                    const char* home = variable_register(variable, output);
+                    emit_code(output, "    daddu %s, %s, r0\n", result_register, home);
+                    produce_machine_code(OP_DADDU, variable->home_register, 0, get_register_number(result_register), -1, output);
+                } else if (variable) {
+                    Opcode load = load_opcode(variable);
+                    emit_code(output, "    %s %s, %d(r0)\n", supported_instructions[load].instruction_name, result_register,
+                              variable->memory_location);
+                    produce_machine_code(load, 0, get_register_number(result_register), -1, variable->memory_location, output);
+                }
                 break;
             }
-            case VARIABLE_NODE: {
-                Symbol* variable = find_variable(node->token_info.text);
-                if (variable) {
-                    fprintf(output, "    lb %s, %d(r0)\n", result_register, variable->memory_location);
-                    produce_machine_code("lb", 0, get_register_number(result_register), -1, variable->memory_location, output);
+            case SHIFT_NODE: {
+                Opcode opcode = node->token_info.type == MULTIPLY ? OP_DSLL : OP_DSRL;
+                int shift_amount = token_int_value(node->right_child->token_info);
+                const char* operand_register = resident_operand(node->left_child, NULL, output);
+                if (!operand_register) {
+                    generate_expression_code(node->left_child, output, result_register);
+                    operand_register = result_register;
                 }
+                emit_code(output, "    %s %s, %s, %d\n", supported_instructions[opcode].instruction_name,
+                          result_register, operand_register, shift_amount);
+                produce_machine_code(opcode, get_register_number(operand_register), -1, get_register_number(result_register), shift_amount, output);
                 break;
             }
             case OPERATION_NODE: {
-                char* left_register = get_register();
-                char* right_register = get_register();
-                generate_expression_code(node->left_child, output, left_register);
-                generate_expression_code(node->right_child, output, right_register);
-                if (strcmp(node->token_info.text, "+") == 0) {
-                    fprintf(output, "    daddu %s, %s, %s\n", result_register, left_register, right_register);
-                    produce_machine_code("daddu", get_register_number(left_register), get_register_number(right_register), get_register_number(result_register), -1, output);
-                } else if (strcmp(node->token_info.text, "-") == 0) {
-                    fprintf(output, "    dsubu %s, %s, %s\n", result_register, left_register, right_register);
-                    produce_machine_code("dsubu", get_register_number(left_register), get_register_number(right_register), get_register_number(result_register), -1, output);
-                } else if (strcmp(node->token_info.text, "*") == 0) {
-                    fprintf(output, "    dmulu %s, %s\n", left_register, right_register);
-                    produce_machine_code("dmulu", get_register_number(left_register), get_register_number(right_register), -1, -1, output);
-                    fprintf(output, "    mflo %s\n", result_register);
-                    produce_machine_code("mflo", -1, -1, get_register_number(result_register), -1, output);
-                } else if (strcmp(node->token_info.text, "/") == 0) {
-                    fprintf(output, "    ddivu %s, %s\n", left_register, right_register);
-                    produce_machine_code("ddivu", get_register_number(left_register), get_register_number(right_register), -1, -1, output);
-                    fprintf(output, "    mflo %s\n", result_register);
-                    produce_machine_code("mflo", -1, -1, get_register_number(result_register), -1, output);
+                // One operand is built in result_register itself, so at most
+                // the right one needs a scratch register
+                const char* left_register = resident_operand(node->left_child, node->right_child, output);
+                char* right_scratch = NULL;
+                const char* right_register = NULL;
+                if (left_register) {
+                    right_register = resident_operand(node->right_child, NULL, output);
+                    if (!right_register) {
+                        generate_expression_code(node->right_child, output, result_register);
+                        right_register = result_register;
+                    }
+                } else {
+                    generate_expression_code(node->left_child, output, result_register);
+                    left_register = result_register;
+                    right_register = resident_operand(node->right_child, NULL, output);
+                }
+                if (!right_register) {
+                    right_scratch = get_register();
+                    generate_expression_code(node->right_child, output, right_scratch);
+                    right_register = right_scratch;
                 }
-                release_register_by_name(left_register);
-                release_register_by_name(right_register);
+                if (node->token_info.type == PLUS) {
+                    emit_code(output, "    daddu %s, %s, %s\n", result_register, left_register, right_register);
+                    produce_machine_code(OP_DADDU, get_register_number(left_register), get_register_number(right_register), get_register_number(result_register), -1, output);
+                } else if (node->token_info.type == MINUS) {
+                    emit_code(output, "    dsubu %s, %s, %s\n", result_register, left_register, right_register);
+                    produce_machine_code(OP_DSUBU, get_register_number(left_register), get_register_number(right_register), get_register_number(result_register), -1, output);
+                } else if (node->token_info.type == MULTIPLY) {
+                    emit_code(output, "    dmulu %s, %s\n", left_register, right_register);
+                    produce_machine_code(OP_DMULU, get_register_number(left_register), get_register_number(right_register), -1, -1, output);
+                    emit_code(output, "    mflo %s\n", result_register);
+                    produce_machine_code(OP_MFLO, -1, -1, get_register_number(result_register), -1, output);
+                } else if (node->token_info.type == DIVIDE) {
+                    emit_code(output, "    ddivu %s, %s\n", left_register, right_register);
+                    produce_machine_code(OP_DDIVU, get_register_number(left_register), get_register_number(right_register), -1, -1, output);
+                    emit_code(output, "    mflo %s\n", result_register);
+                    produce_machine_code(OP_MFLO, -1, -1, get_register_number(result_register), -1, output);
+                }
+                if (right_scratch) release_register_by_name(right_scratch);
                 break;
             }
             default: break;
@@ -1064,204 +2227,762 @@ void generate_expression_code(ASTNode* node, FILE* output, const char* result_re
     }
 }
 
-void generate_assignment_code(const char* variable_name, ASTNode* expression, FILE* output) {
+Opcode float_operation_opcode(TokenType operation) {
+    switch (operation) {
+        case PLUS: case PLUS_ASSIGN: return OP_ADD_D;
+        case MINUS: case MINUS_ASSIGN: return OP_SUB_D;
+        case MULTIPLY: case MULTIPLY_ASSIGN: return OP_MUL_D;
+        default: return OP_DIV_D;
+    }
+}
+
+// Converts an int or char expression to double in float_register. The whole
+// 64-bit value is converted.
+void generate_int_to_float_code(ASTNode* node, CodeBuffer* output, const char* float_register) {
+    const char* int_register = resident_operand(node, NULL, output);
+    char* scratch = NULL;
+    if (!int_register) {
+        scratch = get_register();
+        generate_expression_code(node, output, scratch);
+        int_register = scratch;
+    }
+    emit_code(output, "    dmtc1 %s, %s\n", int_register, float_register);
+    produce_machine_code(OP_DMTC1, get_register_number(float_register), get_register_number(int_register), -1, 0, output);
+    emit_code(output, "    cvt.d.l %s, %s\n", float_register, float_register);
+    produce_machine_code(OP_CVT_D_L, get_register_number(float_register), -1, get_register_number(float_register), 0, output);
+    if (scratch) release_register_by_name(scratch);
+}
+
+void generate_float_expression_code(ASTNode* node, CodeBuffer* output, const char* float_register) {
+    if (!node) return;
+    if (get_expression_type(node) != 'f') {
+        long long value;
+        if (constant_value(node, &value)) load_float_constant((double)value, float_register, output);
+        else generate_int_to_float_code(node, output, float_register);
+        return;
+    }
+
+    switch (node->node_type) {
+        case FLOAT_NODE:
+            load_float_constant(token_float_value(node->token_info), float_register, output);
+            break;
+        case VARIABLE_NODE: {
+            Symbol* variable = find_variable(node->token_info);
+            if (variable && variable->home_register) {
+                const char* home = variable_register(variable, output);
+                emit_code(output, "    mov.d %s, %s\n", float_register, home);
+                produce_machine_code(OP_MOV_D, variable->home_register, -1, get_register_number(float_register), 0, output);
+            } else if (variable) {
+                emit_code(output, "    l.d %s, %d(r0)\n", float_register, variable->memory_location);
+                produce_machine_code(OP_L_D, 0, get_register_number(float_register), -1, variable->memory_location, output);
+            }
+            break;
+        }
+        case OPERATION_NODE: {
+            // Same shape as the int case: the left operand is built in
+            // float_register unless it is resident
+            const char* left_register = resident_float_operand(node->left_child, node->right_child, output);
+            const char* right_scratch = NULL;
+            const char* right_register = NULL;
+            if (left_register) {
+                right_register = resident_float_operand(node->right_child, NULL, output);
+                if (!right_register) {
+                    generate_float_expression_code(node->right_child, output, float_register);
+                    right_register = float_register;
+                }
+            } else {
+                generate_float_expression_code(node->left_child, output, float_register);
+                left_register = float_register;
+                right_register = resident_float_operand(node->right_child, NULL, output);
+            }
+            if (!right_register) {
+                right_scratch = get_float_register();
+                generate_float_expression_code(node->right_child, output, right_scratch);
+                right_register = right_scratch;
+            }
+            Opcode opcode = float_operation_opcode(node->token_info.type);
+            emit_code(output, "    %s %s, %s, %s\n", supported_instructions[opcode].instruction_name,
+                      float_register, left_register, right_register);
+            produce_machine_code(opcode, get_register_number(left_register), get_register_number(right_register), get_register_number(float_register), 0, output);
+            if (right_scratch) release_float_register(right_scratch);
+            break;
+        }
+        default: break;
+    }
+}
+
+void generate_assignment_code(Token variable_name, ASTNode* expression, CodeBuffer* output) {
     Symbol* variable = find_variable(variable_name);
     if (!variable) return;
 
-    if (variable->type == 'f') {
-        const char* float_reg = get_float_register();
-        char* temp_reg = get_register();
-        generate_expression_code(expression, output, temp_reg);
-        fprintf(output, "    dmtc1 %s, %s\n", temp_reg, float_reg);
-        produce_machine_code("dmtc1", get_register_number(temp_reg), get_register_number(float_reg), -1, 0, output);
-        char expr_type = get_expression_type(expression);
-        if (expr_type != 'f') {
-            fprintf(output, "    cvt.d.l %s, %s\n", float_reg, float_reg);
-            produce_machine_code("cvt.d.l", get_register_number(float_reg), get_register_number(float_reg), get_register_number(float_reg), 0, output);
+    if (variable->type == 'f' && variable->home_register) {
+        const char* home = float_register_pool.available_registers[variable->home_register];
+        if (expression_uses_variable(expression, variable, false)) {
+            const char* scratch = get_float_register();
+            generate_float_expression_code(expression, output, scratch);
+            emit_code(output, "    mov.d %s, %s\n", home, scratch);
+            produce_machine_code(OP_MOV_D, get_register_number(scratch), -1, variable->home_register, 0, output);
+            release_float_register(scratch);
+        } else {
+            generate_float_expression_code(expression, output, home);
         }
-        fprintf(output, "    s.d %s, %d(r0)\n", float_reg, variable->memory_location);
-        produce_machine_code("s.d", 0, get_register_number(float_reg), -1, variable->memory_location, output);
-        release_register_by_name(temp_reg);
+        variable->is_dirty = true;
+    } else if (variable->type == 'f') {
+        const char* float_reg = get_float_register();
+        generate_float_expression_code(expression, output, float_reg);
+        emit_code(output, "    s.d %s, %d(r0)\n", float_reg, variable->memory_location);
+        produce_machine_code(OP_S_D, 0, get_register_number(float_reg), -1, variable->memory_location, output);
         release_float_register(float_reg);
+    } else if (variable->home_register) {
+        const char* home = register_pool.available_registers[variable->home_register];
+        if (expression_uses_variable(expression, variable, false)) {
+            // Computing into home would clobber a value the expression still reads
+            char* scratch = get_register();
+            generate_expression_code(expression, output, scratch);
+            emit_code(output, "    daddu %s, %s, r0\n", home, scratch);
+            produce_machine_code(OP_DADDU, get_register_number(scratch), 0, variable->home_register, -1, output);
+            release_register_by_name(scratch);
+        } else {
+            generate_expression_code(expression, output, home);
+        }
+        variable->is_normalized = holds_byte_value(expression);
+        variable->is_dirty = true;
     } else {
         char* result_register = get_register();
+        Opcode store = store_opcode(variable);
         generate_expression_code(expression, output, result_register);
-        fprintf(output, "    sb %s, %d(r0)\n", result_register, variable->memory_location);
-        produce_machine_code("sb", 0, get_register_number(result_register), -1, variable->memory_location, output);
+        emit_code(output, "    %s %s, %d(r0)\n", supported_instructions[store].instruction_name, result_register,
+                  variable->memory_location);
+        produce_machine_code(store, 0, get_register_number(result_register), -1, variable->memory_location, output);
         release_register_by_name(result_register);
     }
 }
 
-void generate_assembly_code(ASTNode* node, FILE* output) {
+void generate_float_compound_assignment(Symbol* variable, ASTNode* expression, TokenType operation, CodeBuffer* output) {
+    const char* float_reg;
+    if (variable->home_register) {
+        float_reg = float_register_pool.available_registers[variable->home_register];
+    } else {
+        float_reg = get_float_register();
+        emit_code(output, "    l.d %s, %d(r0)\n", float_reg, variable->memory_location);
+        produce_machine_code(OP_L_D, 0, get_register_number(float_reg), -1, variable->memory_location, output);
+    }
+
+    const char* expr_reg = resident_float_operand(expression, NULL, output);
+    const char* expr_scratch = NULL;
+    if (!expr_reg) {
+        expr_scratch = get_float_register();
+        generate_float_expression_code(expression, output, expr_scratch);
+        expr_reg = expr_scratch;
+    }
+    Opcode opcode = float_operation_opcode(operation);
+    emit_code(output, "    %s %s, %s, %s\n", supported_instructions[opcode].instruction_name,
+              float_reg, float_reg, expr_reg);
+    produce_machine_code(opcode, get_register_number(float_reg), get_register_number(expr_reg), get_register_number(float_reg), 0, output);
+    if (expr_scratch) release_float_register(expr_scratch);
+
+    if (variable->home_register) {
+        variable->is_dirty = true;
+    } else {
+        emit_code(output, "    s.d %s, %d(r0)\n", float_reg, variable->memory_location);
+        produce_machine_code(OP_S_D, 0, get_register_number(float_reg), -1, variable->memory_location, output);
+        release_float_register(float_reg);
+    }
+}
+
+void generate_assembly_code(ASTNode* node, CodeBuffer* output) {
     if (!node) return;
-    fprintf(output, ".code\n");
+    float_constant_pool.count = 0;
+    if (float_constant_pool.slots) {
+        memset(float_constant_pool.slots, 0, float_constant_pool.slot_capacity * sizeof(int));
+    }
+    float_constant_pool.overflowed = false;
+    emit_code(output, ".code\n");
     ASTNode* current = node;
 
-    // First pass: Handle declarations and variable initialization
+    // First pass: "float f;" starts at 0.0, loaded from the pool once for all of them
+    const char* zero_reg = NULL;
     while (current) {
         if (current->node_type == DECLARATION_NODE && current->left_child && current->left_child->node_type == VARIABLE_NODE) {
-            Symbol* variable = find_variable(current->left_child->token_info.text);
+            Symbol* variable = find_variable(current->left_child->token_info);
             if (variable && variable->type == 'f') {
-                const char* float_reg = get_float_register();
-                char* temp_reg = get_register();
-                fprintf(output, "    daddiu %s, r0, 0\n", temp_reg);
-                produce_machine_code("daddiu", 0, get_register_number(temp_reg), -1, 0, output);
-                fprintf(output, "    dmtc1 %s, %s\n", temp_reg, float_reg);
-                produce_machine_code("dmtc1", get_register_number(temp_reg), get_register_number(float_reg), -1, 0, output);
-                fprintf(output, "    cvt.d.l %s, %s\n", float_reg, float_reg);
-                produce_machine_code("cvt.d.l", get_register_number(float_reg), get_register_number(float_reg), get_register_number(float_reg), 0, output);
-                fprintf(output, "    s.d %s, %d(r0)\n", float_reg, variable->memory_location);
-                produce_machine_code("s.d", 0, get_register_number(float_reg), -1, variable->memory_location, output);
-                release_register_by_name(temp_reg);
-                release_float_register(float_reg);
+                if (!zero_reg) {
+                    zero_reg = get_float_register();
+                    load_float_constant(0.0, zero_reg, output);
+                }
+                emit_code(output, "    s.d %s, %d(r0)\n", zero_reg, variable->memory_location);
+                produce_machine_code(OP_S_D, 0, get_register_number(zero_reg), -1, variable->memory_location, output);
             }
         }
         current = current->next;
     }
+    if (zero_reg) release_float_register(zero_reg);
 
     // Second pass: Generate code for statements
     current = node;
+    int statement_index = 0;
     while (current) {
+        begin_live_ranges(current, statement_index, output);
         switch (current->node_type) {
             case DECLARATION_NODE:
                 if (current->left_child && current->left_child->node_type == ASSIGNMENT_NODE)
-                    generate_assignment_code(current->left_child->token_info.text, current->left_child->left_child, output);
+                    generate_assignment_code(current->left_child->token_info, current->left_child->left_child, output);
                 break;
             case ASSIGNMENT_NODE:
-                generate_assignment_code(current->token_info.text, current->left_child, output);
+                generate_assignment_code(current->token_info, current->left_child, output);
                 break;
             case COMPOUND_ASSIGN_NODE:
                 if (current->left_child && current->left_child->node_type == VARIABLE_NODE) {
-                    Symbol* variable = find_variable(current->left_child->token_info.text);
-                    if (variable && variable->type == 'f') {
-                        const char* float_reg = get_float_register();
-                        const char* expr_reg = get_float_register();
-                        char* temp_reg = get_register();
-                        fprintf(output, "    l.d %s, %d(r0)\n", float_reg, variable->memory_location);
-                        produce_machine_code("l.d", 0, get_register_number(float_reg), -1, variable->memory_location, output);
-                        generate_expression_code(current->right_child, output, temp_reg);
-                        fprintf(output, "    dmtc1 %s, %s\n", temp_reg, expr_reg);
-                        produce_machine_code("dmtc1", get_register_number(temp_reg), get_register_number(expr_reg), -1, 0, output);
-                        char expr_type = get_expression_type(current->right_child);
-                        if (expr_type != 'f') {
-                            fprintf(output, "    cvt.d.l %s, %s\n", expr_reg, expr_reg);
-                            produce_machine_code("cvt.d.l", get_register_number(expr_reg), get_register_number(expr_reg), get_register_number(expr_reg), 0, output);
-                        }
-                        if (strcmp(current->token_info.text, "+=") == 0) {
-                            fprintf(output, "    add.d %s, %s, %s\n", float_reg, float_reg, expr_reg);
-                            produce_machine_code("add.d", get_register_number(float_reg), get_register_number(expr_reg), get_register_number(float_reg), 0, output);
-                        } else if (strcmp(current->token_info.text, "-=") == 0) {
-                            fprintf(output, "    sub.d %s, %s, %s\n", float_reg, float_reg, expr_reg);
-                            produce_machine_code("sub.d", get_register_number(float_reg), get_register_number(expr_reg), get_register_number(float_reg), 0, output);
-                        } else if (strcmp(current->token_info.text, "*=") == 0) {
-                            fprintf(output, "    mul.d %s, %s, %s\n", float_reg, float_reg, expr_reg);
-                            produce_machine_code("mul.d", get_register_number(float_reg), get_register_number(expr_reg), get_register_number(float_reg), 0, output);
-                        } else if (strcmp(current->token_info.text, "/=") == 0) {
-                            fprintf(output, "    div.d %s, %s, %s\n", float_reg, float_reg, expr_reg);
-                            produce_machine_code("div.d", get_register_number(float_reg), get_register_number(expr_reg), get_register_number(float_reg), 0, output);
-                        }
-                        fprintf(output, "    s.d %s, %d(r0)\n", float_reg, variable->memory_location);
-                        produce_machine_code("s.d", 0, get_register_number(float_reg), -1, variable->memory_location, output);
-                        release_float_register(float_reg);
-                        release_float_register(expr_reg);
-                        release_register_by_name(temp_reg);
-                    }
+                    Symbol* variable = find_variable(current->left_child->token_info);
+                    if (variable && variable->type == 'f')
+                        generate_float_compound_assignment(variable, current->right_child, current->token_info.type, output);
                 }
                 break;
             default: break;
         }
+        end_live_ranges(statement_index, output);
         current = current->next;
+        statement_index++;
     }
 }
 
+// --- Peephole Optimization ---
+//
+// The program is straight-line code and every variable access is an lb/sb,
+// ld/sd or l.d/s.d at a fixed offset from r0, so a forward pass can follow which
+// register still holds each variable's value and a backward pass can see
+// which stores are overwritten before anything reads them:
+//   - a load of a value that a register still holds becomes a move, or is
+//     dropped when it would reload the register the value came from; float
+//     constants loaded again from the pool are covered the same way;
+//   - a move whose target the next instruction increments in place is folded
+//     into that daddiu;
+//   - a store that a later store to the same variable overwrites is dropped.
+// Slots never overlap, so each one is tracked by its byte offset. An sb only
+// keeps the low byte, so it is forwarded only from a register known to hold
+// the sign-extended byte lb would give; ld/sd and l.d/s.d move whole values.
+
+#define FLOAT_REGISTER_BASE 32  // f0-f31 are tracked as 32-63, after r0-r31
+
+// Register the instruction writes, -1 for none
+int instruction_destination(const PendingInstruction* instruction) {
+    switch (instruction->opcode) {
+        case OP_SB: case OP_SD: case OP_S_D: case OP_DMULU: case OP_DDIVU: return -1;
+        case OP_L_D: return FLOAT_REGISTER_BASE + instruction->target_reg;
+        case OP_DMTC1: case OP_MTC1: return FLOAT_REGISTER_BASE + instruction->source_reg;
+        case OP_DMFC1: case OP_MFC1: return instruction->target_reg;
+        default: break;
+    }
+    switch (supported_instructions[instruction->opcode].instruction_format) {
+        case FORMAT_I: return instruction->target_reg;
+        case FORMAT_COP1_CONVERT: case FORMAT_COP1_ARITH: return FLOAT_REGISTER_BASE + instruction->dest_reg;
+        default: return instruction->dest_reg;
+    }
+}
+
+// Whether the register the instruction writes ends up holding what lb would give
+bool produces_byte_value(const PendingInstruction* instruction, const bool* normalized) {
+    switch (instruction->opcode) {
+        case OP_LB:
+            return true;
+        case OP_DADDIU:
+            return instruction->source_reg == 0 &&
+                   instruction->immediate_value >= -128 && instruction->immediate_value <= 127;
+        case OP_DADDU:
+            return instruction->target_reg == 0 && normalized[instruction->source_reg];
+        case OP_DSRA32:
+            return instruction->immediate_value >= 24;
+        default:
+            return false;
+    }
+}
+
+bool is_load(Opcode opcode) { return opcode == OP_LB || opcode == OP_LD || opcode == OP_L_D; }
+bool is_store(Opcode opcode) { return opcode == OP_SB || opcode == OP_SD || opcode == OP_S_D; }
+
+// Offset of the variable or pool slot a load or store accesses, -1 for any
+// other instruction
+int accessed_slot(const PendingInstruction* instruction, int slot_count) {
+    if (!is_load(instruction->opcode) && !is_store(instruction->opcode)) return -1;
+    if (instruction->source_reg != 0 || instruction->immediate_value < 0 ||
+        instruction->immediate_value >= slot_count) return -1;
+    return instruction->immediate_value;
+}
+
+void rewrite_instruction(PendingInstruction* instruction, Opcode opcode,
+                         int source_reg, int target_reg, int dest_reg, int immediate_value) {
+    CodeBuffer* text = &instruction_list.rewritten_text;
+    size_t start = text->length;
+    if (opcode == OP_DADDU) {
+        emit_code(text, "    daddu r%d, r%d, r%d\n", dest_reg, source_reg, target_reg);
+    } else if (opcode == OP_MOV_D) {
+        emit_code(text, "    mov.d f%d, f%d\n", dest_reg, source_reg);
+    } else {
+        emit_code(text, "    daddiu r%d, r%d, %d\n", target_reg, source_reg, immediate_value);
+    }
+    instruction->opcode = opcode;
+    instruction->source_reg = source_reg;
+    instruction->target_reg = target_reg;
+    instruction->dest_reg = dest_reg;
+    instruction->immediate_value = immediate_value;
+    instruction->rewritten_start = (long)start;
+    instruction->rewritten_length = (int)(text->length - start);
+}
+
+void forward_stored_values(int slot_count, int* slot_register, unsigned int* slot_version) {
+    unsigned int register_version[2 * FLOAT_REGISTER_BASE] = {0};
+    bool normalized[2 * FLOAT_REGISTER_BASE] = {true};  // r0
+    PendingInstruction* previous = NULL;
+    for (int i = 0; i < slot_count; i++) slot_register[i] = -1;
+
+    for (int i = 0; i < instruction_list.count; i++) {
+        PendingInstruction* instruction = &instruction_list.items[i];
+        int slot = accessed_slot(instruction, slot_count);
+        bool is_float = instruction->opcode == OP_L_D || instruction->opcode == OP_S_D;
+        int value_register = (is_float ? FLOAT_REGISTER_BASE : 0) + instruction->target_reg;
+
+        if (is_store(instruction->opcode)) {
+            if (slot >= 0) {
+                bool forwardable = instruction->opcode != OP_SB || normalized[value_register];
+                slot_register[slot] = forwardable ? value_register : -1;
+                slot_version[slot] = register_version[value_register];
+            }
+            previous = instruction;
+            continue;
+        }
+
+        if (slot >= 0) {
+            int holder = slot_register[slot];
+            if (holder >= 0 && slot_version[slot] == register_version[holder]) {
+                if (holder == value_register) {
+                    instruction->removed = true;
+                    continue;
+                }
+                if (is_float) {
+                    rewrite_instruction(instruction, OP_MOV_D, holder - FLOAT_REGISTER_BASE, -1,
+                                        instruction->target_reg, 0);
+                } else {
+                    rewrite_instruction(instruction, OP_DADDU, holder, 0, instruction->target_reg, -1);
+                }
+                slot = -1;
+            }
+        }
+
+        if (instruction->opcode == OP_DADDIU && previous && previous->opcode == OP_DADDU &&
+            previous->target_reg == 0 && previous->dest_reg == instruction->target_reg &&
+            instruction->source_reg == instruction->target_reg) {
+            previous->removed = true;
+            rewrite_instruction(instruction, OP_DADDIU, previous->source_reg, instruction->target_reg,
+                                -1, instruction->immediate_value);
+        }
+
+        int destination = instruction_destination(instruction);
+        if (destination > 0) {
+            bool byte_value = produces_byte_value(instruction, normalized);
+            register_version[destination]++;
+            normalized[destination] = byte_value;
+            if (slot >= 0) {
+                slot_register[slot] = destination;
+                slot_version[slot] = register_version[destination];
+            }
+        }
+        previous = instruction;
+    }
+}
+
+void remove_dead_stores(int slot_count, int* overwritten) {
+    memset(overwritten, 0, slot_count * sizeof(int));
+    for (int i = instruction_list.count - 1; i >= 0; i--) {
+        PendingInstruction* instruction = &instruction_list.items[i];
+        int slot = accessed_slot(instruction, slot_count);
+        if (instruction->removed || slot < 0) continue;
+        if (is_load(instruction->opcode)) {
+            overwritten[slot] = 0;
+        } else if (overwritten[slot]) {
+            instruction->removed = true;
+        } else {
+            overwritten[slot] = 1;
+        }
+    }
+}
+
+// The pass only removes work, so when its scratch arrays cannot be had the
+// instructions are simply rendered as generated
+void optimize_instruction_stream() {
+    int slot_count = next_memory_location + 8 * float_constant_pool.count + 1;
+    int* slot_register = malloc(slot_count * sizeof(int));
+    unsigned int* slot_version = malloc(slot_count * sizeof(unsigned int));
+    if (slot_register && slot_version) {
+        forward_stored_values(slot_count, slot_register, slot_version);
+        remove_dead_stores(slot_count, slot_register);
+    }
+    free(slot_register);
+    free(slot_version);
+}
+
+// Writes the .data section, then each surviving instruction followed by its
+// machine code, keeping the other lines of assembly_text where they were
+void render_listing(CodeBuffer* listing) {
+    const CodeBuffer* text = &instruction_list.assembly_text;
+    if (text->out_of_memory || instruction_list.rewritten_text.out_of_memory) listing->out_of_memory = true;
+
+    emit_data_section(listing);
+    size_t copied = 0;
+    for (int i = 0; i < instruction_list.count; i++) {
+        const PendingInstruction* instruction = &instruction_list.items[i];
+        emit_bytes(listing, text->data + copied, instruction->line_start - copied);
+        copied = instruction->line_start + instruction->line_length;
+        if (instruction->removed) continue;
+        if (instruction->rewritten_start >= 0) {
+            emit_bytes(listing, instruction_list.rewritten_text.data + instruction->rewritten_start,
+                       instruction->rewritten_length);
+        } else {
+            emit_bytes(listing, text->data + instruction->line_start, instruction->line_length);
+        }
+        render_machine_code(instruction, listing);
+    }
+    emit_bytes(listing, text->data + copied, text->length - copied);
+}
+
+// --- Compile Statistics ---
+
+double elapsed_seconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+void start_phase(void) {
+    if (compile_stats.enabled) timespec_get(&compile_stats.phase_start, TIME_UTC);
+}
+
+// Charges the time since the previous start_phase or end_phase to phase
+void end_phase(CompilePhase phase) {
+    if (!compile_stats.enabled) return;
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    compile_stats.phase_milliseconds[phase] += 1000 * elapsed_seconds(compile_stats.phase_start, now);
+    compile_stats.phase_start = now;
+}
+
+int count_emitted_instructions(void) {
+    int emitted = 0;
+    for (int i = 0; i < instruction_list.count; i++) {
+        if (!instruction_list.items[i].removed) emitted++;
+    }
+    return emitted;
+}
+
+// One JSON object on one line, so a log collector can take it as it is
+void report_stats(bool compiled, FILE* output) {
+    static const char* phase_names[PHASE_COUNT] = {
+        "lex", "parse", "semantic", "optimize", "codegen", "output"
+    };
+    fprintf(output, "{\"compiled\":%s", compiled ? "true" : "false");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        fprintf(output, ",\"%s_ms\":%.3f", phase_names[i], compile_stats.phase_milliseconds[i]);
+    }
+    fprintf(output, ",\"tokens\":%d,\"ast_nodes\":%d,\"symbols\":%d,\"instructions\":%d,"
+            "\"spilled_registers\":%d,\"bytes_written\":%lu}\n",
+            current_token_count, compile_stats.ast_nodes, symbols_found, count_emitted_instructions(),
+            compile_stats.spilled_registers, (unsigned long)compile_stats.bytes_written);
+}
+
 // --- Main Driver and File I/O ---
 
-void show_generated_code(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("could not open the generated file\n");
-        return;
+void show_generated_code(const CodeBuffer* listing) {
+    write_code_buffer(listing, stdout);
+}
+
+// The object file sits next to the listing: "output.s" -> "output.bin"
+void object_filename_for(const char* listing_filename, char* buffer, size_t size) {
+    size_t length = strlen(listing_filename);
+    if (length > 2 && strcmp(listing_filename + length - 2, ".s") == 0) length -= 2;
+    snprintf(buffer, size, "%.*s.bin", (int)length, listing_filename);
+}
+
+bool write_object_file(const CodeBuffer* object, const char* filename) {
+    FILE* object_file = fopen(filename, "wb");
+    if (!object_file) {
+        fprintf(stderr, "cannot create object file: %s\n", filename);
+        return false;
     }
-    char line[256];
-    while (fgets(line, sizeof(line), file)) printf("%s", line);
-    fclose(file);
+    bool written = write_code_buffer(object, object_file);
+    fclose(object_file);
+    return written;
 }
 
-void compile_program(const char* source_code, const char* output_filename) {
+// Generates the listing into code_output, then writes it to output_filename
+// and/or stdout as target asks. The RAW machine code formats always write
+// their object file as well.
+bool compile_program(const char* source_code, const char* output_filename, EmitTarget target) {
     current_token_count = 0;
     current_token_position = 0;
     symbols_found = 0;
+    if (symbol_slots) memset(symbol_slots, 0, slot_capacity * sizeof(int));
     next_memory_location = 0;
     error_log.error_count = 0;
+    clear_code_buffer(&code_output);
+    clear_code_buffer(&object_output);
+    instruction_list.count = 0;
+    clear_code_buffer(&instruction_list.assembly_text);
+    clear_code_buffer(&instruction_list.rewritten_text);
     clear_registers();
+    compile_stats = (CompileStats){.enabled = compile_stats.enabled};
+    start_phase();
 
     break_into_tokens(source_code);
+    end_phase(PHASE_LEX);
 
     if (error_log.error_count) {
         printf("\nlexical errors found:\n");
         display_errors();
-        return;
+        return false;
     }
 
     ASTNode* program_structure = parse_program();
+    end_phase(PHASE_PARSE);
 
     if (error_log.error_count || !program_structure) {
         printf("syntax errors found:\n");
         display_errors();
         free_program_tree(program_structure);
-        return;
+        return false;
     }
 
     check_program_semantics(program_structure);
     check_for_unused_variables();
+    end_phase(PHASE_SEMANTIC);
 
     if (error_log.error_count) {
         printf("semantic errors found:\n");
         display_errors();
         free_program_tree(program_structure);
-        return;
+        return false;
     }
 
-    FILE* output_file = fopen(output_filename, "w");
-    if (!output_file) {
-        fprintf(stderr, "cannot create output file: %s\n", output_filename);
+    optimize_program(program_structure);
+    if (drop_unused_variables) program_structure = eliminate_dead_code(program_structure);
+    else lay_out_variables(NULL);
+    end_phase(PHASE_OPTIMIZE);
+
+    if (error_log.error_count) {
+        printf("semantic errors found:\n");
+        display_errors();
         free_program_tree(program_structure);
-        return;
+        return false;
     }
-
     setup_registers();
-    generate_assembly_code(program_structure, output_file);
-    fclose(output_file);
-
-    show_generated_code(output_filename);
+    allocate_variable_registers(program_structure);
+    generate_assembly_code(program_structure, &instruction_list.assembly_text);
     free_program_tree(program_structure);
+
+    if (error_log.error_count) {
+        end_phase(PHASE_CODEGEN);
+        printf("code generation errors found:\n");
+        display_errors();
+        return false;
+    }
+    optimize_instruction_stream();
+    render_listing(&code_output);
+    end_phase(PHASE_CODEGEN);
+    if (code_output.out_of_memory || object_output.out_of_memory) {
+        fprintf(stderr, "not enough memory for the generated code\n");
+        return false;
+    }
+
+    if (machine_format == MACHINE_CODE_RAW_LE || machine_format == MACHINE_CODE_RAW_BE) {
+        char object_filename[4096];
+        object_filename_for(output_filename, object_filename, sizeof(object_filename));
+        if (write_object_file(&object_output, object_filename)) compile_stats.bytes_written += object_output.length;
+    }
+
+    if (target & EMIT_FILE) {
+        FILE* output_file = fopen(output_filename, "w");
+        if (!output_file) {
+            fprintf(stderr, "cannot create output file: %s\n", output_filename);
+            end_phase(PHASE_OUTPUT);
+            return false;
+        }
+        if (write_code_buffer(&code_output, output_file)) compile_stats.bytes_written += code_output.length;
+        fclose(output_file);
+    }
+    if (target & EMIT_STDOUT) {
+        show_generated_code(&code_output);
+        compile_stats.bytes_written += code_output.length;
+    }
+    end_phase(PHASE_OUTPUT);
+    return true;
 }
 
-char* read_source_code() {
-    char* code = malloc(50000);
-    if (!code) {
-        printf("Error: Not enough memory to read source code.\n");
-        return NULL;
+// Maps the whole file read-only. The lexer needs a '\0' after the last byte;
+// the unused tail of the final page is zero-filled, so that is free unless
+// the file ends exactly on a page boundary, in which case we fall back to
+// reading it.
+bool map_source_file(const char* path, SourceBuffer* source) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0 ||
+        file_size.QuadPart % system_info.dwPageSize == 0) {
+        CloseHandle(file);
+        return false;
     }
-    code[0] = '\0';
-    FILE* source_file = fopen("code.b", "r");
-    if (!source_file) source_file = stdin;
-    char line[256];
-    while (fgets(line, sizeof(line), source_file)) {
-        if (strlen(code) + strlen(line) >= 50000) {
-            printf("Error: Source code exceeds maximum size (50,000 characters).\n");
-            break;
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    // The view keeps the mapping alive on its own
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(file);
+    if (!view) return false;
+    size_t length = (size_t)file_size.QuadPart;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0) return false;
+    struct stat file_info;
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (fstat(file, &file_info) != 0 || !S_ISREG(file_info.st_mode) || file_info.st_size == 0 ||
+        file_info.st_size % page_size == 0) {
+        close(file);
+        return false;
+    }
+    size_t length = (size_t)file_info.st_size;
+    void* view = mmap(NULL, length, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED) return false;
+#endif
+    *source = (SourceBuffer){view, length, view, length};
+    return true;
+}
+
+bool read_source_stream(FILE* source_file, SourceBuffer* source) {
+    size_t capacity = 65536;
+    size_t length = 0;
+    char* code = malloc(capacity);
+    if (!code) return false;
+    for (;;) {
+        length += fread(code + length, 1, capacity - length - 1, source_file);
+        if (length < capacity - 1) break;
+        char* larger = realloc(code, capacity * 2);
+        if (!larger) {
+            free(code);
+            return false;
+        }
+        code = larger;
+        capacity *= 2;
+    }
+    code[length] = '\0';
+    *source = (SourceBuffer){code, length, NULL, 0};
+    return true;
+}
+
+// Loads the program from path, or from stdin when the default code.b is
+// missing. The source is mapped when possible so tokens point into the file.
+bool load_source_code(const char* path, bool path_given, SourceBuffer* source) {
+    if (map_source_file(path, source)) return true;
+
+    FILE* source_file = fopen(path, "rb");
+    if (!source_file) {
+        if (path_given) {
+            printf("Error: cannot open source file: %s\n", path);
+            return false;
         }
-        strcat(code, line);
+        source_file = stdin;
     }
+    bool loaded = read_source_stream(source_file, source);
     if (source_file != stdin) fclose(source_file);
-    return code;
+    if (!loaded) printf("Error: Not enough memory to read source code.\n");
+    return loaded;
 }
 
-int main() {
-    char* source_code = read_source_code();
-    if (!source_code) return 1;
-    compile_program(source_code, "output.s");
-    free(source_code);
+void release_source_code(SourceBuffer* source) {
+    if (source->mapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(source->mapping);
+#else
+        munmap(source->mapping, source->mapping_length);
+#endif
+    } else {
+        free((char*)source->text);
+    }
+}
+
+// Parses the value of --emit
+bool parse_emit_target(const char* name, EmitTarget* target) {
+    if (strcmp(name, "file") == 0) *target = EMIT_FILE;
+    else if (strcmp(name, "stdout") == 0) *target = EMIT_STDOUT;
+    else if (strcmp(name, "both") == 0) *target = EMIT_BOTH;
+    else return false;
+    return true;
+}
+
+// Parses the value of --unused
+bool parse_unused_variables(const char* name, bool* drop) {
+    if (strcmp(name, "keep") == 0) *drop = false;
+    else if (strcmp(name, "drop") == 0) *drop = true;
+    else return false;
+    return true;
+}
+
+// Parses the value of --stats
+bool parse_stats_mode(const char* name, bool* enabled) {
+    if (strcmp(name, "off") == 0) *enabled = false;
+    else if (strcmp(name, "json") == 0) *enabled = true;
+    else return false;
+    return true;
+}
+
+// Parses the value of --format
+bool parse_machine_code_format(const char* name, MachineCodeFormat* format) {
+    if (strcmp(name, "binary") == 0) *format = MACHINE_CODE_BINARY;
+    else if (strcmp(name, "hex") == 0) *format = MACHINE_CODE_HEX;
+    else if (strcmp(name, "raw-le") == 0) *format = MACHINE_CODE_RAW_LE;
+    else if (strcmp(name, "raw-be") == 0) *format = MACHINE_CODE_RAW_BE;
+    else return false;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    EmitTarget target = EMIT_BOTH;
+    int path_index = 1;
+    while (argc > path_index && strncmp(argv[path_index], "--", 2) == 0) {
+        const char* option = argv[path_index];
+        const char* value = argc > path_index + 1 ? argv[path_index + 1] : "";
+        bool valid = false;
+        if (strcmp(option, "--emit") == 0) valid = parse_emit_target(value, &target);
+        else if (strcmp(option, "--format") == 0) valid = parse_machine_code_format(value, &machine_format);
+        else if (strcmp(option, "--unused") == 0) valid = parse_unused_variables(value, &drop_unused_variables);
+        else if (strcmp(option, "--stats") == 0) valid = parse_stats_mode(value, &compile_stats.enabled);
+        if (!valid) {
+            printf("Usage: %s [--emit file|stdout|both] [--format binary|hex|raw-le|raw-be] [--unused keep|drop]\n"
+                   "          [--stats off|json] [source.b]\n", argv[0]);
+            printf("The raw formats also write the instruction words to output.bin\n");
+            printf("--unused drop removes stores to variables that are never read and packs the rest\n");
+            printf("--stats json writes phase times and counters to stderr as a JSON line\n");
+            return 1;
+        }
+        path_index += 2;
+    }
+
+    SourceBuffer source;
+    bool path_given = argc > path_index;
+    if (!load_source_code(path_given ? argv[path_index] : "code.b", path_given, &source)) return 1;
+    bool compiled = compile_program(source.text, "output.s", target);
+    if (compile_stats.enabled) report_stats(compiled, stderr);
+    // Tokens and symbols are slices of the source, so release it last
+    release_source_code(&source);
+    free(all_tokens);
+    free(symbol_table);
+    free(symbol_slots);
+    free(register_allocation.ranges);
+    free(register_allocation.ended);
+    free(float_constant_pool.bits);
+    free(float_constant_pool.slots);
+    free(code_output.data);
+    free(object_output.data);
+    free(instruction_list.items);
+    free(instruction_list.assembly_text.data);
+    free(instruction_list.rewritten_text.data);
     return 0;
-}
\ No newline at end of file
+}